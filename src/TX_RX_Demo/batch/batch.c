@@ -0,0 +1,182 @@
+/**
+ * @brief Sample batching layer on top of RADIO_TX.
+ *
+ * Records are written straight into the frame buffer. The batch is sent when
+ * it holds the configured number of records, or when holding it for another
+ * sampling period would make its oldest record later than the latency bound.
+ * The radio is woken, calibrated (from the calibration cache while the
+ * temperature allows) and set to the destination's transmit power level for
+ * each frame and put back to sleep after it, so between batches it stays
+ * asleep.
+ *
+ * @file batch.c
+ * @author Aaron Parks, UW Sensor Systems Laboratory
+ * @version 1.0
+
+ */
+
+///////////////////////////////////////////////////////////////////////////////
+/// Includes
+///////////////////////////////////////////////////////////////////////////////
+#include "batch.h"
+
+///////////////////////////////////////////////////////////////////////////////
+/// Batch state variables
+///////////////////////////////////////////////////////////////////////////////
+uint8_t		BATCH_frame[BATCH_FRAME_LEN];	// {count, records}
+uint8_t		BATCH_addr;			// Destination of the batch frames
+uint8_t		BATCH_size;			// Records per frame
+uint32_t	BATCH_latency;		// Longest wait of a record (caller's time unit)
+uint32_t	BATCH_age;			// Age of the oldest buffered record (same unit)
+
+///////////////////////////////////////////////////////////////////////////////
+
+/**
+ * Start an empty batch. Frames hold BATCH_MAX_RECORDS records and are only
+ * sent when full until BATCH_SET_SIZE or BATCH_SET_LATENCY say otherwise.
+ *
+ * @pre RADIO_INIT has been called.
+ *
+ * @param addr the destination device address, or RADIO_ADDR_BROADCAST
+ * @return RADIO_SUCCESS
+ */
+int16_t BATCH_INIT( uint8_t addr )
+{
+    BATCH_frame[0] = 0;
+    BATCH_addr = addr;
+    BATCH_size = BATCH_MAX_RECORDS;
+    BATCH_latency = BATCH_LATENCY_NONE;
+    BATCH_age = 0;
+
+    return RADIO_SUCCESS;
+}
+
+/**
+ * Set the number of records sent per frame. If as many are already
+ * buffered, they are sent now.
+ *
+ * @note Without RADIO_VAR_LEN every frame is padded to RADIO_PAY_LEN, so a
+ *			smaller batch costs as much airtime as a full one.
+ *
+ * @param records records per frame, 1 to BATCH_MAX_RECORDS
+ * @return RADIO_FAIL if records is out of range, else as BATCH_FLUSH.
+ */
+int16_t BATCH_SET_SIZE( uint8_t records )
+{
+    if(!records || records > BATCH_MAX_RECORDS)
+        {
+            return RADIO_FAIL;
+        }
+
+    BATCH_size = records;
+
+    if(BATCH_frame[0] >= BATCH_size)
+        {
+            return BATCH_FLUSH();
+        }
+
+    return RADIO_SUCCESS;
+}
+
+/**
+ * Set the longest time a record may wait in the buffer before it is sent,
+ * not counting sampling and transmit time. Takes effect at the next
+ * BATCH_ADD.
+ *
+ * @param ticks in the unit the sampling period is given to BATCH_ADD (e.g.
+ *			VLO ticks or ms), or BATCH_LATENCY_NONE for no bound
+ * @return RADIO_SUCCESS
+ */
+int16_t BATCH_SET_LATENCY( uint32_t ticks )
+{
+    BATCH_latency = ticks;
+
+    return RADIO_SUCCESS;
+}
+
+/**
+ * Add a record to the batch. The batch is sent if it is now full, or if the
+ * oldest record would pass the latency bound before the next BATCH_ADD.
+ *
+ * @param record BATCH_REC_LEN bytes to send; copied, may be reused on return
+ * @param nextTicks time until the next call (the sampling period), in the
+ *			unit of the latency bound
+ * @return RADIO_SUCCESS if the record was buffered or sent, else the
+ *			RADIO_TX status of the failed batch, which is dropped.
+ */
+int16_t BATCH_ADD( uint8_t* record, uint16_t nextTicks )
+{
+    uint8_t* dst = &BATCH_frame[BATCH_HDR_LEN + BATCH_frame[0] * BATCH_REC_LEN];
+    uint8_t i;
+
+    for(i = 0; i < BATCH_REC_LEN; i++)
+        {
+            dst[i] = record[i];
+        }
+    BATCH_frame[0]++;
+
+    if(BATCH_frame[0] >= BATCH_size || BATCH_age + nextTicks > BATCH_latency)
+        {
+            return BATCH_FLUSH();
+        }
+
+    BATCH_age += nextTicks;
+
+    return RADIO_SUCCESS;
+}
+
+/**
+ * Send the buffered records as one frame, bringing the radio calibration up
+ * to date and setting the TXPWR_LEVEL of the destination first, and putting
+ * the radio to sleep afterwards. The ACK outcome is fed back to the power
+ * control. The buffer is emptied whether or not the transmission succeeds.
+ *
+ * @pre HAL_ADC_INIT has been called; the ADC is left on BSP_INCH_TEMP.
+ *
+ * @return RADIO_SUCCESS if the frame was sent or the buffer was empty, else
+ *			the RADIO_TX status.
+ */
+int16_t BATCH_FLUSH( void )
+{
+    int16_t rc;
+    uint16_t temp;
+
+    if(!BATCH_frame[0])
+        {
+            return RADIO_SUCCESS;
+        }
+
+    // Sample the chip temperature while the radio still sleeps
+    HAL_ADC_CHANNEL_SELECT(BSP_INCH_TEMP);
+    temp = HAL_ADC_SAMPLE();
+
+    // Wake the radio, restoring the transmit power it slept with, and bring
+    //	the frequency synth calibration up to date for the temperature. Only
+    //	a new temperature bucket costs a calibration.
+    RADIO_WAKE();
+    RADIO_CALIBRATE_CACHED(temp);
+
+    // Only written if the destination's level differs
+    TXPWR_APPLY(BATCH_addr);
+
+    rc = RADIO_TX(BATCH_addr, BATCH_frame,
+                  BATCH_HDR_LEN + BATCH_frame[0] * BATCH_REC_LEN);
+    TXPWR_REPORT_TX(BATCH_addr, rc);
+
+    RADIO_SLEEP();
+
+    BATCH_frame[0] = 0;
+    BATCH_age = 0;
+
+    return rc;
+}
+
+/**
+ * @return Number of records waiting to be sent.
+ */
+uint8_t BATCH_PENDING( void )
+{
+    return BATCH_frame[0];
+}
+
+///////////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,62 @@
+/**
+ * @brief Sample batching layer on top of RADIO_TX.
+ *
+ * Buffers fixed-size sensor records in RAM and sends them together in one
+ * radio frame, so the per-frame costs (radio wakeup, calibration, preamble,
+ * sync, header) are paid once per batch rather than once per sample.
+ *
+ * @file batch.h
+ * @author Aaron Parks, UW Sensor Systems Laboratory
+ * @version 1.0
+
+ */
+
+/*---------------------Include Guard-----------------------------------------*/
+#ifndef BATCH_H
+#define BATCH_H
+/*---------------------------------------------------------------------------*/
+
+///////////////////////////////////////////////////////////////////////////////
+/// Includes
+///////////////////////////////////////////////////////////////////////////////
+#include "../config/config.h"// Platform-specific definitions
+#include "../radio/radio.h"	// Radio functions and return status definitions
+#include "../txpower/txpower.h"	// Transmit power per destination
+#include <stdint.h>			// Data type definitions
+
+///////////////////////////////////////////////////////////////////////////////
+/// Frame format
+///////////////////////////////////////////////////////////////////////////////
+
+// Batch frame payload: {count, record 0, ..., record count-1}
+#define BATCH_HDR_LEN		1
+#define BATCH_FRAME_LEN		(BATCH_HDR_LEN + BATCH_REC_LEN * BATCH_MAX_RECORDS)
+
+#if(BATCH_FRAME_LEN > RADIO_PAY_LEN)
+#error "RADIO_PAY_LEN is too short for BATCH_MAX_RECORDS records"
+#endif
+
+// Latency bound which never forces a flush
+#define BATCH_LATENCY_NONE	0xFFFFFFFFul
+
+///////////////////////////////////////////////////////////////////////////////
+/// Prototypes
+///////////////////////////////////////////////////////////////////////////////
+
+// Start an empty batch to addr, BATCH_MAX_RECORDS long, with no latency bound
+int16_t BATCH_INIT( uint8_t addr );
+// Set the number of records sent per frame (1 to BATCH_MAX_RECORDS)
+int16_t BATCH_SET_SIZE( uint8_t records );
+// Set the longest time a record may wait to be sent (VLO ticks, ms, ...)
+int16_t BATCH_SET_LATENCY( uint32_t ticks );
+// Add a BATCH_REC_LEN byte record, sending the batch if it is due
+int16_t BATCH_ADD( uint8_t* record, uint16_t nextTicks );
+// Send the buffered records now
+int16_t BATCH_FLUSH( void );
+// Number of records waiting to be sent
+uint8_t BATCH_PENDING( void );
+
+
+///////////////////////////////////////////////////////////////////////////////
+#endif /* BATCH_H */
+///////////////////////////////////////////////////////////////////////////////
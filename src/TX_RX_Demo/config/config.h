@@ -26,27 +26,93 @@
 // Should debug features be built?
 #define HAL_DEBUG 			FALSE
 
-// Desired active-mode clock frequency in MHz. Options are: 1,4,8,16.
-/// @todo Listen to this value in clock initialization routines
+// Active-mode clock frequency in MHz, from the calibrated DCO settings.
+//	Options are: 1,8,12,16. Radio work (RADIO_TX, the GDO ISR) switches to
+//	HAL_CLOCK_FAST and back; at HAL_CLOCK_FREQ it never switches. The MCU
+//	needs a supply of at least 2.2 V for 8 MHz, 2.7 V for 12 MHz and 3.3 V
+//	for 16 MHz over the whole time it runs there, so only raise
+//	HAL_CLOCK_FAST on a regulated supply: a coin cell or harvester may sag
+//	below that. 12 MHz gives the fastest SCLK (6 MHz) per MCLK cycle spent
+//	on the SPI.
 #define HAL_CLOCK_FREQ		1
+#define HAL_CLOCK_FAST		HAL_CLOCK_FREQ
+
+// Time (ms) after which the VLO is measured again, to follow its drift with
+//	temperature and supply: slept in HAL_SLEEP_MS, or reported to
+//	HAL_VLO_ELAPSED by code that doesn't sleep through HAL_SLEEP_MS
+#define HAL_VLO_RECAL_MS	60000ul
 
 // Should init routine optimizations be done (Removes auto-generated
 //	initialization routine)?
 #define HAL_OPTIMIZE_INIT	TRUE
 
-// Network config information
+// Network config information. The network ID is sent as the sync word
+//	(SYNC1 = ID, SYNC0 = ~ID), so foreign networks are never synchronized to.
 #define RADIO_NWK_ID		0x88// The ID for this network
 #define RADIO_DEV_ID		0x77// This device address
+#define RADIO_USE_ADDR		TRUE// Destination address sent first, checked by the radio
+
+// Sample batching (batch/batch.c): records are buffered and sent together
+//	as {count, record, record, ...}. Frames fit the 64 byte radio FIFO.
+#define BATCH_REC_LEN		6	// {{Sensor 1 ID}, {MSB1}, {LSB1}, {Sensor 2 ID}, {MSB2}, {LSB2}}
+#define BATCH_MAX_RECORDS	8	// Largest batch
 
-// Transmit packet payload length
-#define RADIO_PAY_LEN		6	// {{Sensor 1 ID}, {MSB1}, {LSB1}, {Sensor 2 ID}, {MSB2}, {LSB2}}
+// Transmit packet payload length (maximum payload length if RADIO_VAR_LEN)
+#define RADIO_PAY_LEN		(1 + BATCH_REC_LEN * BATCH_MAX_RECORDS)	// One full batch
 
 // Essential transmit/receive settings
 #define RADIO_USE_FEC		TRUE
-#define RADIO_USE_CRC		FALSE
+#define RADIO_USE_CRC		TRUE	// Radio drops bad packets and only interrupts on good ones
+#define RADIO_RX_STATUS		TRUE	// Radio appends RSSI/LQI to received packets
+#define RADIO_VAR_LEN		FALSE	// Length byte sent first. Can't be used with FEC.
+#define RADIO_STREAM		TRUE	// Move packets through the FIFOs as they drain/fill.
+									//	Needed above 61 bytes, allows up to 255.
+
+// Transmit power control (txpower/txpower.c): each destination starts at
+//	full power, steps down the PATABLE ladder while link reports show margin
+//	to spare and steps back up when the link weakens or a packet is lost.
+#define TXPWR_DESTS			4		// Destinations tracked
+#define TXPWR_RSSI_TARGET	(-80)	// Weakest RSSI wanted at the receiver (dBm)
+#define TXPWR_RSSI_HYST		4		// RSSI above target needed to step down (dB)
+#define TXPWR_LQI_MAX		50		// Highest (worst) LQI accepted
+#define TXPWR_DOWN_AFTER	4		// Good reports in a row before stepping down
+#define TXPWR_UP_STEP		2		// Levels raised when a packet is lost
+
+// Received packets held until RADIO_RECEIVE is called
+#define RADIO_RX_QUEUE_LEN	4
+
+// Synthesizer calibration cache. RADIO_CALIBRATE_CACHED keeps the FSCAL
+//	results per channel and temperature bucket (ADC10 counts of the internal
+//	sensor) and loads them back instead of calibrating again. A calibration
+//	only runs when the temperature drifts into a bucket not yet cached.
+#define RADIO_CAL_CACHE_LEN	8		// Channel/temperature pairs kept
+#define RADIO_CAL_TEMP_STEP	16		// Bucket width (ADC10 counts, ~6.6 C)
+
+// Channel hopping (RADIO_HOP_TO/RADIO_HOP_NEXT). The sequence visits
+//	RADIO_HOP_CHANNELS channels, RADIO_HOP_SPACING CHANNR steps (200 kHz
+//	each) apart from SMARTRF_SETTING_CHANNR, in an order shuffled by the
+//	network ID. Keep RADIO_CAL_CACHE_LEN at least RADIO_HOP_CHANNELS so that
+//	hopping never needs a calibration at a steady temperature.
+#define RADIO_HOP_CHANNELS	8		// Channels in the sequence (at most 16)
+#define RADIO_HOP_SPACING	32		// 6.4 MHz: spans 2433..2478 MHz
+
+// Link-layer acknowledgements (ARQ). Unicast packets carry the sender's
+//	address and a sequence number, and the receiver acknowledges them from
+//	its GDO ISR. RADIO_TX resends a packet until it is acknowledged, up to
+//	RADIO_ARQ_RETRIES times. Needs RADIO_USE_ADDR. Off by default, as every
+//	unicast packet then costs an ACK wait in RX and a longer header.
+#define RADIO_USE_ARQ		FALSE
+#define RADIO_ARQ_RETRIES	3		// Resends before giving up with RADIO_NO_ACK
+#define RADIO_ARQ_PEERS		4		// Senders tracked to drop duplicates
 
-/// @todo Listen to the following config values...
+// Clear channel assessment before transmitting. On a busy channel RADIO_TX
+//	backs off for a random number of VLO ticks, in a window that starts at
+//	RADIO_CCA_BACKOFF_MIN and doubles per attempt up to RADIO_CCA_BACKOFF_MAX.
+//	ARQ retries back off the same way. Both windows must be powers of two.
 #define RADIO_TX_CCA 		FALSE	// CCA on or off
+#define RADIO_CCA_RETRIES	4		// Backoffs before giving up with RADIO_CCA_FAIL
+#define RADIO_CCA_BACKOFF_MIN	16	// First backoff window (VLO ticks, ~1.3 ms)
+#define RADIO_CCA_BACKOFF_MAX	256	// Largest backoff window (VLO ticks, ~21 ms)
 
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -20,7 +20,7 @@
 ///////////////////////////////////////////////////////////////////////////////
 /// Defines
 ///////////////////////////////////////////////////////////////////////////////
-#define USE_TX_ID	0x77	// The ID of the transmitter we're listening to
+#define WDT_ACLK_TICKS	32768u	// WDT_ADLY_1000 interval in ACLK ticks
 
 ///////////////////////////////////////////////////////////////////////////////
 /// Globals
@@ -66,7 +66,11 @@ void main( void )
     // Load all configuration registers of radio and put radio into idle mode
 	RADIO_INIT();
 
-    RADIO_CALIBRATE();
+    // The internal temperature sensor tells when the radio needs calibrating
+    HAL_ADC_INIT();
+    HAL_ADC_CHANNEL_SELECT(BSP_INCH_TEMP);
+
+    RADIO_CALIBRATE_CACHED(HAL_ADC_SAMPLE());
 
     RADIO_SETUP_RX(&dataReceived);
 
@@ -86,24 +90,26 @@ void main( void )
  */
 void dataReceived()
 {
-    uint8_t nwkID;
-    uint8_t txID;
+    uint8_t addr;
+    int8_t rssi;
+    uint8_t lqi;
+    uint16_t len;
 
-    // Toggle LED0 to indicate that something was received (may not be good data).
+    // Toggle LED0 to indicate that something was received (passed CRC if RADIO_USE_CRC).
     BSP_LED0_TOGGLE();
 
-    // If any data has been received, check the IDs and signal if matching.
-    if(RADIO_RECEIVE(rxBuf, &nwkID, &txID))
+    // The radio has already dropped packets for other networks and devices.
+    while((len = RADIO_RECEIVE(rxBuf, &addr, &rssi, &lqi)))
         {
-            if((RADIO_NWK_ID == nwkID) && (USE_TX_ID == txID))
+            // Toggle LED1 to indicate a packet addressed to this device
+            if(RADIO_DEV_ID == addr)
                 {
-            		// Toggle LED1 to indicate that device/nwk address matches
-            		BSP_LED1_TOGGLE();
-
-            		// Send payload via UART
-            		msgLen = HAL_UART_FORMATTER(msgBuf, rxBuf, RADIO_PAY_LEN);
-                    HAL_UART_TX(msgBuf,msgLen);
+                    BSP_LED1_TOGGLE();
                 }
+
+            // Send payload via UART
+            msgLen = HAL_UART_FORMATTER(msgBuf, rxBuf, len);
+            HAL_UART_TX(msgBuf,msgLen);
         }
 
     calibrateAndRestartRX(&calibrateSem);
@@ -111,11 +117,16 @@ void dataReceived()
 }
 
 /**
- * Recalibrates the radio periodically
+ * Recalibrates the radio periodically, and keeps the VLO measurement current
  */
 #pragma vector=WDT_VECTOR
 __interrupt void WDT_ISR(void) {
 
+		// Nothing here sleeps through HAL_SLEEP_MS: count the interval so
+		//	that the VLO is measured again as it drifts, with the radio idle
+		//	in calibrateAndRestartRX
+		HAL_VLO_ELAPSED(WDT_ACLK_TICKS);
+
 		calibrateAndRestartRX(&calibrateSem);
 		IFG1 &= ~WDTIFG;
 }
@@ -123,23 +134,41 @@ __interrupt void WDT_ISR(void) {
 /**
  * Runs a calibration routine for the radio receiver, which needs to be
  * periodically calibrated to maintain good sensitivity and proper operation.
+ * The receiver is only interrupted once the temperature has drifted out of
+ * the calibrated bucket, and then mostly for cached calibration results,
+ * or when the VLO is due to be measured again.
  */
 void calibrateAndRestartRX(uint8_t* inUse) {
 
+	uint16_t temp;
+	uint8_t vlo;
+
 	if(*inUse) {
 		return;
 	}
 
 	*inUse = 1;
 
-    // Disable receive for a moment and recalibrate the radio
-    RADIO_IDLE();
+	temp = HAL_ADC_SAMPLE();
+	vlo = HAL_VLO_ELAPSED(0);
+	if(vlo || !RADIO_CAL_VALID(temp)) {
+
+	    // Disable receive for a moment and recalibrate the radio
+	    RADIO_IDLE();
 
-    // Calibrate the receiver
-    RADIO_CALIBRATE();
+	    // Measure the VLO, which holds interrupts off meanwhile
+	    if(vlo) {
+	        HAL_VLO_CALIBRATE();
+	    }
 
-    // Re-enable polling
-    RADIO_RX_POLL();
+	    // Calibrate the receiver
+	    if(!RADIO_CAL_VALID(temp)) {
+	        RADIO_CALIBRATE_CACHED(temp);
+	    }
+
+	    // Re-enable polling
+	    RADIO_RX_POLL();
+	}
 
 	*inUse = 0;
 }
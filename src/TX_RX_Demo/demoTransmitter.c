@@ -15,13 +15,21 @@
 #include "hal/hal.h"
 #include "hal/bsp.h"
 #include "radio/radio.h"
+#include "batch/batch.h"
+#include "txpower/txpower.h"
 #include "sensor_id.h"
 
+///////////////////////////////////////////////////////////////////////////////
+/// Defines
+///////////////////////////////////////////////////////////////////////////////
+#define USE_RX_ID	0x77	// The address of the receiver we're sending to
+#define SAMPLE_MS		1000	// Sampling period (ms)
+#define MAX_LATENCY		10000ul	// Longest a sample may wait to be sent (ms)
+
 ///////////////////////////////////////////////////////////////////////////////
 /// Global variables
 ///////////////////////////////////////////////////////////////////////////////
-uint8_t		msgBuf[RADIO_PAY_LEN];// Transmit message buffer
-uint8_t		calScheduler;	// Calibration schedule tracking
+uint8_t		msgBuf[BATCH_REC_LEN];// Sample record buffer
 uint16_t	tempValue;		// ADC result - temperature
 uint16_t	photoValue;		// ADC result - photosensor
 
@@ -30,8 +38,6 @@ uint16_t	photoValue;		// ADC result - photosensor
 void main( void )
 
 {
-    calScheduler=0;	// Initialize calibration scheduler
-
     // Initialize microcontroller (Digital and analog I/O, timers, clock, etc)
     HAL_INIT();
 
@@ -42,12 +48,20 @@ void main( void )
     // Load all configuration registers of radio and put radio into idle mode
     RADIO_INIT();
 
-    // Set power level for transmit operation
-    RADIO_SET_TX_PWR(0xFF);
+    // Transmit power is chosen per destination by the power control loop,
+    //	starting at full power, and set before each batch is sent
+    TXPWR_INIT();
 
     // Radio goes to sleep here to save power during remaining initialization
     RADIO_SLEEP();
 
+    // Buffer samples for the receiver and send them in batches. The batch is
+    //	sent when it holds BATCH_MAX_RECORDS samples, or earlier if the oldest
+    //	sample would otherwise wait longer than MAX_LATENCY.
+    BATCH_INIT(USE_RX_ID);
+    BATCH_SET_SIZE(BATCH_MAX_RECORDS);
+    BATCH_SET_LATENCY(MAX_LATENCY);
+
     // Initialize the ADC for sensor measurements
     HAL_ADC_INIT();
 
@@ -57,16 +71,6 @@ void main( void )
 
     while(1)
         {
-            // Calibrate radio VCO every fourth frame (starting with first frame)
-            if(!calScheduler) {
-				// Calibrate the radio frequency synth.
-				//	Automatically wakes the radio if it's asleep.
-				RADIO_CALIBRATE();
-				calScheduler=3;
-            } else {
-            	calScheduler--;
-            }
-
             // Sample the sensors
             HAL_ADC_CHANNEL_SELECT(BSP_INCH_TEMP);
             tempValue = HAL_ADC_SAMPLE();
@@ -88,21 +92,15 @@ void main( void )
             msgBuf[5] = photoValue & 0xFFu; // 8 LSbs
 
 
-            // Transmit a message to the receiver. This function will also send
-            // 	the network ID and sensor ID automatically.
-            // 	This function may return before the transmission is complete.
-            //	Automatically wakes the radio if it's asleep.
-            RADIO_TX(msgBuf);
-
-            // Add delay to make sure all data is transmitted. What is the minimum delay?
-            HAL_PRECISE_DELAY(100);
-
-            // DEBUG: No need to sleep if we're going down...
-            RADIO_SLEEP();
+            // Add the sample to the batch. When the batch is due, this wakes
+            //	the radio (calibrating it if the temperature has moved),
+            //	transmits the batch to the receiver (with the network ID and
+            //	receiver address) and puts the radio back to sleep.
+            BATCH_ADD(msgBuf, SAMPLE_MS);
 
             // DEBUG: Blackout/recharge
             BSP_LDO_HOLD_POUT &= ~BSP_LDO_HOLD_BIT;
-            HAL_LONG_DELAY(12000);
+            HAL_SLEEP_MS(SAMPLE_MS);	// At the measured VLO rate
             BSP_LDO_HOLD_POUT |= BSP_LDO_HOLD_BIT;
        }
 
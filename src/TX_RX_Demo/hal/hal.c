@@ -14,6 +14,12 @@
 // Includes
 ///////////////////////////////////////////////////////////////////////////////
 #include "hal.h"			// HAL configuration and other HAL functions
+
+///////////////////////////////////////////////////////////////////////////////
+/// Clock state variables
+///////////////////////////////////////////////////////////////////////////////
+uint8_t HAL_clockMhz;			// MCLK and SMCLK frequency in MHz
+
 ///////////////////////////////////////////////////////////////////////////////
 
 /**
@@ -27,26 +33,96 @@ void HAL_INIT( void )
     // Stop the WDT
     WDTCTL = WDTPW | WDTHOLD;
 
-    // Set up the clock for 1 MHz
-    BCSCTL1 = 	CALBC1_1MHZ;
-    DCOCTL = 	CALDCO_1MHZ;
+    // Set up the clock for HAL_CLOCK_FREQ
+    HAL_clockMhz = 0;
+    HAL_CLOCK_SET(HAL_CLOCK_FREQ);
 
-#if(BSP_HAS_CRYSTAL)
+#if(BSP_HAS_XTAL)
     //Choose 32.768kHz watch crystal as AMCLK source
     BSP_XTAL_PSEL |= BSP_XOUT + BSP_XIN;		// Select XT1
     BCSCTL3 |= XCAP_3;                       	// Internal load cap
+    HAL_aclkHz = 32768;
     // Select ACLK = VLO
 #else
     BCSCTL3 |= LFXT1S_2; //use VLO as clock source
+    HAL_aclkHz = 0;								// Until HAL_VLO_CALIBRATE
 #endif
+    HAL_vloAgeMs = 0;
 
     // @todo Setup the crystal capacitance regs
-    // @todo Initialize the delay timer peripheral
+    HAL_TMR_INIT();
+    HAL_VLO_CALIBRATE();
     HAL_SPI_INIT();
 
     HAL_ENABLE_INTERRUPTS();
 }
 
+/**
+ * Switch MCLK and SMCLK to one of the calibrated DCO settings, and re-derive
+ * what depends on them: the SPI clock divider (SCLK up to HAL_SPI_MAX_KHZ),
+ * the UART baud rate registers and HAL_DELAY_SHORT. A transfer submitted to
+ * the SPI engine and a UART byte in progress are completed first. ACLK and
+ * the delays timed by it are not affected. May be called from an ISR: GIE is
+ * left as it was found.
+ *
+ * @param mhz	The new frequency: 1, 8, 12 or 16 (anything else selects 1)
+ * @return The previous frequency in MHz, to switch back to.
+ */
+uint8_t HAL_CLOCK_SET( uint8_t mhz )
+{
+    uint8_t prev = HAL_clockMhz;
+    uint16_t sr;
+    uint8_t bc1;
+    uint8_t dco;
+
+    switch(mhz)
+        {
+        case 16:
+            bc1 = CALBC1_16MHZ;
+            dco = CALDCO_16MHZ;
+            break;
+        case 12:
+            bc1 = CALBC1_12MHZ;
+            dco = CALDCO_12MHZ;
+            break;
+        case 8:
+            bc1 = CALBC1_8MHZ;
+            dco = CALDCO_8MHZ;
+            break;
+        default:
+            mhz = 1;
+            bc1 = CALBC1_1MHZ;
+            dco = CALDCO_1MHZ;
+            break;
+        }
+
+    if(mhz == prev)
+        {
+            return prev;
+        }
+
+    // HAL_EXIT_CRITICAL would set GIE unconditionally, also inside an ISR
+    sr = __get_SR_register();
+    HAL_ENTER_CRITICAL();
+
+    // Lowest DCO step first, so the DCO never overshoots in between. The
+    //	ACLK divider in BCSCTL1 is kept.
+    DCOCTL = 0;
+    BCSCTL1 = (BCSCTL1 & DIVA_3) | (bc1 & ~DIVA_3);
+    DCOCTL = dco;
+    HAL_clockMhz = mhz;
+
+    HAL_SPI_CLOCK();
+    HAL_UART_CLOCK();
+
+    if(sr & GIE)
+        {
+            HAL_EXIT_CRITICAL();
+        }
+
+    return prev;
+}
+
 /**
  * If HAL_OPTIMIZE_INIT is non-zero...
  * These two functions (_system_pre_init and _auto_init) replace the compiler-
@@ -45,11 +45,23 @@
 // SPI peripheral
 #define HAL_SPI_TXBUF	UCB0TXBUF
 #define HAL_SPI_RXBUF	UCB0RXBUF
+#define HAL_SPI_STAT	UCB0STAT
+#define HAL_SPI_BR0		UCB0BR0
+#define HAL_SPI_IFG		IFG2
+#define HAL_SPI_TXIFG	UCB0TXIFG
+#define HAL_SPI_RXIFG	UCB0RXIFG
 #define HAL_SPI_TX_VECTOR USCIAB0TX_VECTOR
 #define HAL_SPI_RX_VECTOR USCIAB0RX_VECTOR
+#define HAL_SPI_MAX_KHZ	6500	// Fastest SCLK the CC2500 takes for burst access
+#if(HAL_DEBUG)
+extern uint16_t HAL_spiOverruns;	// Received bytes lost to UCOE
+#endif
 
 // Timer(s)
-#define HAL_TMR_VECTOR	TIMERA0_VECTOR
+#define HAL_TMR_VECTOR	TIMERA0_VECTOR	// TACCR0: HAL_LONG_DELAY and timeouts
+#define HAL_TMR1_VECTOR	TIMERA1_VECTOR	// TACCR1: HAL_PRECISE_DELAY
+#define HAL_VLO_MAX_HZ	20000			// Fastest VLO across parts and temperature
+#define HAL_VLO_NOM_HZ	12000			// Typical VLO, assumed until measured
 //TimerB vector
 #define HAL_TMB_VECTOR  TIMERB0_VECTOR
 
@@ -70,6 +82,13 @@ void HAL_INIT( void );
 #define HAL_ENTER_CRITICAL()		HAL_DISABLE_INTERRUPTS()
 #define HAL_EXIT_CRITICAL()			HAL_ENABLE_INTERRUPTS()
 
+//-------Clock control-------------------------------------------------------//
+extern uint8_t HAL_clockMhz;		// MCLK and SMCLK frequency in MHz
+
+// Switch MCLK/SMCLK to a calibrated DCO setting, re-deriving the SPI and
+//	UART dividers. Returns the previous frequency.
+uint8_t HAL_CLOCK_SET( uint8_t mhz );
+
 //-------Low-power mode enter/exit-------------------------------------------//
 #define HAL_SLEEP()					__bis_SR_register(LPM3_bits | GIE)
 #define HAL_LPM3_WAKEUP()			__bic_SR_register_on_exit(LPM3_bits | GIE)
@@ -81,12 +100,40 @@ void HAL_INIT( void );
 
 //-------Power-optimized hardware sleep functions----------------------------//
 
-// Short delay; Blocks for the given number of microseconds assuming 1MHz clk
-#define HAL_DELAY_SHORT( us ) __delay_cycles(us)
-
-// Delay for longer periods of time, using watch crystal and LPM3.
+// Short delay; Blocks for the given number of microseconds (a constant) at
+//	the current clock
+#define HAL_DELAY_SHORT( us ) \
+	do { \
+		switch(HAL_clockMhz) \
+		{ \
+		case 16: __delay_cycles(16 * (us)); break; \
+		case 12: __delay_cycles(12 * (us)); break; \
+		case 8: __delay_cycles(8 * (us)); break; \
+		default: __delay_cycles(us); break; \
+		} \
+	} while(0)
+
+// Start Timer_A counting ACLK, for the delays below
+void HAL_TMR_INIT(void);
+extern uint16_t HAL_aclkHz;			// ACLK frequency, 0 if not known
+extern uint32_t HAL_vloAgeMs;		// ACLK-timed ms since the last calibration
+
+// Measure the VLO against the DCO, setting HAL_aclkHz
+int16_t HAL_VLO_CALIBRATE(void);
+// Count ACLK ticks passed (e.g. a WDT interval), telling when the VLO is
+//	to be measured again: once HAL_VLO_RECAL_MS have passed
+uint8_t HAL_VLO_ELAPSED(uint16_t ticks);
+
+// Delay for longer periods of time, sleeping in LPM3 on the ACLK timer.
 void HAL_PRECISE_DELAY(uint16_t ticks);
 void HAL_LONG_DELAY(uint16_t ticks);
+// Sleep for the given number of milliseconds at the measured ACLK frequency
+void HAL_SLEEP_MS(uint32_t ms);
+
+// VLO timeout on the same timer, for waiting on an event in LPM3
+void HAL_TIMEOUT_START(uint16_t ticks);
+uint8_t HAL_TIMEOUT_EXPIRED(void);
+void HAL_TIMEOUT_STOP(void);
 
 //-------ADC module functions------------------------------------------------//
 
@@ -101,6 +148,8 @@ uint16_t HAL_ADC_SAMPLE( void );
 
 // SPI initialization
 void HAL_SPI_INIT( void );
+// Re-derive the SPI clock divider after a clock change
+void HAL_SPI_CLOCK( void );
 // SPI receive
 uint8_t HAL_SPI_READ (
 		uint8_t addr,
@@ -117,13 +166,54 @@ uint8_t HAL_SPI_WRITE (
 		uint16_t dly
 		);
 
+// One source buffer of a gather write
+typedef struct HAL_SPI_seg_s
+{
+    const uint8_t* ptr;	// First byte of the segment (RAM or flash)
+    uint8_t len;		// Segment length in bytes
+} HAL_SPI_seg_t;
+
+// SPI block write from several buffers in one transaction
+uint8_t HAL_SPI_WRITE_GATHER (
+		uint8_t addr,
+		const HAL_SPI_seg_t* segs,
+		uint8_t count,
+		uint16_t dly
+		);
+
 // SPI Strobe
 uint8_t HAL_SPI_STROBE(uint8_t strobeCmd, uint16_t dly);
 
+// Interrupt-driven SPI transfer, moved a byte per USCI receive interrupt
+#define HAL_SPI_XFER_WRITE	0		// Send buf
+#define HAL_SPI_XFER_READ	1		// Receive into buf
+
+typedef struct HAL_SPI_xfer_s
+{
+    uint8_t addr;			// Header byte: address (with read/burst bits) or strobe
+    uint8_t* buf;			// Bytes to send, or to receive into
+    uint8_t len;			// Bytes after the header
+    uint8_t dir;			// HAL_SPI_XFER_WRITE or HAL_SPI_XFER_READ
+    uint16_t dly;			// Ticks to wait after lowering ~CS line
+    void (*callback)(struct HAL_SPI_xfer_s* xfer);	// Called from the ISR when done (optional)
+    volatile uint8_t rc;	// Return code of the header byte (typically status byte)
+} HAL_SPI_xfer_t;
+
+// Start a transfer and return at once
+int16_t HAL_SPI_SUBMIT(HAL_SPI_xfer_t* xfer);
+// Non-zero while a submitted transfer is in progress
+uint8_t HAL_SPI_XFER_BUSY(void);
+// Sleep in LPM1 until the submitted transfer is complete
+void HAL_SPI_XFER_WAIT(void);
+// Submit a transfer and sleep in LPM1 until it is complete
+uint8_t HAL_SPI_XFER(HAL_SPI_xfer_t* xfer);
+
 //-------UART module functions-----------------------------------------------//
 
 // UART initialization
 void HAL_UART_INIT( void );
+// Re-derive the UART baud rate registers after a clock change
+void HAL_UART_CLOCK( void );
 // UART transmit functions
 int16_t HAL_UART_TX(uint8_t* msg, uint16_t len);
 // Packet formatter for sending data via UART
@@ -9,39 +9,216 @@
 /// Includes
 ///////////////////////////////////////////////////////////////////////////////
 #include "hal.h"			// HAL configuration and other HAL functions
+
+///////////////////////////////////////////////////////////////////////////////
+/// Local definitions
+///////////////////////////////////////////////////////////////////////////////
+#define HAL_PRECISE_MIN		4		// Fewest ACLK ticks HAL_PRECISE_DELAY sleeps for
+#define HAL_VLO_CAL_PERIODS	8		// ACLK periods counted by HAL_VLO_CALIBRATE
+#define HAL_SLEEP_CHUNK		0x8000	// Most ACLK ticks slept per timeout
+
+// HAL_PRECISE_DELAY sleeps on the VLO this many 16ths of the measured time,
+//	so that the wait still lasts long enough if the VLO has sped up since it
+//	was measured. The VLO drifts about 0.5%/C and 4%/V, a few percent at most
+//	within HAL_VLO_RECAL_MS.
+#define HAL_VLO_PAD_16THS	17
+
+///////////////////////////////////////////////////////////////////////////////
+/// Delay state variables
+///////////////////////////////////////////////////////////////////////////////
+volatile uint8_t HAL_timeoutExpired;	// Set by the timer ISR
+uint16_t HAL_aclkHz;					// ACLK frequency, 0 if not known
+uint32_t HAL_vloAgeMs;					// ACLK-timed ms since the last calibration
+
 ///////////////////////////////////////////////////////////////////////////////
+// Local prototypes
+///////////////////////////////////////////////////////////////////////////////
+
+// Timer_A count
+uint16_t HAL_TMR_NOW( void );
+
+///////////////////////////////////////////////////////////////////////////////
+
+/**
+ * Start Timer_A counting ACLK continuously. TACCR0 times HAL_LONG_DELAY and
+ * the timeouts, TACCR1 HAL_PRECISE_DELAY; each sets its compare value
+ * relative to the running count, so they can be used at the same time.
+ */
+void HAL_TMR_INIT(void)
+{
+    TACCTL0 = 0;
+    TACCTL1 = 0;
+    TACTL = TASSEL_1 + MC_2 + TACLR;
+}
+
+/**
+ * Measure the ACLK frequency against the calibrated DCO: Timer_A counts
+ * SMCLK over HAL_VLO_CAL_PERIODS periods of ACLK, whose rising edges
+ * TACCR0 captures (CCI0B). The result, in HAL_aclkHz, is as accurate as the
+ * DCO calibration (about 1% at 8 kHz-20 kHz ACLK); it times HAL_SLEEP_MS,
+ * and lets HAL_PRECISE_DELAY sleep.
+ *
+ * Timer_A is taken from ACLK for the measurement (about 0.7 ms at 12 kHz),
+ * so no delay or timeout may be running. With a watch crystal, ACLK is
+ * known and nothing is measured. May be called from an ISR.
+ *
+ * @return HAL_SUCCESS, or HAL_FAIL if Timer_A is in use.
+ */
+int16_t HAL_VLO_CALIBRATE(void)
+{
+#if(!BSP_HAS_XTAL)
+    uint16_t first;
+    uint16_t count;
+    uint16_t sr;
+    uint8_t i;
+
+    if((TACCTL0 | TACCTL1) & CCIE)
+        {
+            return HAL_FAIL;
+        }
+
+    sr = __get_SR_register();
+    HAL_ENTER_CRITICAL();
+
+    TACTL = TASSEL_2 + MC_2 + TACLR;
+    TACCTL0 = CM_1 + CCIS_1 + SCS + CAP;
+
+    // The first edge starts the count
+    while(!(TACCTL0 & CCIFG));
+    TACCTL0 &= ~CCIFG;
+    first = TACCR0;
+
+    for(i = 0; i < HAL_VLO_CAL_PERIODS; i++)
+        {
+            while(!(TACCTL0 & CCIFG));
+            TACCTL0 &= ~CCIFG;
+        }
+    count = TACCR0 - first;
+
+    // Back to counting ACLK
+    HAL_TMR_INIT();
+
+    if(sr & GIE)
+        {
+            HAL_EXIT_CRITICAL();
+        }
+
+    HAL_aclkHz = ((uint32_t)HAL_clockMhz * 1000000ul * HAL_VLO_CAL_PERIODS + count / 2) / count;
+    HAL_vloAgeMs = 0;
+#endif
+
+    return HAL_SUCCESS;
+}
+
+/**
+ * Report ACLK ticks that have passed outside HAL_SLEEP_MS, e.g. a WDT
+ * interval, so that code which never sleeps through HAL_SLEEP_MS still
+ * follows the VLO drift: once HAL_VLO_RECAL_MS have passed since the last
+ * calibration, a measurement is due. The caller runs HAL_VLO_CALIBRATE
+ * when it can hold interrupts off for it, e.g. with the radio idle; until
+ * then, every call reports it as due.
+ *
+ * @param ticks ACLK ticks passed since the last call (0 to only check)
+ * @return Non-zero while a VLO measurement is due
+ */
+uint8_t HAL_VLO_ELAPSED(uint16_t ticks)
+{
+#if(!BSP_HAS_XTAL)
+    HAL_vloAgeMs += (uint32_t)ticks * 1000
+                    / (HAL_aclkHz ? HAL_aclkHz : HAL_VLO_NOM_HZ);
+
+    return (HAL_vloAgeMs >= HAL_VLO_RECAL_MS);
+#else
+    return FALSE;
+#endif
+}
+
 /**
  * Blocks for the given number of ticks of a 32,768 Hz RTC crystal.
  * Good for longer delays where high precision timing
  * is required.
  *
- * @param ticks ticks/32,768 = time delay in seconds.
+ * The CPU sleeps in LPM3 on TACCR1 for as many whole ACLK ticks as cover
+ * the delay, plus the part of the current tick. On the VLO, the wait is
+ * padded for drift since the last calibration (HAL_VLO_PAD_16THS). Waits of
+ * fewer than HAL_PRECISE_MIN ACLK ticks, which that rounding would stretch
+ * by more than a quarter, and any wait while the ACLK frequency is not
+ * known (the VLO), are emulated with cycle delays instead.
  *
- * @todo Use watch crystal and low-power mode (or use ACLK as source clock)
+ * May be used from an ISR, also while interrupting another
+ * HAL_PRECISE_DELAY: the interrupted delay is resumed afterwards.
+ *
+ * @param ticks ticks/32,768 = time delay in seconds.
  */
 void HAL_PRECISE_DELAY(uint16_t ticks)
 {
-    int i;
+    uint32_t n;
+    uint16_t end;
+    uint16_t outer;
+    uint8_t nested;
 
     if(!ticks)
         {
             return;
         }
 
-    // @todo: only use this method if there's no crystal
-    for(i = 0; i < ticks; i++)
+    // ACLK ticks covering the delay
+    n = ((uint32_t)ticks * HAL_aclkHz + 32767) >> 15;
+
+    if(n < HAL_PRECISE_MIN)
+        {
+            while(ticks--)
+                {
+                    HAL_DELAY_SHORT( 31 ); // Emulate one watch crystal tick (30.5 us)
+                }
+            return;
+        }
+
+#if(!BSP_HAS_XTAL)
+    n = (n * HAL_VLO_PAD_16THS + 15) >> 4;
+#endif
+    // Half the timer range at most, for the signed compare below
+    if(n > 0x7FFE)
         {
-            HAL_DELAY_SHORT( 31 ); // Emulate one watch crystal tick (30.5 us)
+            n = 0x7FFE;
         }
 
+    HAL_DISABLE_INTERRUPTS();
+
+    // Part of the current tick has gone already: n whole ticks end one later
+    end = HAL_TMR_NOW() + (uint16_t)n + 1;
+
+    // Take over TACCR1 from an interrupted delay
+    nested = TACCTL1 & CCIE;
+    outer = TACCR1;
+
+    TACCR1 = end;
+    TACCTL1 = CCIE;
+    while((int16_t)(HAL_TMR_NOW() - end) < 0)
+        {
+            HAL_SLEEP();
+            HAL_DISABLE_INTERRUPTS();
+        }
 
+    if(nested)
+        {
+            // Give it back. If its end has already passed, interrupt now.
+            TACCR1 = outer;
+            TACCTL1 = ((int16_t)(HAL_TMR_NOW() - outer) >= 0) ? CCIE | CCIFG : CCIE;
+        }
+    else
+        {
+            TACCTL1 = 0;
+        }
 
+    HAL_ENABLE_INTERRUPTS();
 }
 
 /**
  * Wait for the specified period of time using the VLO (Very Low-freq Oscillator).
  * This function should not be used in an ISR context. Use this for longer
- * delays where low precision timing is required.
+ * delays where low precision timing is required. Other interrupts don't end
+ * the wait.
  *
  * @param ticks Number of clock ticks of the VLO (about 12kHz) to wait
  *
@@ -49,18 +226,117 @@ void HAL_PRECISE_DELAY(uint16_t ticks)
 //----------------------------------------------------------------------------------
 void HAL_LONG_DELAY(uint16_t ticks)
 {
-    // Zero the timing counter
-    TACTL = TACLR;
-    TACTL = TASSEL_1 + MC_1;
+    HAL_TIMEOUT_START(ticks);
+
+    // Check for the timeout with interrupts off, so that it can't expire
+    //	between the check and the sleep; go into low power mode without
+    //	disabling oscillator
+    HAL_DISABLE_INTERRUPTS();
+    while(!HAL_timeoutExpired)
+        {
+            HAL_SLEEP();
+            HAL_DISABLE_INTERRUPTS();
+        }
+    HAL_ENABLE_INTERRUPTS();
+}
+
+/**
+ * Sleep in LPM3 for the given number of milliseconds, counted in ACLK ticks
+ * at the measured frequency. Other interrupts don't end the sleep. Once HAL_VLO_RECAL_MS have been slept since the last
+ * calibration, the VLO is measured again first. Not for use in an ISR.
+ *
+ * @param ms Time to sleep in milliseconds
+ */
+void HAL_SLEEP_MS(uint32_t ms)
+{
+    uint32_t ticks;
+    uint16_t chunk;
+
+#if(!BSP_HAS_XTAL)
+    if(!HAL_aclkHz || HAL_vloAgeMs >= HAL_VLO_RECAL_MS)
+        {
+            HAL_VLO_CALIBRATE();
+        }
+    HAL_vloAgeMs += ms;
+#endif
+
+    // Whole seconds apart, so that ms * HAL_aclkHz can't overflow
+    chunk = HAL_aclkHz ? HAL_aclkHz : HAL_VLO_NOM_HZ;
+    ticks = (ms / 1000) * chunk + ((ms % 1000) * chunk + 500) / 1000;
+
+    while(ticks)
+        {
+            chunk = (ticks > HAL_SLEEP_CHUNK) ? HAL_SLEEP_CHUNK : ticks;
+            ticks -= chunk;
+
+            HAL_TIMEOUT_START(chunk);
+            HAL_DISABLE_INTERRUPTS();
+            while(!HAL_timeoutExpired)
+                {
+                    HAL_SLEEP();
+                    HAL_DISABLE_INTERRUPTS();
+                }
+            HAL_ENABLE_INTERRUPTS();
+        }
+}
+
+/**
+ * Start a timeout of the given number of VLO ticks, which wakes the CPU from
+ * LPM3 when it expires. Lets the caller sleep until either an interrupt of
+ * its own or the timeout, checking HAL_TIMEOUT_EXPIRED after each wakeup.
+ * Uses the same timer as HAL_LONG_DELAY.
+ *
+ * @param ticks Number of clock ticks of the VLO (about 12kHz) to wait
+ */
+void HAL_TIMEOUT_START(uint16_t ticks)
+{
+    HAL_timeoutExpired = 0;
+
+    // The count may move on while the threshold is set: at least 2 ticks
+    //	so that it can't be passed before it is enabled
+    if(ticks < 2)
+        {
+            ticks = 2;
+        }
 
     // Configure timer threshold
-    TACCR0 = ticks;
+    TACCR0 = HAL_TMR_NOW() + ticks;
 
     // Enable interrupting on CCR0 threshold
-    TACCTL0 |= CCIE;
+    TACCTL0 = CCIE;
+}
 
-    // Go into low power mode without disabling oscillator
-    HAL_SLEEP();
+/**
+ * @return Non-zero once the timeout started by HAL_TIMEOUT_START expired.
+ */
+uint8_t HAL_TIMEOUT_EXPIRED(void)
+{
+    return HAL_timeoutExpired;
+}
+
+/**
+ * Stop a timeout before it expires, so that it can't cut a later sleep short.
+ */
+void HAL_TIMEOUT_STOP(void)
+{
+    TACCTL0 = 0;
+}
+
+/**
+ * Timer_A count. ACLK is asynchronous to MCLK, so TAR is read until two
+ * reads agree.
+ */
+uint16_t HAL_TMR_NOW( void )
+{
+    uint16_t t;
+
+    do
+        {
+            t = TAR;
+        }
+    while(t != TAR);
+
+    return t;
 }
 
 /**
@@ -71,7 +347,22 @@ __interrupt void HAL_TMR_ISR( void )
 {
     //TX interrupt routine
     TACCTL0 &= ~CCIE;
-    TACTL = MC_0 + TACLR;
+    HAL_timeoutExpired = 1;
     HAL_LPM3_WAKEUP();
 }
+
+/**
+ * HAL_PRECISE_DELAY timer ISR; Wakes the CPU. Until the delay turns its
+ * TACCR1 interrupt off, it comes again every couple of ticks: a nested
+ * ISR with interrupts enabled may have taken the wakeup meant for it.
+ */
+#pragma vector=HAL_TMR1_VECTOR
+__interrupt void HAL_TMR1_ISR( void )
+{
+    if(TAIV == TAIV_TACCR1)
+        {
+            TACCR1 = HAL_TMR_NOW() + 2;
+            HAL_LPM3_WAKEUP();
+        }
+}
 ///////////////////////////////////////////////////////////////////////////////
@@ -3,6 +3,21 @@
  *
  * Only needs to support one SPI slave device.
  *
+ * Bursts are pipelined through the USCI double buffer: the next byte is
+ * loaded into UCB0TXBUF as soon as UCB0TXIFG shows the previous one has
+ * moved to the shift register, so SCLK runs back to back for the whole
+ * transaction. Reads are only pipelined when SCLK is slow enough against
+ * MCLK (HAL_SPI_RX_PIPE_BR) for the loop to collect each byte from
+ * UCB0RXBUF before the byte queued behind it completes; otherwise they move
+ * one byte at a time. Every transaction ends with the USCI idle and
+ * UCB0RXIFG clear.
+ *
+ * Longer transfers can instead be submitted to the interrupt-driven engine
+ * (HAL_SPI_SUBMIT), which moves a byte per UCB0RXIFG interrupt while the CPU
+ * does other work or sleeps in LPM1 (HAL_SPI_XFER_WAIT). Only one byte is
+ * ever in flight, so a late interrupt costs time but never data. A blocking
+ * call made during a submitted transfer first completes it by polling.
+ *
  * @file hal_spi.c
  * @author Aaron Parks, UW Sensor Systems Laboratory
  * @version 1.0
@@ -14,6 +29,16 @@
 ///////////////////////////////////////////////////////////////////////////////
 #include "hal.h"			// HAL configuration and other HAL functions
 
+///////////////////////////////////////////////////////////////////////////////
+/// Transfer engine state variables
+///////////////////////////////////////////////////////////////////////////////
+HAL_SPI_xfer_t* volatile HAL_SPI_xfer;	// Transfer in progress, or 0
+uint8_t HAL_SPI_xferDone;				// Bytes of it complete, header included
+volatile uint8_t HAL_SPI_xferWait;		// HAL_SPI_XFER_WAIT sleeps on it
+#if(HAL_DEBUG)
+uint16_t HAL_spiOverruns;				// Received bytes lost to UCOE
+#endif
+
 ///////////////////////////////////////////////////////////////////////////////
 /// Local prototypes
 ///////////////////////////////////////////////////////////////////////////////
@@ -21,17 +46,43 @@
 // Send byte and wait for TX to finish
 inline void HAL_SPI_TX_WAIT( uint8_t txByte );
 
+// Send header byte, with the next byte queued behind it, and get the status
+inline uint8_t HAL_SPI_TX_HDR( uint8_t hdr, const uint8_t* next );
+
+// Queue byte as soon as the transmit buffer is free
+inline void HAL_SPI_TX_PUT( uint8_t txByte );
+
+// Wait for a byte to be received, and read it
+inline uint8_t HAL_SPI_RX_GET( void );
+
+// Wait for the last byte to finish, and read it
+inline uint8_t HAL_SPI_TX_END( void );
+
 // ~CS line LOW to start transaction
 inline void HAL_SPI_CSN_HI();
 
 // ~CS line back HIGH to end transaction
 inline void HAL_SPI_CSN_LO( uint16_t dly );
 
+// Take the byte just received by the transfer engine and send the next
+void HAL_SPI_XFER_STEP( void );
+
+// Complete a submitted transfer by polling
+inline void HAL_SPI_XFER_FINISH( void );
+
+// SMCLK divider for the fastest SCLK within HAL_SPI_MAX_KHZ
+#define HAL_SPI_BR()	((HAL_clockMhz * 1000u + HAL_SPI_MAX_KHZ - 1) / HAL_SPI_MAX_KHZ)
+
+// Smallest SCLK divider at which HAL_SPI_READ queues the next dummy byte
+//	before reading the last one: a byte then takes 8 * BR MCLK cycles, more
+//	than one pass of the read loop. At 1, 8 and 12 MHz reads go byte by byte.
+#define HAL_SPI_RX_PIPE_BR	3
+
 ///////////////////////////////////////////////////////////////////////////////
 
 /**
  * Initializes USCIB0 as an SPI Master interface with baud rate equal to
- * undivided SMCLK.
+ * SMCLK, divided down as far as needed to stay within HAL_SPI_MAX_KHZ.
  *
  */
 void HAL_SPI_INIT( void )
@@ -51,25 +102,58 @@ void HAL_SPI_INIT( void )
     // Select clock source (SMCLK)
     UCB0CTL1 |= UCSSEL_2;
 
-    // Just use clock source with no division. Lowest "stable" bitrate is 2.
-    // @TODO: Experiment with different baud rates / clock rates here.
-    UCB0BR0 = 0x01;
+    // Undivided SMCLK up to HAL_SPI_MAX_KHZ (all of 1 MHz, 8 MHz / 2, ...)
+    UCB0BR0 = HAL_SPI_BR();
     UCB0BR1 = 0x00;
 
     // Release for operation
     UCB0CTL1 &= ~UCSWRST;
 
     //@todo Make sure the USCI is NOT consuming power right now
-    // Enable SPI TX/RX interrupt to allow sleep during TX.
-    // This interrupt configuration must after the UCSWRST clear
-    //IFG2 &= ~(UCB0TXIFG | UCB0RXIFG);
-    // IE2 = UCB0TXIE | UCB0RXIE;
+    // The SPI RX interrupt (IE2 UCB0RXIE) is only enabled while the transfer
+    //	engine has a transfer in progress.
+    HAL_SPI_xfer = 0;
+    HAL_SPI_xferWait = 0;
+#if(HAL_DEBUG)
+    HAL_spiOverruns = 0;
+#endif
 
     // Exit the critical section (reenable interrupts)
     HAL_EXIT_CRITICAL();
 }
 
 
+/**
+ * Re-derive the SCLK divider for the current SMCLK frequency. A transfer
+ * submitted to the engine is completed first, at the old rate. Does nothing
+ * before HAL_SPI_INIT. GIE is left as it was found (see HAL_CLOCK_SET).
+ */
+void HAL_SPI_CLOCK( void )
+{
+    uint16_t sr;
+
+    if(!(UCB0CTL1 & UCSSEL_2))
+        {
+            return;
+        }
+
+    sr = __get_SR_register();
+    HAL_ENTER_CRITICAL();
+
+    HAL_SPI_XFER_FINISH();
+    while(HAL_SPI_STAT & UCBUSY);
+
+    UCB0CTL1 |= UCSWRST;
+    HAL_SPI_BR0 = HAL_SPI_BR();
+    UCB0CTL1 &= ~UCSWRST;
+
+    if(sr & GIE)
+        {
+            HAL_EXIT_CRITICAL();
+        }
+}
+
+
 /**
  * Reads the given number of characters from the given location of the
  * connected SPI slave device.
@@ -88,21 +172,44 @@ uint8_t HAL_SPI_READ(uint8_t addr, uint8_t* rxBytePtr, uint8_t len, uint16_t dly
 
     HAL_ENTER_CRITICAL();
 
+    HAL_SPI_XFER_FINISH();	// The bus must be free
+
     // Pull ~CS line LO to start transaction
     HAL_SPI_CSN_LO( dly );
 
-    // Send the address and wait until transmission is complete
-    HAL_SPI_TX_WAIT(addr);
-
-    // Get return code (typically status byte)
-    rc = HAL_SPI_RXBUF;
-
-    for (i = 0; i < len; i++)
+    if(HAL_SPI_BR0 < HAL_SPI_RX_PIPE_BR)
         {
+            // Send the address and wait until transmission is complete
             HAL_SPI_TX_WAIT(addr);
 
-            // Store data from last data RX
-            rxBytePtr[i] = 	HAL_SPI_RXBUF;
+            // Get return code (typically status byte)
+            rc = HAL_SPI_RXBUF;
+
+            for (i = 0; i < len; i++)
+                {
+                    HAL_SPI_TX_WAIT(addr);
+
+                    // Store data from last data RX
+                    rxBytePtr[i] = 	HAL_SPI_RXBUF;
+                }
+        }
+    else
+        {
+            // Send the address, pipelined with the first dummy byte queued
+            //	behind it, and get the return code (typically status byte)
+            rc = HAL_SPI_TX_HDR(addr, len ? &addr : 0);
+
+            for (i = 0; i < len; i++)
+                {
+                    // Queue the next dummy byte while this one is still shifting
+                    if(i + 1 < len)
+                        {
+                            HAL_SPI_TX_PUT(addr);
+                        }
+
+                    // Store data from last data RX
+                    rxBytePtr[i] = HAL_SPI_RX_GET();
+                }
         }
 
     // Pull ~CS line HI to end transaction
@@ -131,17 +238,76 @@ uint8_t HAL_SPI_WRITE(uint8_t addr, uint8_t* txBufPtr, uint8_t len, uint16_t dly
 
     HAL_ENTER_CRITICAL();
 
+    HAL_SPI_XFER_FINISH();	// The bus must be free
+
     HAL_SPI_CSN_LO( dly );	// Pull ~CS line LO to start transaction
 
-    HAL_SPI_TX_WAIT(addr); // Send write address and wait until transmission is complete
+    // Send write address, with the first byte queued behind it, and get the
+    //	return code (typically status byte)
+    rc = HAL_SPI_TX_HDR(addr, len ? txBufPtr : 0);
+
+    for(i = 1; i < len; i++)
+        {
+            HAL_SPI_TX_PUT(txBufPtr[i]); // Queue the next byte as soon as there's room
+        }
+
+    HAL_SPI_TX_END();	// Wait until the last byte is complete
+
+    HAL_SPI_CSN_HI();	// Pull ~CS line HI to end transaction
 
-    rc = HAL_SPI_RXBUF; // Get return code (typically status byte)
+    HAL_EXIT_CRITICAL();
 
-    for(i = 0; i < len; i++)
+    return rc;
+}
+
+/**
+ * Transmits several buffers back to back via the SPI port, as one block
+ * starting at the given address. Lets callers send a constant header from
+ * flash and a payload from their own buffer without copying them together.
+ * Blocks until all characters transmitted.
+ *
+ * @param addr	The first target memory address for the block.
+ * @param segs	The buffers to send, in order. Empty segments are allowed.
+ * @param count	The number of segments.
+ * @param dly	The number of ticks to wait after lowering ~CS line
+ * @return The return code from the first SPI transaction
+ *
+ */
+uint8_t HAL_SPI_WRITE_GATHER(uint8_t addr, const HAL_SPI_seg_t* segs, uint8_t count, uint16_t dly)
+{
+    uint8_t i;
+    uint8_t rc;
+    const uint8_t* p;
+
+    HAL_ENTER_CRITICAL();
+
+    HAL_SPI_XFER_FINISH();	// The bus must be free
+
+    HAL_SPI_CSN_LO( dly );	// Pull ~CS line LO to start transaction
+
+    // Skip to the first byte to send
+    while(count && !segs->len)
+        {
+            count--;
+            segs++;
+        }
+
+    // Send write address, with the first byte queued behind it, and get the
+    //	return code (typically status byte)
+    rc = HAL_SPI_TX_HDR(addr, count ? segs->ptr : 0);
+
+    for(i = 1; count; count--, segs++)
         {
-            HAL_SPI_TX_WAIT(txBufPtr[i]); // Send the next byte and wait until tx complete
+            // Skips the byte already queued in the first segment only
+            p = segs->ptr + i;
+            for(i = segs->len - i; i; i--)
+                {
+                    HAL_SPI_TX_PUT(*p++); // Queue the next byte as soon as there's room
+                }
         }
 
+    HAL_SPI_TX_END();	// Wait until the last byte is complete
+
     HAL_SPI_CSN_HI();	// Pull ~CS line HI to end transaction
 
     HAL_EXIT_CRITICAL();
@@ -160,17 +326,179 @@ uint8_t HAL_SPI_WRITE(uint8_t addr, uint8_t* txBufPtr, uint8_t len, uint16_t dly
  */
 uint8_t HAL_SPI_STROBE(uint8_t strobeCmd, uint16_t dly)
 {
+    uint8_t rc;
+
     HAL_ENTER_CRITICAL();
 
+    HAL_SPI_XFER_FINISH();	// The bus must be free
+
     HAL_SPI_CSN_LO( dly );	// Pull ~CS line LO to start transaction
 
-    HAL_SPI_TX_WAIT(strobeCmd); // Send the next byte and wait until tx complete
+    HAL_SPI_TXBUF = strobeCmd; // Send the strobe (the USCI is idle between transactions)
+
+    rc = HAL_SPI_TX_END(); // Get the return code (typically status byte)
 
     HAL_SPI_CSN_HI();
 
     HAL_EXIT_CRITICAL();
 
-    return HAL_SPI_RXBUF; // pass back the return code (typically status byte)
+    return rc;
+}
+
+/**
+ * Start an interrupt-driven transfer and return at once: the header byte is
+ * sent here, and every following byte from the USCI receive interrupt of
+ * the one before. ~CS stays low until the transfer is complete, when
+ * xfer->rc holds the return code and the callback (if any) is called from
+ * the ISR. The descriptor and its buffer must stay valid until then.
+ *
+ * @param xfer	The transfer to start
+ * @return HAL_SUCCESS, or HAL_FAIL if a transfer is already in progress.
+ */
+int16_t HAL_SPI_SUBMIT(HAL_SPI_xfer_t* xfer)
+{
+    HAL_ENTER_CRITICAL();
+
+    if(HAL_SPI_xfer)
+        {
+            HAL_EXIT_CRITICAL();
+            return HAL_FAIL;
+        }
+
+    HAL_SPI_CSN_LO( xfer->dly );	// Pull ~CS line LO to start transaction
+
+    HAL_SPI_xfer = xfer;
+    HAL_SPI_xferDone = 0;
+    HAL_SPI_TXBUF = xfer->addr;		// The USCI is idle between transactions
+    IE2 |= UCB0RXIE;
+
+    HAL_EXIT_CRITICAL();
+
+    return HAL_SUCCESS;
+}
+
+/**
+ * @return Non-zero while a transfer started by HAL_SPI_SUBMIT is in progress.
+ */
+uint8_t HAL_SPI_XFER_BUSY(void)
+{
+    return HAL_SPI_xfer != 0;
+}
+
+/**
+ * Sleep in LPM1 until the transfer started by HAL_SPI_SUBMIT is complete.
+ * SMCLK keeps clocking the USCI, and each byte's interrupt wakes the CPU only
+ * for the ISR. Returns at once if no transfer is in progress.
+ *
+ * @pre Not called from an ISR.
+ */
+void HAL_SPI_XFER_WAIT(void)
+{
+    HAL_DISABLE_INTERRUPTS();
+
+    // Checked with interrupts off, so completion can't slip in before the
+    //	sleep: LPM1 entry enables them in the same instruction.
+    while(HAL_SPI_xfer)
+        {
+            HAL_SPI_xferWait = 1;
+            HAL_LPM1_SLEEP();
+            HAL_DISABLE_INTERRUPTS();
+        }
+    HAL_SPI_xferWait = 0;
+
+    HAL_ENABLE_INTERRUPTS();
+}
+
+/**
+ * Transfer in LPM1: submit the transfer, waiting for one in progress first,
+ * and sleep until it is complete.
+ *
+ * @param xfer	The transfer
+ * @return The return code from the first SPI transaction
+ *
+ * @pre Not called from an ISR.
+ */
+uint8_t HAL_SPI_XFER(HAL_SPI_xfer_t* xfer)
+{
+    while(HAL_SUCCESS != HAL_SPI_SUBMIT(xfer))
+        {
+            HAL_SPI_XFER_WAIT();
+        }
+
+    HAL_SPI_XFER_WAIT();
+
+    return xfer->rc;
+}
+
+/**
+ * USCI receive ISR: the transfer engine's byte just completed. The vector
+ * is shared with the USCI_A0 UART, so anything else is left alone.
+ */
+#pragma vector=HAL_SPI_RX_VECTOR
+__interrupt void HAL_SPI_RX_ISR( void )
+{
+    if(!(HAL_SPI_IFG & HAL_SPI_RXIFG) || !HAL_SPI_xfer)
+        {
+            return;
+        }
+
+    HAL_SPI_XFER_STEP();
+
+    // Wake HAL_SPI_XFER_WAIT once the transfer is complete
+    if(!HAL_SPI_xfer && HAL_SPI_xferWait)
+        {
+            HAL_SPI_xferWait = 0;
+            HAL_LPM1_WAKEUP();
+        }
+}
+
+/**
+ * Take the byte the transfer engine just received, then send the next one
+ * or end the transfer. Called with UCB0RXIFG set.
+ */
+void HAL_SPI_XFER_STEP( void )
+{
+    HAL_SPI_xfer_t* xfer = HAL_SPI_xfer;
+    uint8_t b = HAL_SPI_RXBUF;
+    uint8_t i = HAL_SPI_xferDone++;
+
+    if(!i)
+        {
+            xfer->rc = b;
+        }
+    else if(HAL_SPI_XFER_READ == xfer->dir)
+        {
+            xfer->buf[i - 1] = b;
+        }
+
+    if(i < xfer->len)
+        {
+            // Send the next byte: data, or a dummy byte to read one
+            HAL_SPI_TXBUF = (HAL_SPI_XFER_READ == xfer->dir) ? xfer->addr : xfer->buf[i];
+            return;
+        }
+
+    IE2 &= ~UCB0RXIE;
+    HAL_SPI_CSN_HI();	// Pull ~CS line HI to end transaction
+    HAL_SPI_xfer = 0;
+
+    if(xfer->callback)
+        {
+            xfer->callback(xfer);
+        }
+}
+
+/**
+ * Complete the transfer in progress (if any) by polling. Called with
+ * interrupts disabled, so that the ISR can't step it at the same time.
+ */
+void HAL_SPI_XFER_FINISH( void )
+{
+    while(HAL_SPI_xfer)
+        {
+            while(!(HAL_SPI_IFG & HAL_SPI_RXIFG));
+            HAL_SPI_XFER_STEP();
+        }
 }
 
 /**
@@ -186,8 +514,76 @@ void HAL_SPI_TX_WAIT( uint8_t txByte )
     HAL_SPI_TXBUF = txByte;
 
     while(UCB0STAT & UCBUSY);
+}
+
+/**
+ * Send the header byte of a transaction, queue the byte to follow it (if
+ * any) and wait for the header to complete. Assumes ~CS line is already LOW
+ * and the USCI idle.
+ *
+ * @param hdr	The header byte (address or command strobe)
+ * @param next	The byte to send next, or 0 for none
+ * @return The byte received during the header (typically status byte)
+ *
+ * @todo Use interrupts here
+ */
+uint8_t HAL_SPI_TX_HDR( uint8_t hdr, const uint8_t* next )
+{
+    HAL_SPI_TXBUF = hdr;
+
+    if(next)
+        {
+            HAL_SPI_TX_PUT(*next);
+        }
+
+    return HAL_SPI_RX_GET();
+}
+
+/**
+ * Load the given byte into the transmit buffer as soon as it is free: once
+ * the byte before it has moved to the shift register, while it still shifts.
+ *
+ * @param txByte The byte to send
+ */
+void HAL_SPI_TX_PUT( uint8_t txByte )
+{
+    while(!(HAL_SPI_IFG & HAL_SPI_TXIFG));
+
+    HAL_SPI_TXBUF = txByte;
+}
+
+/**
+ * Wait for the next byte to be received, and read it. Must be called before
+ * the byte after it completes, or it is overwritten.
+ *
+ * @return The received byte
+ */
+uint8_t HAL_SPI_RX_GET( void )
+{
+    while(!(HAL_SPI_IFG & HAL_SPI_RXIFG));
+
+#if(HAL_DEBUG)
+    // Reading UCB0RXBUF clears UCOE
+    if(HAL_SPI_STAT & UCOE)
+        {
+            HAL_spiOverruns++;
+        }
+#endif
+
+    return HAL_SPI_RXBUF;
+}
+
+/**
+ * Wait until every queued byte has been sent. Writes don't collect what they
+ * receive, so read the receive buffer to leave UCB0RXIFG clear.
+ *
+ * @return The byte received during the last byte sent
+ */
+uint8_t HAL_SPI_TX_END( void )
+{
+    while(HAL_SPI_STAT & UCBUSY);
 
-    //HAL_LPM1_SLEEP();
+    return HAL_SPI_RXBUF;
 }
 
 /**
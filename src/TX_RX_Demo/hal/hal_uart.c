@@ -24,6 +24,13 @@
 #define	HAL_UART_ESC_NEWFRAME_CHAR	0x01
 #define HAL_UART_ESC_ESCAPE_CHAR	0x02
 
+///////////////////////////////////////////////////////////////////////////////
+// Local prototypes
+///////////////////////////////////////////////////////////////////////////////
+
+// Program the 9600 baud divider and modulation for the current SMCLK
+void HAL_UART_BAUD( void );
+
 ///////////////////////////////////////////////////////////////////////////////
 
 /**
@@ -36,14 +43,71 @@ void HAL_UART_INIT( void )
     UCA0CTL1 |= UCSWRST;
     // UCA0CTL0 |= UCMSB;				//MSB first
     UCA0CTL1 |= UCSSEL_2;				// SMCLK
-    UCA0MCTL = UCBRS0;					// Modulation UCBRSx = 1
-    UCA0BR0 = 104;						// Baud rate of 9600 (can change later)
-    UCA0BR1 = 0;						// (UCA0BR0 + UCA0BR1 * 256 = UCBR)
+    HAL_UART_BAUD();					// Baud rate of 9600 (can change later)
     P3SEL |= BIT4 | BIT5;				// P3.4,5 = USCI_A0 TXD/RXD
     UCA0CTL1 &= ~UCSWRST;				// **Initialize USCI state machine**
     HAL_EXIT_CRITICAL();
 }
 
+/**
+ * Re-derive the baud rate registers for the current SMCLK frequency. A byte
+ * being sent is completed first, at the old rate. Does nothing before
+ * HAL_UART_INIT. GIE is left as it was found (see HAL_CLOCK_SET).
+ */
+void HAL_UART_CLOCK( void )
+{
+    uint16_t sr;
+
+    if(!(UCA0CTL1 & UCSSEL_2))
+        {
+            return;
+        }
+
+    sr = __get_SR_register();
+    HAL_ENTER_CRITICAL();
+    while(UCA0STAT & UCBUSY);
+    UCA0CTL1 |= UCSWRST;
+    HAL_UART_BAUD();
+    UCA0CTL1 &= ~UCSWRST;
+    if(sr & GIE)
+        {
+            HAL_EXIT_CRITICAL();
+        }
+}
+
+/**
+ * Program 9600 baud for the current SMCLK (UCBR = UCA0BR0 + UCA0BR1 * 256,
+ * second-stage modulation UCBRSx), per the family user's guide table.
+ * Assumes UCSWRST is set.
+ */
+void HAL_UART_BAUD( void )
+{
+    uint16_t br;
+
+    switch(HAL_clockMhz)
+        {
+        case 16:
+            br = 1666;
+            UCA0MCTL = UCBRS_6;
+            break;
+        case 12:
+            br = 1250;
+            UCA0MCTL = UCBRS_0;
+            break;
+        case 8:
+            br = 833;
+            UCA0MCTL = UCBRS_2;
+            break;
+        default:
+            br = 104;
+            UCA0MCTL = UCBRS_1;
+            break;
+        }
+
+    UCA0BR0 = br & 0xFF;
+    UCA0BR1 = br >> 8;
+}
+
 
 /**
  * Transmits the given string of characters via the UART.
@@ -53,8 +117,6 @@ void HAL_UART_INIT( void )
  * @param len The length of the string in bytes.
  * @return Always returns HAL_SUCCESS
  *
- * @pre SMCLK assumed to be 1 MHz
- *
  * @todo Use TX interrupts when requested by user
  *
  */
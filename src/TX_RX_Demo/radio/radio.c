@@ -20,33 +20,201 @@
 ///////////////////////////////////////////////////////////////////////////////
 // Radio state variables
 ///////////////////////////////////////////////////////////////////////////////
-// Buffer for parsing received data
-uint8_t RADIO_rxBuf[RADIO_PKT_LEN];	// Receive buffer
-uint8_t RADIO_txBuf[RADIO_PKT_LEN];	// Transmit buffer
-
-void (*RADIO_rxCallback) (void);		// Callback pointer
-
-enum RADIO_state_e // Tracks expected current state of radio
+// Received packet, as queued by the GDO ISR
+typedef struct RADIO_rx_slot_s
+{
+    uint8_t len;					// Bytes in data {HDR, PAYLOAD}, not counting status
+    uint8_t data[RADIO_PKT_LEN + RADIO_STATUS_LEN];
+} RADIO_rx_slot_t;
+
+// Receive queue. One slot more than the capacity so the ISR always has a
+//	slot to drain the radio FIFO into, even when the queue is full.
+RADIO_rx_slot_t RADIO_rxQueue[RADIO_RX_QUEUE_LEN + 1];
+uint8_t RADIO_rxHead;				// Next slot to be read by RADIO_RECEIVE
+uint8_t RADIO_rxTail;				// Next slot to be filled by the ISR
+uint16_t RADIO_rxOverflows;			// Packets dropped on a full queue
+
+uint8_t RADIO_rxWor;				// Receive by WOR polling instead of continuous RX
+
+#if(RADIO_STREAM)
+uint8_t RADIO_rxOpen;				// A packet is being drained into the tail slot
+uint16_t RADIO_rxGot;				// Bytes of it (and its status) already in the slot
+#endif
+
+RADIO_tx_stats_t RADIO_txStats;		// Transmit and CCA backoff counters
+#if(RADIO_TX_CCA || RADIO_USE_ARQ)
+uint16_t RADIO_txRand;				// Backoff generator state (16-bit LFSR)
+#endif
+
+uint8_t RADIO_channel;				// Channel number loaded into CHANNR
+uint8_t RADIO_txPwr;				// PATABLE setting in use, restored on wake
+
+// Synthesizer calibration results for a channel and temperature bucket
+typedef struct RADIO_cal_s
+{
+    uint8_t chan;
+    uint8_t bucket;					// Temperature reading / RADIO_CAL_TEMP_STEP
+    uint8_t fscal[3];				// FSCAL3, FSCAL2, FSCAL1
+} RADIO_cal_t;
+
+RADIO_cal_t RADIO_calCache[RADIO_CAL_CACHE_LEN];
+uint8_t RADIO_calCount;				// Entries of RADIO_calCache in use
+uint8_t RADIO_calVictim;			// Entry replaced next when the cache is full
+uint8_t RADIO_calLoaded;			// Entry held by the FSCAL registers, or RADIO_CAL_NONE
+uint8_t RADIO_calBucket;			// Temperature bucket of the last RADIO_CALIBRATE_CACHED
+
+// Channel hopping sequence shared by every node of the network
+uint8_t RADIO_hopSeq[RADIO_HOP_CHANNELS];	// Channel numbers in the order visited
+uint8_t RADIO_hopIndex;				// Entry of RADIO_hopSeq last hopped to
+uint16_t RADIO_hopExcluded;			// Bit i set: RADIO_hopSeq[i] is skipped
+
+uint8_t RADIO_profile;				// Modem profile in use, a RADIO_PROFILE_ value
+
+#if(RADIO_USE_ARQ)
+// Last sequence number received from a sender, to drop resent duplicates
+typedef struct RADIO_arq_peer_s
+{
+    uint8_t addr;
+    uint8_t seq;					// RADIO_ARQ_SEQ_BM bits, 0xFF if none yet
+} RADIO_arq_peer_t;
+
+RADIO_arq_peer_t RADIO_arqPeers[RADIO_ARQ_PEERS];
+uint8_t RADIO_arqVictim;			// Peer entry replaced next when all are in use
+
+uint8_t RADIO_txCtl;				// ARQ control byte of the packet being sent
+uint8_t RADIO_txDst;				// Its destination, which must send the ACK
+uint8_t RADIO_txSeq;				// Sequence number of the last packet
+uint8_t RADIO_txRetries;			// Resends of the last packet
+volatile uint8_t RADIO_ackWait;		// Listening for the ACK of the packet sent
+uint8_t RADIO_acked;				// The last packet was acknowledged
+uint8_t RADIO_ackStatus[2];			// RSSI/LQI it was received with, from its ACK
+
+// ACK to be sent for the packet just received: {[LEN], DST, SRC, CTL, [RSSI, LQI]}
+uint8_t RADIO_ackFrame[RADIO_LEN_FIELD + RADIO_ACK_LEN];
+uint8_t RADIO_ackPending;			// RADIO_ackFrame is waiting to be sent
+volatile uint8_t RADIO_ackBusy;		// An ACK is on the air
+
+// ACK timeout of each profile, from its byte time (us) and FEC
+const uint16_t RADIO_ARQ_TIMEOUTS[RADIO_PROFILES] =
+{
+    RADIO_ARQ_TIMEOUT(800, RADIO_USE_FEC),	// RADIO_PROFILE_10K
+    RADIO_ARQ_TIMEOUT(32, RADIO_USE_FEC),	// RADIO_PROFILE_250K
+    RADIO_ARQ_TIMEOUT(16, FALSE)			// RADIO_PROFILE_500K
+};
+#endif
+
+// Power ladder: optimum PATABLE setting and output power of each level
+const uint8_t RADIO_PA_LADDER[RADIO_PWR_LEVELS] =
+{
+    0x50, 0x44, 0xC0, 0x84, 0x81, 0x46, 0x93, 0x55, 0x8D,
+    0xC6, 0x97, 0x6E, 0x7F, 0xA9, 0xBB, 0xFE, 0xFF
+};
+const int8_t RADIO_PA_DBM[RADIO_PWR_LEVELS] =
 {
-    // Only states which persist between RADIO_ function calls are needed here.
-    RADIO_STATE_SLEEP,
-    RADIO_STATE_IDLE,
-    RADIO_STATE_RECEIVE_POLL
-} RADIO_state;
+    -30, -28, -26, -24, -22, -20, -18, -16, -14,
+    -12, -10, -8, -6, -4, -2, 0, 1
+};
 
-uint8_t RADIO_rxNewData;
+#if(!RADIO_VAR_LEN)
+// Padding for payloads shorter than the fixed packet length
+const uint8_t RADIO_TX_PAD[RADIO_PAY_LEN] = {0};
+#endif
+
+void (*RADIO_rxCallback) (void);		// Callback pointer
+void (*RADIO_txCallback) (void);		// TX completion callback pointer (optional)
+volatile uint8_t RADIO_txBusy;		// Packet on the air, waiting for GDO2 to fall
+volatile int16_t RADIO_txResult;	// Outcome of the packet being sent
+
+HAL_SPI_seg_t RADIO_txSeg[3];		// Packet bytes not yet loaded into the TX FIFO
+uint16_t RADIO_txLeft;				// Total length of RADIO_txSeg
+#if(RADIO_STREAM)
+uint8_t RADIO_txStream;				// GDO0 switched to the TX FIFO threshold
+#endif
+
+// Chip status byte returned by the last SPI transaction: {CHIP_RDYn, STATE,
+//	FIFO_BYTES_AVAILABLE}. Set to CHIP_RDYn alone while the radio sleeps.
+uint8_t RADIO_status;
+uint8_t RADIO_rxAvail;				// RX FIFO bytes, as of the last read (up to 15)
+uint8_t RADIO_txFree;				// TX FIFO free bytes, as of the last write (up to 15)
 
 ///////////////////////////////////////////////////////////////////////////////
 /// Macros
 ///////////////////////////////////////////////////////////////////////////////
-// Compute delay to use after ~CS low edge based on current radio state
-#define RADIO_CS_DLY()	((RADIO_state==RADIO_STATE_SLEEP) ? RADIO_CS_DLY_TIME : 0)
+// The radio is asleep: its crystal is off, so it isn't CHIP_RDY
+#define RADIO_ASLEEP()	(RADIO_status & CC2500_STATUS_CHIP_RDYn_BM)
+
+// Delay to use after ~CS low edge. A sleeping radio is woken by RADIO_WAKE
+//	first, which leaves it ready, so no delay is ever needed.
+#define RADIO_CS_DLY()	(RADIO_ASLEEP() ? (RADIO_WAKE(), 0) : 0)
+
+// SPI transactions with the radio, keeping the status byte each returns
+#define RADIO_SPI_READ(addr, buf, len, dly) \
+	RADIO_STATUS_UPDATE((addr), HAL_SPI_READ((addr), (buf), (len), (dly)))
+#define RADIO_SPI_WRITE(addr, buf, len, dly) \
+	RADIO_STATUS_UPDATE((addr), HAL_SPI_WRITE((addr), (buf), (len), (dly)))
+#define RADIO_SPI_WRITE_GATHER(addr, segs, count, dly) \
+	RADIO_STATUS_UPDATE((addr), HAL_SPI_WRITE_GATHER((addr), (segs), (count), (dly)))
+#define RADIO_SPI_STROBE(cmd, dly) \
+	RADIO_STATUS_UPDATE((cmd), HAL_SPI_STROBE((cmd), (dly)))
+
+// Run bursts of radio work (FIFO loads and drains) at HAL_CLOCK_FAST, then
+//	switch back to the clock the caller had
+#if(HAL_CLOCK_FAST != HAL_CLOCK_FREQ)
+#define RADIO_CLOCK_FAST()		HAL_CLOCK_SET(HAL_CLOCK_FAST)
+#define RADIO_CLOCK_BACK(mhz)	HAL_CLOCK_SET(mhz)
+#else
+#define RADIO_CLOCK_FAST()		HAL_clockMhz
+#define RADIO_CLOCK_BACK(mhz)	((void)(mhz))
+#endif
+
+// SLEEP reverts FSTEST..TEST0 to their reset values, so they only need to be
+//	written back on wake if the SmartRF settings differ
+#define RADIO_TEST_LOST	(SMARTRF_SETTING_FSTEST != 0x59 || SMARTRF_SETTING_PTEST != 0x7F \
+						 || SMARTRF_SETTING_AGCTEST != 0x3F || SMARTRF_SETTING_TEST2 != 0x88 \
+						 || SMARTRF_SETTING_TEST1 != 0x31 || SMARTRF_SETTING_TEST0 != 0x0B)
+
+// RADIO_calLoaded when the FSCAL registers match no cache entry
+#define RADIO_CAL_NONE	0xFF
+
+// Advance a receive queue index
+#define RADIO_RX_NEXT(i)	(((i) == RADIO_RX_QUEUE_LEN) ? 0 : (i) + 1)
+
+// Packet length being received in fixed-length mode: the ACK length while
+//	an ACK is awaited (PKTLEN is switched for it)
+#if(RADIO_USE_ARQ)
+#define RADIO_FIXED_LEN()	(RADIO_ackWait ? RADIO_ACK_LEN : RADIO_PKT_LEN)
+#else
+#define RADIO_FIXED_LEN()	RADIO_PKT_LEN
+#endif
+
+///////////////////////////////////////////////////////////////////////////////
+// Local prototypes
+///////////////////////////////////////////////////////////////////////////////
+uint8_t RADIO_STATUS_UPDATE( uint8_t hdr, uint8_t status );
+void RADIO_TX_FILL( uint8_t room );
+RADIO_cal_t* RADIO_CAL_FIND( uint8_t bucket );
+void RADIO_CAL_LOAD( uint8_t bucket );
+int16_t RADIO_TX_SEND( uint8_t addr, uint8_t* msg, uint8_t len );
+#if(RADIO_TX_CCA || RADIO_USE_ARQ)
+void RADIO_BACKOFF( uint16_t window, uint8_t stir );
+#endif
+#if(RADIO_STREAM)
+uint8_t RADIO_RX_DRAIN( uint8_t avail, uint8_t end );
+#endif
+#if(RADIO_USE_ARQ)
+uint8_t RADIO_ARQ_RX( RADIO_rx_slot_t* slot );
+void RADIO_ARQ_TX_DONE( void );
+void RADIO_ARQ_END( void );
+void RADIO_ARQ_SEND_ACK( void );
+void RADIO_ARQ_ACK_SENT( void );
+#endif
 
 ///////////////////////////////////////////////////////////////////////////////
 
 /**
  * Initialize the radio with default settings.
- * Reset the radio and send all configuration data.
+ * Reset the radio and send the configuration data which differs from the
+ * reset values.
  *
  * @return RADIO_SUCCESS if everything worked properly, RADIO_FAIL if not.
  *
@@ -55,8 +223,17 @@ uint8_t RADIO_rxNewData;
  */
 int16_t RADIO_INIT( void )
 {
-    // Radio is in IDLE state by default upon power-on. Assume it's there now.
-    RADIO_state = RADIO_STATE_IDLE;
+    const uint8_t* run;
+    uint16_t rand;
+    uint8_t chan;
+    uint8_t i;
+    uint8_t j;
+
+    // Radio is in IDLE state by default upon power-on. Assume it's there now,
+    //	with both FIFOs empty.
+    RADIO_status = CC2500_STATE_IDLE;
+    RADIO_rxAvail = 0;
+    RADIO_txFree = CC2500_STATUS_FIFO_BYTES_AVAILABLE_BM;
 
     // SCLK = 1, SI = 0 to avoid potential problems with pin control mode
     BSP_SPI_POUT |= BSP_SPI_CLK_BIT | BSP_SPI_CS_BIT;
@@ -71,19 +248,96 @@ int16_t RADIO_INIT( void )
     while(BSP_SPI_PIN & BSP_SPI_SOMI_BIT);
 
     // Reset the radio. Assumes the radio has just powered on and is IDLE.
-    HAL_SPI_STROBE(CC2500_SRES, 0); /// @todo make a macro for strobe values (better portability)
+    RADIO_SPI_STROBE(CC2500_SRES, 0); /// @todo make a macro for strobe values (better portability)
 
     // Wait for reset to complete (hold on a HI SOMI line).
     while(BSP_SPI_PIN & BSP_SPI_SOMI_BIT);
 
-    //Transmit all configuration register values as a block.
-    //	It's faster to transmit all registers than to hop btwn necessary ones.
-    HAL_SPI_WRITE((RADIO_REG_BLOCK_START | CC2500_WRITE_BURST), (uint8_t*)RADIO_REG_SETTINGS, RADIO_REG_BLOCK_LEN, 0);
+    // Transmit the configuration registers which differ from their reset
+    //	values, a burst per run of them.
+    for(run = RADIO_REG_RUNS; *run; run += 2 + run[1])
+        {
+            RADIO_SPI_WRITE(run[0], (uint8_t*)&run[2], run[1], 0);
+        }
 
     /// @todo Make sure radio is idle at this point
 
-    // Clear newData flag
-    RADIO_rxNewData = 0;
+    // Empty the receive queue
+    RADIO_rxHead = 0;
+    RADIO_rxTail = 0;
+    RADIO_rxOverflows = 0;
+
+    // Continuous receive until WOR is selected
+    RADIO_rxWor = 0;
+
+    // PATABLE setting after reset
+    RADIO_txPwr = 0xC6;
+
+    // The register map holds the SmartRF modem settings
+    RADIO_profile = RADIO_PROFILE_250K;
+
+    // The reset left the SmartRF FSCAL values, which match no calibration
+    RADIO_channel = SMARTRF_SETTING_CHANNR;
+    RADIO_calCount = 0;
+    RADIO_calVictim = 0;
+    RADIO_calLoaded = RADIO_CAL_NONE;
+    RADIO_calBucket = RADIO_CAL_NONE;
+
+    // Shuffle the hop channels with a generator seeded by the network ID, so
+    //	every node of the network derives the same sequence
+    for(i = 0; i < RADIO_HOP_CHANNELS; i++)
+        {
+            RADIO_hopSeq[i] = SMARTRF_SETTING_CHANNR + i * RADIO_HOP_SPACING;
+        }
+    rand = ((uint16_t)RADIO_NWK_ID << 8) | 0x00FF;
+    for(i = RADIO_HOP_CHANNELS - 1; i; i--)
+        {
+            rand = (rand >> 1) ^ ((rand & 1) ? 0xB400 : 0);
+            j = rand % (i + 1);
+            chan = RADIO_hopSeq[i];
+            RADIO_hopSeq[i] = RADIO_hopSeq[j];
+            RADIO_hopSeq[j] = chan;
+        }
+    RADIO_hopIndex = 0;
+    RADIO_hopExcluded = 0;
+
+    RADIO_txCallback = 0;
+    RADIO_rxCallback = 0;
+    RADIO_txBusy = 0;
+    RADIO_txLeft = 0;
+#if(RADIO_STREAM)
+    RADIO_rxOpen = 0;
+    RADIO_txStream = 0;
+#endif
+
+    RADIO_txStats.packets = 0;
+    RADIO_txStats.ccaFails = 0;
+    RADIO_txStats.drops = 0;
+    RADIO_txStats.underflows = 0;
+    RADIO_txStats.retries = 0;
+    RADIO_txStats.noAcks = 0;
+    RADIO_txStats.backoffTicks = 0;
+#if(RADIO_TX_CCA || RADIO_USE_ARQ)
+    // Seed the backoff generator differently at every node (never zero)
+    RADIO_txRand = ((uint16_t)RADIO_NWK_ID << 8) | RADIO_DEV_ID | 0x0001;
+#endif
+
+#if(RADIO_USE_ARQ)
+    for(RADIO_arqVictim = 0; RADIO_arqVictim < RADIO_ARQ_PEERS; RADIO_arqVictim++)
+        {
+            RADIO_arqPeers[RADIO_arqVictim].addr = RADIO_ADDR_BROADCAST;
+            RADIO_arqPeers[RADIO_arqVictim].seq = 0xFF;
+        }
+    RADIO_arqVictim = 0;
+
+    RADIO_txCtl = 0;
+    RADIO_txSeq = 0;
+    RADIO_txRetries = 0;
+    RADIO_ackWait = 0;
+    RADIO_acked = 0;
+    RADIO_ackPending = 0;
+    RADIO_ackBusy = 0;
+#endif
 
     return RADIO_SUCCESS;
 }
@@ -103,10 +357,26 @@ int16_t RADIO_SETUP_RX( void (*rxCallback)(void) )
 
     // Configure GDO line to produce an edge upon received data.
     //	Already configured in RADIO_INIT() register configuration.
-    /// @todo If CRC enabled, config GDO to produce edge only on good CRC.
 
     // Configure interrupting on proper GDO signal.
-    BSP_GDO_PIES |= BSP_GDO0_BIT; // Interrupt on falling edge of Sync signal
+#if(RADIO_STREAM)
+    // Rising edge of the RX FIFO threshold on GDO0 to drain the FIFO while
+    //	the packet arrives, falling edge of Sync on GDO2 for the rest of it
+    BSP_GDO_PIES &= ~BSP_GDO0_BIT;
+    BSP_GDO_PIES |= BSP_GDO2_BIT;
+    BSP_GDO_PIFG &= ~BSP_GDO2_BIT;
+    BSP_GDO_PIE |= BSP_GDO2_BIT;
+#elif(RADIO_USE_CRC && !RADIO_USE_ARQ)
+    // Interrupt on rising edge of CRC OK signal; falling edge of Sync under WOR
+    if(RADIO_rxWor)
+        BSP_GDO_PIES |= BSP_GDO0_BIT;
+    else
+        BSP_GDO_PIES &= ~BSP_GDO0_BIT;
+#else
+    // Interrupt on falling edge of Sync signal. With RADIO_USE_ARQ the MCU
+    //	sees the end of every packet, to send the ACK or resume RX.
+    BSP_GDO_PIES |= BSP_GDO0_BIT;
+#endif
     BSP_GDO_PIFG &= ~BSP_GDO0_BIT;
     BSP_GDO_PIE |= BSP_GDO0_BIT;
 
@@ -119,65 +389,249 @@ int16_t RADIO_SETUP_RX( void (*rxCallback)(void) )
     // Delay by > 88.4 us to transition from IDLE to RX
     HAL_PRECISE_DELAY(3); // 3*30.5us > 88.4us
 
-    // Update local state variable
-    RADIO_state = RADIO_STATE_RECEIVE_POLL;
+    return RADIO_SUCCESS;
+}
+
+/**
+ * Configure a function to be called from the GDO ISR when a packet has been
+ * sent, e.g. to start the next one after RADIO_TX_START.
+ *
+ * @param txCallback the function to call at the end of every packet, or 0.
+ * @return RADIO_SUCCESS if everything worked properly, RADIO_FAIL if not.
+ */
+int16_t RADIO_SETUP_TX( void (*txCallback)(void) )
+{
+    RADIO_txCallback = txCallback;
 
     return RADIO_SUCCESS;
 }
 
 /**
  * Strobes the radio to start receive polling. Must have called RADIO_SETUP_RX
- * prior to using this function.
+ * prior to using this function. Uses Wake-on-Radio polling if selected by
+ * RADIO_RX_WOR, continuous receive otherwise.
+ *
+ * @pre The radio needs to be in IDLE mode.
  */
 int16_t RADIO_RX_POLL( void )
 {
-    HAL_SPI_STROBE(CC2500_SRX, RADIO_CS_DLY());
+    // Drop whatever a previous receive left in the FIFO, such as the start of
+    //	a packet cut off by going to IDLE, so that reads stay aligned.
+    RADIO_SPI_STROBE(CC2500_SFRX, RADIO_CS_DLY());
+#if(RADIO_STREAM)
+    RADIO_rxOpen = 0;
+#endif
+
+    RADIO_SPI_STROBE(RADIO_rxWor ? CC2500_SWOR : CC2500_SRX, 0);
 
     return RADIO_SUCCESS;
 }
 
 /**
-  * Parses the received data and copies the payload into the given user array.
-  * Currently supports only statically sized payloads.
+ * Select Wake-on-Radio receive polling. The radio sleeps and wakes itself
+ * every Event 0 period to listen for a sync word, for at most the RX timeout.
+ * The MCU is only interrupted when a packet is received. Takes effect at the
+ * next RADIO_RX_POLL (or RADIO_SETUP_RX).
+ *
+ * Transmitters need to repeat a packet back to back for at least one Event 0
+ * period so that one of its sync words falls in a listen window.
+ *
+ * @param event0 The wake-up period in units of 923 us (see RADIO_WOR_EVENT0)
+ * @param rxTime MCSM2.RX_TIME: listen for (18.03 us * event0) >> rxTime, or
+ *			until a packet arrives if RADIO_WOR_RX_TIME_NONE.
+ * @return RADIO_SUCCESS if everything worked properly, RADIO_FAIL if not.
+ *
+ * @pre The radio needs to be in IDLE or Sleep mode.
+ */
+int16_t RADIO_RX_WOR( uint16_t event0, uint8_t rxTime )
+{
+    uint8_t wor[3];
+    uint8_t mcsm[2];
+#if(RADIO_USE_CRC && !RADIO_STREAM && !RADIO_USE_ARQ)
+    uint8_t gdo;
+#endif
+
+    if(!event0 || rxTime > RADIO_WOR_RX_TIME_NONE)
+        {
+            return RADIO_FAIL;
+        }
+
+    // Event 0 period and WOR control
+    wor[0] = event0 >> 8;
+    wor[1] = event0 & 0xFF;
+    wor[2] = RADIO_WORCTRL;
+    RADIO_SPI_WRITE((CC2500_WOREVT1 | CC2500_WRITE_BURST), wor, 3, RADIO_CS_DLY());
+
+    // RX timeout, and IDLE after a packet so that polling can be resumed
+    mcsm[0] = rxTime;
+    mcsm[1] = RADIO_REG_SETTINGS[CC2500_MCSM1 - RADIO_REG_BLOCK_START] & ~0x0C;
+    RADIO_SPI_WRITE((CC2500_MCSM2 | CC2500_WRITE_BURST), mcsm, 2, 0);
+
+#if(RADIO_USE_CRC && !RADIO_STREAM && !RADIO_USE_ARQ)
+    // A packet failing CRC also ends in IDLE, so every packet has to wake the
+    //	MCU to resume polling: interrupt on the falling edge of Sync instead.
+    gdo = 0x06;
+    RADIO_SPI_WRITE((CC2500_IOCFG0 | CC2500_WRITE_SINGLE), &gdo, 1, 0);
+    BSP_GDO_PIES |= BSP_GDO0_BIT;
+    BSP_GDO_PIFG &= ~BSP_GDO0_BIT;
+#endif
+
+    RADIO_rxWor = 1;
+
+    return RADIO_SUCCESS;
+}
+
+/**
+ * Return to continuous receive polling, restoring the default WOR and state
+ * machine settings. Takes effect at the next RADIO_RX_POLL.
+ *
+ * @return RADIO_SUCCESS if everything worked properly, RADIO_FAIL if not.
+ *
+ * @pre The radio needs to be in IDLE or Sleep mode.
+ */
+int16_t RADIO_RX_CONTINUOUS( void )
+{
+    RADIO_SPI_WRITE((CC2500_WOREVT1 | CC2500_WRITE_BURST),
+                    (uint8_t*)&RADIO_REG_SETTINGS[CC2500_WOREVT1 - RADIO_REG_BLOCK_START], 3, RADIO_CS_DLY());
+    RADIO_SPI_WRITE((CC2500_MCSM2 | CC2500_WRITE_BURST),
+                    (uint8_t*)&RADIO_REG_SETTINGS[CC2500_MCSM2 - RADIO_REG_BLOCK_START], 2, 0);
+#if(RADIO_USE_CRC && !RADIO_STREAM && !RADIO_USE_ARQ)
+    RADIO_SPI_WRITE((CC2500_IOCFG0 | CC2500_WRITE_SINGLE),
+                    (uint8_t*)&RADIO_REG_SETTINGS[CC2500_IOCFG0 - RADIO_REG_BLOCK_START], 1, 0);
+    BSP_GDO_PIES &= ~BSP_GDO0_BIT;
+    BSP_GDO_PIFG &= ~BSP_GDO0_BIT;
+#endif
+
+    RADIO_rxWor = 0;
+
+    return RADIO_SUCCESS;
+}
+
+/**
+ * Choose the Wake-on-Radio listen interval for a worst-case wake-up latency.
+ * A packet sent at any time is heard within one Event 0 period, provided the
+ * transmitter keeps repeating it for that long.
+ *
+ * @param latencyMs The longest acceptable delay before the receiver hears
+ *			a transmitter, in milliseconds.
+ * @return The Event 0 value for RADIO_RX_WOR.
+ */
+uint16_t RADIO_WOR_EVENT0( uint16_t latencyMs )
+{
+    uint32_t event0;
+
+    // 1 ms = 26000 / (750 * 2^5) = 13/12 Event 0 counts
+    event0 = ((uint32_t)latencyMs * 13) / 12;
+
+    if(!event0)
+        {
+            return 1;
+        }
+
+    return (event0 > 0xFFFF) ? 0xFFFF : (uint16_t)event0;
+}
+
+/**
+ * Choose the shortest Wake-on-Radio RX timeout that still listens long enough
+ * to catch a repeated packet, e.g. two packet airtimes.
+ *
+ * @param event0 The Event 0 value passed to RADIO_RX_WOR.
+ * @param listenUs The minimum time to listen per wake-up, in microseconds.
+ * @return The RX_TIME value for RADIO_RX_WOR, or RADIO_WOR_RX_TIME_NONE if
+ *			even the longest timeout is too short.
+ */
+uint8_t RADIO_WOR_RX_TIME( uint16_t event0, uint16_t listenUs )
+{
+    int8_t rxTime;
+
+    // Timeout is 18.03 us per Event 0 count (1154/64), halved per step
+    for(rxTime = RADIO_WOR_RX_TIME_NONE - 1; rxTime >= 0; rxTime--)
+        {
+            if((((uint32_t)event0 * 1154) >> (6 + rxTime)) >= listenUs)
+                {
+                    return rxTime;
+                }
+        }
+
+    return RADIO_WOR_RX_TIME_NONE;
+}
+
+/**
+  * Takes the oldest packet from the receive queue and copies its payload into
+  * the given user array. Does not wait for a packet to arrive.
   *
-  * @param dest A pointer to the first location of the destination array.
-  * @param nwkID updated to the network ID used by the transmitter.
-  * @param txID updated to the transmitter's device ID.
-  * @return The size of the receive buffer in bytes.
+  * @param dest A pointer to the first location of the destination array,
+  *			which must hold RADIO_PAY_LEN bytes.
+  * @param addr updated to the address the packet was sent to: RADIO_DEV_ID
+  *			or a broadcast address (RADIO_ADDR_BROADCAST without RADIO_USE_ADDR).
+  * @param rssi updated to the received signal strength in dBm, or
+  *			RADIO_RSSI_NONE without RADIO_RX_STATUS.
+  * @param lqi updated to the link quality indicator (0 without RADIO_RX_STATUS).
+  * @return The length of the received payload in bytes, 0 if none.
   *
   * @todo Finish this function
   */
-uint16_t RADIO_RECEIVE( uint8_t* dest, uint8_t* nwkID, uint8_t* txID)
+uint16_t RADIO_RECEIVE( uint8_t* dest, uint8_t* addr, int8_t* rssi, uint8_t* lqi)
 {
     uint16_t i;
+    uint16_t len;
+    RADIO_rx_slot_t* slot;
 
-    // Enter critical so that data buffer won't be overwritten.
+    // Enter critical so that the queue won't be changed by the ISR.
     HAL_ENTER_CRITICAL();
 
     // Check for new data prior to copying buffer.
-    if(!RADIO_rxNewData)
+    if(RADIO_rxHead == RADIO_rxTail)
         {
+            HAL_EXIT_CRITICAL();
             return 0;
         }
 
-    // Copy the received packet from local buffer to user's data buffer.
-    for(i=0; i<RADIO_PAY_LEN; i++)
+    // Copy the received packet from the queue to user's data buffer.
+    slot = &RADIO_rxQueue[RADIO_rxHead];
+    len = slot->len - RADIO_HDR_LEN;
+    for(i=0; i<len; i++)
         {
-            dest[i] = RADIO_rxBuf[i + RADIO_HDR_LEN];
+            dest[i] = slot->data[i + RADIO_HDR_LEN];
         }
 
-    // Mutate nwkID and txID appropriately according to received data.
-    *nwkID = RADIO_rxBuf[0];
-    *txID = RADIO_rxBuf[1];
-
-    // Clear new data flag.
-    RADIO_rxNewData = 0;
-
-    // Exit critical, allowing for buffer to be written to.
+    // Only packets for this network (sync word) and this device or broadcast
+    //	(address check) get this far.
+#if(RADIO_USE_ADDR)
+    *addr = slot->data[0];
+#else
+    *addr = RADIO_ADDR_BROADCAST;
+#endif
+
+    // Status bytes appended by the radio: RSSI in 0.5 dB steps, then LQI
+    //	with CRC_OK in the top bit.
+#if(RADIO_RX_STATUS)
+    *rssi = ((int8_t)slot->data[slot->len] >> 1) - RADIO_RSSI_OFFSET;
+    *lqi = slot->data[slot->len + 1] & 0x7F;
+#else
+    *rssi = RADIO_RSSI_NONE;
+    *lqi = 0;
+#endif
+
+    // Release the slot.
+    RADIO_rxHead = RADIO_RX_NEXT(RADIO_rxHead);
+
+    // Exit critical, allowing for the queue to be written to.
     HAL_EXIT_CRITICAL();
 
     // Return length of payload received
-    return RADIO_PAY_LEN;
+    return len;
+}
+
+/**
+  * Report how many received packets were dropped because the receive queue
+  * was full. Useful for sizing RADIO_RX_QUEUE_LEN.
+  *
+  * @return The number of dropped packets since RADIO_INIT.
+  */
+uint16_t RADIO_RX_OVERFLOWS( void )
+{
+    return RADIO_rxOverflows;
 }
 
 /**
@@ -190,72 +644,427 @@ uint16_t RADIO_RECEIVE( uint8_t* dest, uint8_t* nwkID, uint8_t* txID)
   */
 int16_t RADIO_SET_TX_PWR( uint8_t pwr )
 {
+    // Waking the radio writes the new setting. An awake radio still holds
+    //	the PATABLE, so an unchanged setting needs no write.
+    if(RADIO_ASLEEP())
+        {
+            RADIO_txPwr = pwr;
+            return RADIO_WAKE();
+        }
+    if(pwr == RADIO_txPwr)
+        {
+            return RADIO_SUCCESS;
+        }
+
     // Write new setting to appropriate register in PA TABLE.
-    HAL_SPI_WRITE((CC2500_PATABLE | CC2500_WRITE_SINGLE), &pwr, 1, RADIO_CS_DLY());
+    RADIO_SPI_WRITE((CC2500_PATABLE | CC2500_WRITE_SINGLE), &pwr, 1, 0);
+    RADIO_txPwr = pwr;
 
-    /// @todo Is this the correct state transition logic?
+    return RADIO_SUCCESS;
+}
 
-    // If we've woken up the radio, it will stay in Idle state.
-    if(RADIO_STATE_SLEEP == RADIO_state)
-        RADIO_state = RADIO_STATE_IDLE;
+/**
+  * Set the transmit power to one level of the power ladder. The level is
+  * kept through SLEEP by RADIO_WAKE.
+  *
+  * @param level 0 (-30 dBm) to RADIO_PWR_MAX (+1 dBm)
+  * @return RADIO_FAIL if level is out of range, else RADIO_SUCCESS.
+  */
+int16_t RADIO_SET_TX_LEVEL( uint8_t level )
+{
+    if(level > RADIO_PWR_MAX)
+        {
+            return RADIO_FAIL;
+        }
 
-    return RADIO_SUCCESS;
+    return RADIO_SET_TX_PWR(RADIO_PA_LADDER[level]);
 }
 
 /**
-  * Broadcast the network ID and device ID, followed by the payload itself.
-  * Packet format = {RADIO_NWK_ID, RADIO_DEV_ID, {Static Size Payload}}
-  * Currently only supports statically sized payload.
+  * @param level 0 to RADIO_PWR_MAX
+  * @return Output power of the power ladder level in dBm.
+  */
+int8_t RADIO_TX_LEVEL_DBM( uint8_t level )
+{
+    return RADIO_PA_DBM[(level > RADIO_PWR_MAX) ? RADIO_PWR_MAX : level];
+}
+
+/**
+  * Send the destination address, followed by the payload itself, on this
+  * network's sync word. Packet format = {addr, {Payload}}, preceded by a
+  * length byte if RADIO_VAR_LEN, and without addr unless RADIO_USE_ADDR.
+  * In fixed-length mode, payloads shorter than RADIO_PAY_LEN are padded with
+  * zeros.
+  *
+  * If RADIO_TX_CCA, the radio first listens, and only transmits if the
+  * channel is clear (MCSM1.CCA_MODE). On a busy channel it idles through a
+  * random backoff on the VLO timer and tries again, up to RADIO_CCA_RETRIES
+  * times. Must then not be called from an ISR (uses HAL_LONG_DELAY).
+  *
+  * If RADIO_USE_ARQ, a unicast packet asks its destination for an ACK, and
+  * the radio listens for it right after the packet. Without one within the
+  * profile's RADIO_ARQ_TIMEOUT the packet is sent again after a random backoff, up to
+  * RADIO_ARQ_RETRIES times (see RADIO_TX_RETRIES). Broadcasts are sent once.
   *
   * @pre The radio needs to be in IDLE mode and recently calibrated.
   *
+  * @param addr the destination device address, or RADIO_ADDR_BROADCAST
   * @param msg a pointer to the array containing the payload
-  * @return RADIO_SUCCESS if everything worked properly, RADIO_FAIL if not.
+  * @param len the payload length in bytes, at most RADIO_PAY_LEN
+  * @return RADIO_SUCCESS if everything worked properly (and the packet was
+  *			acknowledged), RADIO_CCA_FAIL if the channel stayed busy,
+  *			RADIO_NO_ACK if no ACK came back, RADIO_FAIL if not (e.g. the TX
+  *			FIFO ran dry).
   *
-  * @note As written, this function may return before the radio completes transmission.
+  * @note Sleeps in LPM3 until the packet has been sent. Must not be called
+  *			from an ISR.
   */
-int16_t RADIO_TX( uint8_t* msg )
+int16_t RADIO_TX( uint8_t addr, uint8_t* msg, uint8_t len )
 {
-    int i;
+#if(RADIO_USE_ARQ)
+    int16_t rc;
+    uint8_t attempt;
+    uint16_t window;
+
+    RADIO_txSeq = (RADIO_txSeq + 1) & RADIO_ARQ_SEQ_BM;
+    RADIO_txDst = addr;
+    RADIO_txRetries = 0;
+    RADIO_acked = 0;
+
+    // Broadcasts are never acknowledged
+    if(RADIO_IS_BROADCAST(addr))
+        {
+            RADIO_txCtl = RADIO_txSeq;
+            rc = RADIO_TX_SEND(addr, msg, len);
+            RADIO_txCtl = 0;
+            return rc;
+        }
+
+    window = RADIO_CCA_BACKOFF_MIN;
+    for(attempt = 0;; attempt++)
+        {
+            RADIO_txCtl = RADIO_ARQ_REQ | RADIO_txSeq;
+            rc = RADIO_TX_SEND(addr, msg, len);
+
+            // A packet which couldn't be sent is not sent again
+            if(RADIO_SUCCESS != rc)
+                {
+                    break;
+                }
+
+            // The GDO ISR has put the radio in RX for the ACK. Sleep until
+            //	it arrives or the timeout expires.
+            HAL_TIMEOUT_START(RADIO_ARQ_TIMEOUTS[RADIO_profile]);
+            HAL_DISABLE_INTERRUPTS();
+            while(RADIO_ackWait && !HAL_TIMEOUT_EXPIRED())
+                {
+                    HAL_SLEEP();
+                    HAL_DISABLE_INTERRUPTS();
+                }
+            RADIO_ackWait = 0;
+            HAL_ENABLE_INTERRUPTS();
+            HAL_TIMEOUT_STOP();
+            RADIO_ARQ_END();
+
+            if(RADIO_acked)
+                {
+                    break;
+                }
+
+            if(RADIO_ARQ_RETRIES == attempt)
+                {
+                    RADIO_txStats.noAcks++;
+                    rc = RADIO_NO_ACK;
+                    break;
+                }
+
+            // The ACK may have collided: back off a random time, the window
+            //	doubling per attempt
+            RADIO_txRetries++;
+            RADIO_txStats.retries++;
+            RADIO_BACKOFF(window, 0);
+            if(window < RADIO_CCA_BACKOFF_MAX)
+                {
+                    window <<= 1;
+                }
+        }
 
-    // Copy header data into txBuf
-    RADIO_txBuf[0] = RADIO_NWK_ID; 	/// @todo Do these assignments during init (once only)
-    RADIO_txBuf[1] = RADIO_DEV_ID;
+    RADIO_txCtl = 0;
 
-    // Copy payload data into txBuf
-    /// @todo Do this without a string copy...
-    for(i = RADIO_HDR_LEN; i < RADIO_PKT_LEN; i++ )
+    return rc;
+#else
+    return RADIO_TX_SEND(addr, msg, len);
+#endif
+}
+
+/**
+  * Send a packet once, sleeping until it has been sent.
+  *
+  * @return As RADIO_TX_START, or RADIO_FAIL if the TX FIFO ran dry.
+  */
+int16_t RADIO_TX_SEND( uint8_t addr, uint8_t* msg, uint8_t len )
+{
+    int16_t rc;
+    uint8_t mhz;
+
+    mhz = RADIO_CLOCK_FAST();
+    rc = RADIO_TX_START(addr, msg, len);
+    RADIO_CLOCK_BACK(mhz);
+    if(RADIO_SUCCESS != rc)
+        {
+            return rc;
+        }
+
+    // Sleep until the GDO ISR reports the end of the packet. Interrupts are
+    //	off between the check and the sleep so that the wakeup can't be missed.
+    HAL_DISABLE_INTERRUPTS();
+    while(RADIO_txBusy)
         {
-            RADIO_txBuf[i] = msg[i-RADIO_HDR_LEN];
+            HAL_SLEEP();
+            HAL_DISABLE_INTERRUPTS();
         }
+    HAL_ENABLE_INTERRUPTS();
+
+    return RADIO_txResult;
+}
+
+/**
+  * Start sending a packet as RADIO_TX does, but return as soon as it is on
+  * the air. The end of the packet is signalled through the GDO2 falling edge
+  * interrupt: RADIO_TX_BUSY clears and the RADIO_SETUP_TX callback is called.
+  * The radio is then back in IDLE.
+  *
+  * Packets longer than the TX FIFO (RADIO_STREAM) are loaded as far as they
+  * fit, and the rest is fed in from the ISR as the FIFO drains.
+  *
+  * @pre The radio needs to be in IDLE mode and recently calibrated.
+  *
+  * @param addr the destination device address, or RADIO_ADDR_BROADCAST
+  * @param msg a pointer to the array containing the payload; may be reused
+  *			on return if the packet fits the TX FIFO, else only once
+  *			RADIO_TX_BUSY clears
+  * @param len the payload length in bytes, at most RADIO_PAY_LEN
+  * @return RADIO_SUCCESS if everything worked properly, RADIO_CCA_FAIL if the
+  *			channel stayed busy, RADIO_FAIL if not.
+  */
+int16_t RADIO_TX_START( uint8_t addr, uint8_t* msg, uint8_t len )
+{
+    uint8_t hdr[4];
+#if(RADIO_STREAM)
+    uint8_t gdo;
+#endif
+#if(RADIO_TX_CCA)
+    uint8_t attempt;
+    uint8_t rssi;
+    uint16_t window;
+#endif
+
+    if(len > RADIO_PAY_LEN)
+        {
+            return RADIO_FAIL;
+        }
+
+    RADIO_txStats.packets++;
+    RADIO_txResult = RADIO_SUCCESS;
+
+    // Gather the packet straight from its sources:
+    //	{[LEN], [ADDR, [SRC, CTL]], PAYLOAD, [PAD]}
+#if(RADIO_VAR_LEN)
+    // Length byte counts the header and payload which follow it
+    hdr[0] = RADIO_HDR_LEN + len;
+#endif
+    hdr[RADIO_LEN_FIELD] = addr;
+#if(RADIO_USE_ARQ)
+    hdr[RADIO_LEN_FIELD + 1] = RADIO_DEV_ID;
+    hdr[RADIO_LEN_FIELD + 2] = RADIO_txCtl;
+#endif
+    RADIO_txSeg[0].ptr = hdr;
+    RADIO_txSeg[0].len = RADIO_LEN_FIELD + RADIO_HDR_LEN;
+    RADIO_txSeg[1].ptr = msg;
+    RADIO_txSeg[1].len = len;
+#if(RADIO_VAR_LEN)
+    RADIO_txSeg[2].ptr = msg;
+    RADIO_txSeg[2].len = 0;
+#else
+    RADIO_txSeg[2].ptr = RADIO_TX_PAD;
+    RADIO_txSeg[2].len = RADIO_PAY_LEN - len;
+#endif
+    RADIO_txLeft = RADIO_txSeg[0].len + RADIO_txSeg[1].len + RADIO_txSeg[2].len;
 
     // Flush TX FIFO buffer
     /// @todo Determine if this is needed
-    HAL_SPI_STROBE(CC2500_SFTX, RADIO_CS_DLY());
+    RADIO_SPI_STROBE(CC2500_SFTX, RADIO_CS_DLY());
+
+    // Load as much of the packet as fits into the radio TX FIFO in one burst.
+    RADIO_TX_FILL(RADIO_FIFO_LEN);
+
+#if(RADIO_TX_CCA)
+    window = RADIO_CCA_BACKOFF_MIN;
+    for(attempt = 0;; attempt++)
+        {
+            // Listen until the RSSI is valid, then request TX. With CCA
+            //	enabled the radio stays in RX if the channel is busy.
+            RADIO_SPI_STROBE(CC2500_SRX, 0);
+            HAL_PRECISE_DELAY(RADIO_CCA_SETTLE);
+            RADIO_SPI_STROBE(CC2500_STX, 0);
+
+            if(CC2500_STATE_RX != (RADIO_SPI_STROBE(CC2500_SNOP, 0) & CC2500_STATUS_STATE_BM))
+                {
+                    break;
+                }
+
+            // Channel busy. The RSSI differs at every node, so stir it into
+            //	the backoff generator.
+            RADIO_txStats.ccaFails++;
+            RADIO_SPI_READ(CC2500_RSSI | CC2500_READ_BURST, &rssi, 1, 0);
+            RADIO_SPI_STROBE(CC2500_SIDLE, 0);
+            RADIO_SPI_STROBE(CC2500_SFRX, 0);
+
+            if(RADIO_CCA_RETRIES == attempt)
+                {
+                    RADIO_txStats.drops++;
+                    return RADIO_CCA_FAIL;
+                }
+
+            // Random backoff, window doubling per attempt
+            RADIO_BACKOFF(window, rssi);
+            if(window < RADIO_CCA_BACKOFF_MAX)
+                {
+                    window <<= 1;
+                }
+        }
+#else
+    RADIO_SPI_STROBE(CC2500_STX, 0);
+#endif
+
+    // Interrupt when GDO2 falls at the end of the packet (IOCFG2 = 0x06).
+    //	It can't have fallen yet: sync hasn't even been sent.
+    RADIO_txBusy = 1;
+    BSP_GDO_PIES |= BSP_GDO2_BIT;
+    BSP_GDO_PIFG &= ~BSP_GDO2_BIT;
+    BSP_GDO_PIE |= BSP_GDO2_BIT;
+
+#if(RADIO_STREAM)
+    // Rest of a packet longer than the FIFO: switch GDO0 to the TX FIFO
+    //	threshold and top the FIFO up from the ISR each time it drains below.
+    //	Preamble and sync alone leave plenty of time for this.
+    if(RADIO_txLeft)
+        {
+            RADIO_txStream = 1;
+            gdo = 0x02;
+            RADIO_SPI_WRITE((CC2500_IOCFG0 | CC2500_WRITE_SINGLE), &gdo, 1, 0);
+            BSP_GDO_PIES |= BSP_GDO0_BIT;
+            BSP_GDO_PIFG &= ~BSP_GDO0_BIT;
+            BSP_GDO_PIE |= BSP_GDO0_BIT;
+        }
+#endif
+
+    return RADIO_SUCCESS;
+}
 
-    /// @todo: Load all data from user buffer into the radio TX FIFO via SPI.
-    //		Use SPI block write for this.
-    HAL_SPI_WRITE((CC2500_TXFIFO | CC2500_WRITE_BURST), RADIO_txBuf, RADIO_PKT_LEN, 0);
+#if(RADIO_TX_CCA || RADIO_USE_ARQ)
+/**
+  * Idle through a random backoff of 1 to window VLO ticks.
+  *
+  * @param window the backoff window, a power of two
+  * @param stir a value differing between nodes (e.g. an RSSI reading) to
+  *			mix into the backoff generator, or 0
+  */
+void RADIO_BACKOFF( uint16_t window, uint8_t stir )
+{
+    uint16_t ticks;
 
-    /// @todo: Go into TX mode and transmit the data!
+    RADIO_txRand ^= stir;
+    RADIO_txRand = (RADIO_txRand >> 1) ^ ((RADIO_txRand & 1) ? 0xB400 : 0);
+    if(!RADIO_txRand)
+        {
+            RADIO_txRand = 1;
+        }
+    ticks = (RADIO_txRand & (window - 1)) + 1;
+    RADIO_txStats.backoffTicks += ticks;
+    HAL_LONG_DELAY(ticks);
+}
+#endif
 
-    HAL_SPI_STROBE(CC2500_STX, 0);
+/**
+  * Check whether a packet started by RADIO_TX_START is still being sent.
+  *
+  * @return Non-zero until the end of the packet.
+  */
+uint8_t RADIO_TX_BUSY( void )
+{
+    return RADIO_txBusy;
+}
 
-    /// @todo Wait for transmission to complete??
-    // Wait for GDO2 to go HI and LO again indicating TX has finished.
-    // Only works when GDO2 IOCFG is set to 0x06.
-    while(BSP_GDO_PIN & BSP_GDO2_BIT);
+/**
+  * Load the next bytes of the packet being sent into the TX FIFO, in one
+  * burst gathered from the RADIO_txSeg buffers.
+  *
+  * @param room the most bytes to load: free space in the TX FIFO
+  */
+void RADIO_TX_FILL( uint8_t room )
+{
+    HAL_SPI_seg_t seg[3];
+    uint8_t i;
+    uint8_t n;
 
-    /// @todo: If CCA is enabled, watch for a CCA failure.
-    //		Do NOT try again on CCA fail.
+    for(i = 0; i < 3; i++)
+        {
+            n = (RADIO_txSeg[i].len < room) ? RADIO_txSeg[i].len : room;
+            seg[i].ptr = RADIO_txSeg[i].ptr;
+            seg[i].len = n;
+            RADIO_txSeg[i].ptr += n;
+            RADIO_txSeg[i].len -= n;
+            RADIO_txLeft -= n;
+            room -= n;
+        }
 
-    // Update local state variable
-    // Assuming radio is configured to IDLE after transmit is complete.
-    RADIO_state = RADIO_STATE_IDLE;
+    RADIO_SPI_WRITE_GATHER((CC2500_TXFIFO | CC2500_WRITE_BURST), seg, 3, 0);
+}
 
-    /// @todo: Go into a low-power mode here until the transmission has completed, IF the user desires it.
+/**
+  * Report how the last RADIO_TX fared under RADIO_USE_ARQ: how many times the
+  * packet had to be sent again, and the signal strength and link quality
+  * its destination received it with, as returned in the ACK.
+  *
+  * @param rssi updated to the packet's RSSI at the destination in dBm, or
+  *			RADIO_RSSI_NONE if it wasn't acknowledged or without
+  *			RADIO_RX_STATUS.
+  * @param lqi updated to the packet's LQI at the destination (0 if unknown).
+  * @return The number of retries, 0 without RADIO_USE_ARQ.
+  */
+uint8_t RADIO_TX_RETRIES( int8_t* rssi, uint8_t* lqi )
+{
+#if(RADIO_USE_ARQ && RADIO_RX_STATUS)
+    if(RADIO_acked)
+        {
+            *rssi = ((int8_t)RADIO_ackStatus[0] >> 1) - RADIO_RSSI_OFFSET;
+            *lqi = RADIO_ackStatus[1] & 0x7F;
+        }
+    else
+#endif
+        {
+            *rssi = RADIO_RSSI_NONE;
+            *lqi = 0;
+        }
 
-    return RADIO_SUCCESS;
+#if(RADIO_USE_ARQ)
+    return RADIO_txRetries;
+#else
+    return 0;
+#endif
+}
+
+/**
+  * Report the transmit counters: packets, busy clear channel assessments,
+  * packets dropped after RADIO_CCA_RETRIES backoffs, ARQ retries and packets
+  * never acknowledged, and total backoff time.
+  *
+  * @param stats updated with the counters since RADIO_INIT.
+  */
+void RADIO_TX_STATS( RADIO_tx_stats_t* stats )
+{
+    *stats = RADIO_txStats;
 }
 
 /**
@@ -269,17 +1078,281 @@ int16_t RADIO_TX( uint8_t* msg )
 int16_t RADIO_CALIBRATE( void )
 {
     // Send command strobe
-    HAL_SPI_STROBE(CC2500_SCAL, RADIO_CS_DLY());
+    RADIO_SPI_STROBE(CC2500_SCAL, RADIO_CS_DLY());
 
     /// @todo Delay for calibration time
     HAL_PRECISE_DELAY(24); // 30.5us*24 > 721 us (calibration time from datasheet).
 
-    // Update local state variable
-    RADIO_state = RADIO_STATE_IDLE;
+    RADIO_calLoaded = RADIO_CAL_NONE;
+
+    return RADIO_SUCCESS;
+}
+
+/**
+ * Bring the frequency synth calibration up to date for the current channel
+ * and temperature. The FSCAL registers survive SLEEP, so nothing is done if
+ * they already hold the results for this channel and temperature bucket.
+ * Results cached from an earlier calibration are written back (a few bytes
+ * of SPI instead of ~720 us of calibration), and only a channel/temperature
+ * pair not in the cache runs RADIO_CALIBRATE and saves its results.
+ *
+ * @param temp ADC10 reading of the internal temperature sensor (BSP_INCH_TEMP)
+ * @return RADIO_SUCCESS if everything worked properly, RADIO_FAIL if not.
+ *
+ * @pre The radio is asleep or idle.
+ */
+int16_t RADIO_CALIBRATE_CACHED( uint16_t temp )
+{
+    RADIO_calBucket = temp / RADIO_CAL_TEMP_STEP;
+
+    if(!RADIO_CAL_VALID(temp))
+        {
+            RADIO_CAL_LOAD(RADIO_calBucket);
+        }
+
+    return RADIO_SUCCESS;
+}
+
+/**
+ * Check whether the synthesizer calibration is good for the current channel
+ * and temperature, e.g. to avoid stopping the receiver for
+ * RADIO_CALIBRATE_CACHED when nothing has changed.
+ *
+ * @param temp ADC10 reading of the internal temperature sensor (BSP_INCH_TEMP)
+ * @return Non-zero if the FSCAL registers hold the results for the current
+ *			channel and temperature bucket.
+ */
+uint8_t RADIO_CAL_VALID( uint16_t temp )
+{
+    return RADIO_CAL_NONE != RADIO_calLoaded
+           && RADIO_calCache[RADIO_calLoaded].chan == RADIO_channel
+           && RADIO_calCache[RADIO_calLoaded].bucket == temp / RADIO_CAL_TEMP_STEP;
+}
+
+/**
+ * Tune the radio to a channel. The calibration cached for the channel at the
+ * temperature of the last RADIO_CALIBRATE_CACHED is written with it, so the
+ * switch costs two short SPI writes (CHANNR, then FSCAL3..1); a channel not
+ * yet cached is calibrated once.
+ *
+ * @param chan the channel number (CHANNR)
+ * @return RADIO_SUCCESS if everything worked properly, RADIO_FAIL if not.
+ *
+ * @pre The radio is asleep or idle.
+ */
+int16_t RADIO_SET_CHANNEL( uint8_t chan )
+{
+    if(chan == RADIO_channel && RADIO_CAL_NONE != RADIO_calLoaded)
+        {
+            return RADIO_SUCCESS;
+        }
+
+    // Also wakes the radio
+    RADIO_SPI_WRITE(CC2500_CHANNR, &chan, 1, RADIO_CS_DLY());
+    RADIO_channel = chan;
+
+    RADIO_CAL_LOAD(RADIO_calBucket);
 
     return RADIO_SUCCESS;
 }
 
+/**
+ * @return The channel number the radio is tuned to.
+ */
+uint8_t RADIO_CHANNEL( void )
+{
+    return RADIO_channel;
+}
+
+/**
+ * Hop to an entry of the network's channel sequence. Every node derives the
+ * same sequence from RADIO_NWK_ID, so nodes which agree on the hop number
+ * (a shared slot counter, say) and on the excluded channels meet on the same
+ * channel. An excluded entry is passed over for the next one in sequence.
+ *
+ * @param hop the hop number; taken modulo RADIO_HOP_CHANNELS
+ * @return RADIO_SUCCESS if everything worked properly, RADIO_FAIL if not.
+ *
+ * @pre The radio is asleep or idle.
+ */
+int16_t RADIO_HOP_TO( uint8_t hop )
+{
+    hop %= RADIO_HOP_CHANNELS;
+    while(RADIO_hopExcluded & (1u << hop))
+        {
+            hop = (hop + 1) % RADIO_HOP_CHANNELS;
+        }
+    RADIO_hopIndex = hop;
+
+    return RADIO_SET_CHANNEL(RADIO_hopSeq[hop]);
+}
+
+/**
+ * Hop to the next channel of the sequence.
+ *
+ * @return As RADIO_HOP_TO.
+ *
+ * @pre The radio is asleep or idle.
+ */
+int16_t RADIO_HOP_NEXT( void )
+{
+    return RADIO_HOP_TO(RADIO_hopIndex + 1);
+}
+
+/**
+ * Take a channel of the hopping sequence out of use, e.g. after finding it
+ * noisy, or put it back. Nodes meant to meet must exclude the same channels.
+ * The last channel in use can't be excluded.
+ *
+ * @param chan the channel number
+ * @param exclude non-zero to skip the channel, zero to use it again
+ * @return RADIO_SUCCESS if the channel is in the sequence and was changed,
+ *			RADIO_FAIL if not.
+ */
+int16_t RADIO_HOP_EXCLUDE( uint8_t chan, uint8_t exclude )
+{
+    uint16_t bit;
+    uint8_t i;
+
+    for(i = 0; i < RADIO_HOP_CHANNELS; i++)
+        {
+            if(RADIO_hopSeq[i] == chan)
+                {
+                    bit = 1u << i;
+                    if(!exclude)
+                        {
+                            RADIO_hopExcluded &= ~bit;
+                        }
+                    else if((RADIO_hopExcluded | bit) == (1u << RADIO_HOP_CHANNELS) - 1)
+                        {
+                            return RADIO_FAIL;
+                        }
+                    else
+                        {
+                            RADIO_hopExcluded |= bit;
+                        }
+                    return RADIO_SUCCESS;
+                }
+        }
+
+    return RADIO_FAIL;
+}
+
+/**
+ * Switch the modem to a profile, trading range against airtime. Only the
+ * registers whose values differ between the current profile and the new one
+ * are written, a burst per run of consecutive registers. Both ends of a link
+ * must switch together.
+ *
+ * @param profile the RADIO_PROFILE_ value
+ * @return RADIO_SUCCESS if everything worked properly, RADIO_FAIL if the
+ *			profile does not exist.
+ *
+ * @pre The radio is asleep or idle.
+ */
+int16_t RADIO_SET_PROFILE( uint8_t profile )
+{
+    const uint8_t* from;
+    const uint8_t* to;
+    uint8_t i;
+    uint8_t n;
+
+    if(profile >= RADIO_PROFILES)
+        {
+            return RADIO_FAIL;
+        }
+
+    from = RADIO_PROFILE_SETTINGS[RADIO_profile];
+    to = RADIO_PROFILE_SETTINGS[profile];
+    for(i = 0; i < RADIO_PROFILE_REG_COUNT; i += n)
+        {
+            // Count the changed registers following on from register i
+            for(n = 0; i + n < RADIO_PROFILE_REG_COUNT && from[i + n] != to[i + n]
+                    && RADIO_PROFILE_REGS[i + n] == RADIO_PROFILE_REGS[i] + n; n++);
+
+            if(n)
+                {
+                    // Also wakes the radio
+                    RADIO_SPI_WRITE(RADIO_PROFILE_REGS[i] | CC2500_WRITE_BURST,
+                                    (uint8_t*)&to[i], n, RADIO_CS_DLY());
+                }
+            else
+                {
+                    n = 1;
+                }
+        }
+    RADIO_profile = profile;
+
+    return RADIO_SUCCESS;
+}
+
+/**
+ * @return The modem profile in use, a RADIO_PROFILE_ value.
+ */
+uint8_t RADIO_PROFILE( void )
+{
+    return RADIO_profile;
+}
+
+/**
+ * Load the calibration for the current channel and a temperature bucket into
+ * the FSCAL registers: from the cache, or else by calibrating and saving the
+ * results, replacing an old entry if the cache is full.
+ */
+void RADIO_CAL_LOAD( uint8_t bucket )
+{
+    RADIO_cal_t* c = RADIO_CAL_FIND(bucket);
+
+    if(c)
+        {
+            // Also wakes the radio
+            RADIO_SPI_WRITE(CC2500_FSCAL3 | CC2500_WRITE_BURST, c->fscal, 3, RADIO_CS_DLY());
+        }
+    else
+        {
+            RADIO_CALIBRATE();
+
+            if(RADIO_calCount < RADIO_CAL_CACHE_LEN)
+                {
+                    c = &RADIO_calCache[RADIO_calCount++];
+                }
+            else
+                {
+                    c = &RADIO_calCache[RADIO_calVictim];
+                    RADIO_calVictim = (RADIO_calVictim + 1) % RADIO_CAL_CACHE_LEN;
+                }
+            c->chan = RADIO_channel;
+            c->bucket = bucket;
+            RADIO_SPI_READ(CC2500_FSCAL3 | CC2500_READ_BURST, c->fscal, 3, 0);
+        }
+
+    RADIO_calLoaded = c - RADIO_calCache;
+}
+
+/**
+ * Look up the cached calibration for the current channel and a temperature
+ * bucket.
+ *
+ * @param bucket ADC10 reading of the internal temperature sensor divided by
+ *			RADIO_CAL_TEMP_STEP
+ * @return The cache entry, or 0 if the pair has not been calibrated.
+ */
+RADIO_cal_t* RADIO_CAL_FIND( uint8_t bucket )
+{
+    uint8_t i;
+
+    for(i = 0; i < RADIO_calCount; i++)
+        {
+            if(RADIO_calCache[i].chan == RADIO_channel
+                    && RADIO_calCache[i].bucket == bucket)
+                {
+                    return &RADIO_calCache[i];
+                }
+        }
+
+    return 0;
+}
+
 /**
  * Place the radio in Sleep state
  *
@@ -289,13 +1362,48 @@ int16_t RADIO_CALIBRATE( void )
  */
 int16_t RADIO_SLEEP( void )
 {
+    if(RADIO_ASLEEP())
+        {
+            return RADIO_SUCCESS;
+        }
+
+    // Transmit sleep strobe. The radio powers down when ~CS goes back high,
+    //	and ~CS must then stay high: a falling edge would wake it again.
+    RADIO_SPI_STROBE(CC2500_SPWD, 0);
+
+    // No transaction can report this: the status would wake the radio
+    RADIO_status = CC2500_STATUS_CHIP_RDYn_BM;
+
+    return RADIO_SUCCESS;
+}
+
+/**
+ * Wake the radio from Sleep state into Idle state with as little SPI traffic
+ * as possible. The ~CS falling edge starts the crystal, and the first
+ * transaction waits for CHIP_RDYn (SO low) instead of a fixed delay. SLEEP
+ * keeps the configuration and calibration (FSCAL) registers but loses the
+ * PATABLE and the test registers: the transaction writes back the PATABLE
+ * setting in use, and the test registers are only written if their settings
+ * differ from the reset values SLEEP leaves.
+ *
+ * Other functions wake a sleeping radio through this on their first access,
+ * so calling it first is optional.
+ *
+ * @return RADIO_SUCCESS if everything worked properly, RADIO_FAIL if not.
+ */
+int16_t RADIO_WAKE( void )
+{
+    if(!RADIO_ASLEEP())
+        {
+            return RADIO_SUCCESS;
+        }
 
-    // Transmit sleep strobe
-    HAL_SPI_STROBE(CC2500_SPWD, RADIO_CS_DLY());
-    //Disable SPI
-    BSP_SPI_POUT 	&=	~BSP_SPI_CS_BIT;
-    // Update local state variables
-    RADIO_state = RADIO_STATE_SLEEP;
+    // The status byte this returns marks the radio awake
+    RADIO_SPI_WRITE((CC2500_PATABLE | CC2500_WRITE_SINGLE), &RADIO_txPwr, 1, 0);
+#if(RADIO_TEST_LOST)
+    RADIO_SPI_WRITE((CC2500_FSTEST | CC2500_WRITE_BURST),
+                    (uint8_t*)&RADIO_REG_SETTINGS[CC2500_FSTEST - RADIO_REG_BLOCK_START], 6, 0);
+#endif
 
     return RADIO_SUCCESS;
 }
@@ -311,48 +1419,783 @@ int16_t RADIO_IDLE( void )
 {
 
     // Transmit idle strobe
-    HAL_SPI_STROBE(CC2500_SIDLE, RADIO_CS_DLY());
-
-    // Update local state variables
-    RADIO_state = RADIO_STATE_IDLE;
+    RADIO_SPI_STROBE(CC2500_SIDLE, RADIO_CS_DLY());
 
     return RADIO_SUCCESS;
 }
 
 /**
- * Interrupt vector for receive interrupt from radio. Performs rxCallback when data received.
+ * @return The chip status byte returned by the last SPI transaction with the
+ *			radio: state and FIFO byte count, CHIP_RDYn alone while asleep.
+ */
+uint8_t RADIO_CHIP_STATUS( void )
+{
+    return RADIO_status;
+}
+
+/**
+ * Keep the chip status byte a transaction returned, and recover from the
+ * FIFO error states it reports. The radio stays in RX FIFO overflow or TX
+ * FIFO underflow until the FIFO is flushed, so whichever transaction first
+ * sees one flushes it here:
+ *
+ * - RX FIFO overflow: the packets in the FIFO are lost. Flush it and listen
+ *	 again, unless the transaction was SIDLE.
+ * - TX FIFO underflow: the packet was cut short. Flush the FIFO, which
+ *	 leaves the radio in IDLE, and fail the packet.
+ *
+ * @param hdr the header byte of the transaction: address or command strobe
+ * @param status the chip status byte it returned
+ * @return status
+ */
+uint8_t RADIO_STATUS_UPDATE( uint8_t hdr, uint8_t status )
+{
+    RADIO_status = status;
+
+    // Reads report the bytes in the RX FIFO, writes the room in the TX FIFO
+    if(hdr & CC2500_READ_SINGLE)
+        {
+            RADIO_rxAvail = status & CC2500_STATUS_FIFO_BYTES_AVAILABLE_BM;
+        }
+    else
+        {
+            RADIO_txFree = status & CC2500_STATUS_FIFO_BYTES_AVAILABLE_BM;
+        }
+
+    // The radio doesn't stay in the state reported for these
+    if(CC2500_SRES == hdr || CC2500_SPWD == hdr)
+        {
+            return status;
+        }
+
+    switch(status & CC2500_STATUS_STATE_BM)
+        {
+        case CC2500_STATE_RX_OVERFLOW:
+            if(CC2500_SFRX == hdr)
+                {
+                    break;
+                }
+            RADIO_status = HAL_SPI_STROBE(CC2500_SFRX, 0);
+            RADIO_rxAvail = 0;
+#if(RADIO_STREAM)
+            RADIO_rxOpen = 0;
+#endif
+            if(CC2500_SIDLE != hdr)
+                {
+                    RADIO_status = HAL_SPI_STROBE(RADIO_rxWor ? CC2500_SWOR : CC2500_SRX, 0);
+                }
+            break;
+
+        case CC2500_STATE_TX_UNDERFLOW:
+            if(CC2500_SFTX == hdr)
+                {
+                    break;
+                }
+            RADIO_status = HAL_SPI_STROBE(CC2500_SFTX, 0);
+            RADIO_txFree = CC2500_STATUS_FIFO_BYTES_AVAILABLE_BM;
+#if(RADIO_STREAM)
+            RADIO_txSeg[0].len = RADIO_txSeg[1].len = RADIO_txSeg[2].len = 0;
+            RADIO_txLeft = 0;
+#endif
+            RADIO_txStats.underflows++;
+            RADIO_txResult = RADIO_FAIL;
+            break;
+        }
+
+    return status;
+}
+
+#if(RADIO_STREAM)
+/**
+ * Move received bytes from the RX FIFO into the free slot at the tail of the
+ * receive queue, starting a packet if none is open. A completed packet which
+ * passes the CRC check is queued.
+ *
+ * @param avail the number of bytes to read. All of them must be in the FIFO,
+ *			and while the packet is still arriving at least one more (the
+ *			radio must not be read empty during reception).
+ * @param end the packet has ended, and avail is everything left in the FIFO.
+ *			A packet which can't be completed from it is dropped.
+ * @return Non-zero once the packet has been closed: queued or dropped. Zero
+ *			while it is still arriving, or if reception had to be restarted.
+ */
+uint8_t RADIO_RX_DRAIN( uint8_t avail, uint8_t end )
+{
+    RADIO_rx_slot_t* slot = &RADIO_rxQueue[RADIO_rxTail];
+    uint16_t need;
+    uint8_t n;
+
+    if(!RADIO_rxOpen)
+        {
+            // Nothing at the end of a packet: the radio dropped it itself
+            //	(CRC_AUTOFLUSH, address or length check)
+            if(!avail)
+                {
+                    return end;
+                }
+
+#if(RADIO_VAR_LEN)
+            // The length byte tells how many bytes of the packet follow it.
+            //	The radio itself drops packets longer than PKTLEN.
+            //	The rest of it is lost if the RX FIFO had overflowed.
+            if(CC2500_STATE_RX_OVERFLOW
+                    == (RADIO_SPI_READ(CC2500_RXFIFO | CC2500_READ_SINGLE, &slot->len, 1, 0)
+                        & CC2500_STATUS_STATE_BM))
+                {
+                    return 0;
+                }
+            avail--;
+
+            if(slot->len < RADIO_HDR_LEN)
+                {
+                    RADIO_SPI_STROBE(CC2500_SIDLE, 0);
+                    RADIO_RX_POLL();
+                    return 0;
+                }
+#else
+            slot->len = RADIO_FIXED_LEN();
+#endif
+            RADIO_rxGot = 0;
+            RADIO_rxOpen = 1;
+        }
+
+    need = slot->len + RADIO_STATUS_LEN - RADIO_rxGot;
+
+    // Packet cut short (flushed for a bad CRC, or RX FIFO overflow): clear
+    //	out whatever is left of it and listen again
+    if(end && avail < need)
+        {
+            RADIO_rxOpen = 0;
+            RADIO_SPI_STROBE(CC2500_SIDLE, 0);
+            RADIO_RX_POLL();
+            return 0;
+        }
+
+    n = (avail < need) ? avail : (uint8_t)need;
+    RADIO_SPI_READ(CC2500_RXFIFO | CC2500_READ_BURST, &slot->data[RADIO_rxGot], n, 0);
+    RADIO_rxGot += n;
+
+    if(n < need)
+        {
+            return 0;
+        }
+
+    RADIO_rxOpen = 0;
+
+#if(RADIO_USE_CRC && !RADIO_CRC_AUTOFLUSH)
+    // Drop the packet unless CRC_OK, the top bit of the LQI status byte
+#if(RADIO_RX_STATUS)
+    n = slot->data[slot->len + 1];
+#else
+    RADIO_SPI_READ(CC2500_PKTSTATUS | CC2500_READ_BURST, &n, 1, 0);
+#endif
+    if(!(n & 0x80))
+        {
+            return 1;
+        }
+#endif
+
+#if(RADIO_USE_ARQ)
+    // ACKs and resent duplicates are not queued
+    if(!RADIO_ARQ_RX(slot))
+        {
+            return 1;
+        }
+#endif
+
+    // Queue the packet, or drop it if the queue is full
+    if(RADIO_RX_NEXT(RADIO_rxTail) == RADIO_rxHead)
+        {
+            RADIO_rxOverflows++;
+        }
+    else
+        {
+            RADIO_rxTail = RADIO_RX_NEXT(RADIO_rxTail);
+        }
+
+    return 1;
+}
+#endif
+
+#if(RADIO_USE_ARQ)
+/**
+ * Handle the ARQ header of a received packet, from the GDO ISR. An ACK for
+ * the packet being sent ends RADIO_TX's wait. A unicast packet asking for an
+ * ACK gets one prepared in RADIO_ackFrame, unless the receive queue is full
+ * (the sender will then try again).
+ *
+ * @param slot the received packet, with its status bytes
+ * @return Non-zero if the packet is to be queued; zero for ACKs, for
+ *			packets received already (resent because their ACK was lost), and
+ *			for anything arriving while an ACK is awaited.
+ */
+uint8_t RADIO_ARQ_RX( RADIO_rx_slot_t* slot )
+{
+    RADIO_arq_peer_t* peer;
+    uint8_t src = slot->data[1];
+    uint8_t ctl = slot->data[2];
+    uint8_t i;
+
+    if(ctl & RADIO_ARQ_ACK)
+        {
+            if(RADIO_ackWait && RADIO_txDst == src
+                    && RADIO_txSeq == (ctl & RADIO_ARQ_SEQ_BM))
+                {
+#if(RADIO_RX_STATUS)
+                    RADIO_ackStatus[0] = slot->data[RADIO_HDR_LEN];
+                    RADIO_ackStatus[1] = slot->data[RADIO_HDR_LEN + 1];
+#endif
+                    RADIO_acked = 1;
+                    RADIO_ackWait = 0;
+                }
+            return 0;
+        }
+
+    if(RADIO_ackWait)
+        {
+            return 0;
+        }
+
+    if(!(ctl & RADIO_ARQ_REQ) || RADIO_DEV_ID != slot->data[0]
+            || RADIO_RX_NEXT(RADIO_rxTail) == RADIO_rxHead)
+        {
+            return 1;
+        }
+
+    // ACK: {[LEN], DST, SRC, CTL, [RSSI, LQI]}, returning the packet's own
+    //	status bytes to the sender
+#if(RADIO_VAR_LEN)
+    RADIO_ackFrame[0] = RADIO_ACK_LEN;
+#endif
+    RADIO_ackFrame[RADIO_LEN_FIELD] = src;
+    RADIO_ackFrame[RADIO_LEN_FIELD + 1] = RADIO_DEV_ID;
+    RADIO_ackFrame[RADIO_LEN_FIELD + 2] = RADIO_ARQ_ACK | (ctl & RADIO_ARQ_SEQ_BM);
+#if(RADIO_RX_STATUS)
+    RADIO_ackFrame[RADIO_LEN_FIELD + RADIO_HDR_LEN] = slot->data[slot->len];
+    RADIO_ackFrame[RADIO_LEN_FIELD + RADIO_HDR_LEN + 1] = slot->data[slot->len + 1];
+#endif
+    RADIO_ackPending = 1;
+
+    // A packet resent because its ACK was lost carries the same sequence
+    //	number: acknowledge it again, but only queue it once
+    ctl &= RADIO_ARQ_SEQ_BM;
+    for(i = 0; i < RADIO_ARQ_PEERS; i++)
+        {
+            if(RADIO_arqPeers[i].addr == src)
+                {
+                    break;
+                }
+        }
+
+    if(RADIO_ARQ_PEERS == i)
+        {
+            peer = &RADIO_arqPeers[RADIO_arqVictim];
+            RADIO_arqVictim = (RADIO_arqVictim + 1) % RADIO_ARQ_PEERS;
+            peer->addr = src;
+        }
+    else if(RADIO_arqPeers[i].seq == ctl)
+        {
+            return 0;
+        }
+    else
+        {
+            peer = &RADIO_arqPeers[i];
+        }
+    peer->seq = ctl;
+
+    return 1;
+}
+
+/**
+ * Send the ACK prepared by RADIO_ARQ_RX, from the GDO ISR at the end of the
+ * received packet. The radio waits in FSTXON (MCSM1.RXOFF_MODE), or in IDLE
+ * under WOR, so the ACK starts within microseconds. Its end is signalled
+ * like that of a received packet, and handled by RADIO_ARQ_ACK_SENT.
+ */
+void RADIO_ARQ_SEND_ACK( void )
+{
+#if(!RADIO_VAR_LEN)
+    uint8_t len = RADIO_ACK_LEN;
+
+    RADIO_SPI_WRITE((CC2500_PKTLEN | CC2500_WRITE_SINGLE), &len, 1, 0);
+#endif
+    RADIO_SPI_WRITE((CC2500_TXFIFO | CC2500_WRITE_BURST), RADIO_ackFrame, sizeof(RADIO_ackFrame), 0);
+    RADIO_SPI_STROBE(CC2500_STX, 0);
+
+    RADIO_ackPending = 0;
+    RADIO_ackBusy = 1;
+}
+
+/**
+ * The ACK has been sent, and the radio is back in RX (MCSM1.TXOFF_MODE).
+ */
+void RADIO_ARQ_ACK_SENT( void )
+{
+#if(!RADIO_VAR_LEN)
+    RADIO_SPI_WRITE((CC2500_PKTLEN | CC2500_WRITE_SINGLE),
+                    (uint8_t*)&RADIO_REG_SETTINGS[CC2500_PKTLEN - RADIO_REG_BLOCK_START], 1, 0);
+#endif
+
+    // Under WOR, polling is resumed from IDLE
+    if(RADIO_rxWor)
+        {
+            RADIO_SPI_STROBE(CC2500_SIDLE, 0);
+        }
+
+    RADIO_ackBusy = 0;
+}
+
+/**
+ * A packet has been sent, from the GDO ISR. If it asked for an ACK, keep
+ * listening (the radio went to RX by MCSM1.TXOFF_MODE), else go to IDLE.
+ * The streaming ISR then keeps its receive interrupts on itself.
+ */
+void RADIO_ARQ_TX_DONE( void )
+{
+#if(!RADIO_VAR_LEN)
+    uint8_t len = RADIO_ACK_LEN;
+#endif
+
+    if(RADIO_SUCCESS != RADIO_txResult || !(RADIO_txCtl & RADIO_ARQ_REQ))
+        {
+            RADIO_SPI_STROBE(CC2500_SIDLE, 0);
+            return;
+        }
+
+#if(!RADIO_VAR_LEN)
+    RADIO_SPI_WRITE((CC2500_PKTLEN | CC2500_WRITE_SINGLE), &len, 1, 0);
+#endif
+    RADIO_ackWait = 1;
+
+    // Rising edge of the RX FIFO threshold (RADIO_STREAM), or falling edge
+    //	of Sync at the end of the ACK
+#if(RADIO_STREAM)
+    BSP_GDO_PIES &= ~BSP_GDO0_BIT;
+    BSP_GDO_PIFG &= ~BSP_GDO0_BIT;
+#else
+    BSP_GDO_PIES |= BSP_GDO0_BIT;
+    BSP_GDO_PIFG &= ~BSP_GDO0_BIT;
+    BSP_GDO_PIE |= BSP_GDO0_BIT;
+#endif
+}
+
+/**
+ * Stop listening for an ACK: return the radio to IDLE, discarding anything
+ * half received, and leave the receive interrupts on only if RADIO_SETUP_RX
+ * was called.
+ */
+void RADIO_ARQ_END( void )
+{
+    uint8_t ie = BSP_GDO_PIE & (BSP_GDO0_BIT | BSP_GDO2_BIT);
+
+    BSP_GDO_PIE &= ~(BSP_GDO0_BIT | BSP_GDO2_BIT);
+
+    RADIO_SPI_STROBE(CC2500_SIDLE, 0);
+#if(!RADIO_VAR_LEN)
+    RADIO_SPI_WRITE((CC2500_PKTLEN | CC2500_WRITE_SINGLE),
+                    (uint8_t*)&RADIO_REG_SETTINGS[CC2500_PKTLEN - RADIO_REG_BLOCK_START], 1, 0);
+#endif
+    RADIO_SPI_STROBE(CC2500_SFRX, 0);
+#if(RADIO_STREAM)
+    RADIO_rxOpen = 0;
+#endif
+
+    BSP_GDO_PIFG &= ~(BSP_GDO0_BIT | BSP_GDO2_BIT);
+    if(RADIO_rxCallback)
+        {
+            BSP_GDO_PIE |= ie;
+        }
+}
+#endif
+
+#if(RADIO_STREAM)
+/**
+ * Interrupt vector for the radio GDO lines, streaming packets through the
+ * FIFOs. GDO0 is the RX FIFO threshold: its rising edge drains the FIFO
+ * while a packet arrives. During a transmission too long for the TX FIFO it
+ * is switched to the TX FIFO threshold, whose falling edge refills the FIFO.
+ * The GDO2 falling edge ends the packet: a transmission, or a reception
+ * whose remaining bytes are then read. rxCallback is performed for every
+ * received packet; with RADIO_USE_ARQ, after the ACK has been sent.
+ *
+ * @todo It's not good if this ISR executes while other routines are talking to the radio.
+ */
+#pragma vector=BSP_GDO_VECTOR
+__interrupt void RADIO_GDO_ISR ( void )
+{
+    uint8_t ie = BSP_GDO_PIE & (BSP_GDO0_BIT | BSP_GDO2_BIT);
+    uint8_t flags = BSP_GDO_PIFG & ie;
+    uint8_t txDone = 0;
+    uint8_t rxDone = 0;
+    uint8_t avail;
+    uint8_t mhz;
+#if(RADIO_USE_ARQ)
+    uint8_t ackWait = RADIO_ackWait;
+#endif
+
+    // Disable port interrupts to avoid nested interrupting (the SPI functions
+    //	enable global interrupts)
+    BSP_GDO_PIE &= ~(BSP_GDO0_BIT | BSP_GDO2_BIT);
+    BSP_GDO_PIFG &= ~flags;
+
+    mhz = RADIO_CLOCK_FAST();
+
+    if(flags & BSP_GDO0_BIT)
+        {
+            if(RADIO_txStream)
+                {
+                    // TX FIFO drained below the threshold: top it up
+                    RADIO_TX_FILL(RADIO_FIFO_LEN - RADIO_TX_THR + 1);
+
+                    if(!RADIO_txLeft)
+                        {
+                            ie &= ~BSP_GDO0_BIT;
+                        }
+                    else if(!(BSP_GDO_PIN & BSP_GDO0_BIT))
+                        {
+                            // Still below the threshold, so no new edge
+                            BSP_GDO_PIFG |= BSP_GDO0_BIT;
+                        }
+                }
+            else if(BSP_GDO_PIN & BSP_GDO0_BIT)
+                {
+                    // RX FIFO holds at least the threshold: read all but one
+                    rxDone = RADIO_RX_DRAIN(RADIO_RX_THR - 1, 0);
+                }
+        }
+
+    if((flags & BSP_GDO2_BIT) && RADIO_txBusy)
+        {
+            // End of a transmitted packet, or the TX FIFO ran dry: the
+            //	status byte of any transaction reports the underflow, and
+            //	RADIO_STATUS_UPDATE recovers from it.
+            if(RADIO_txLeft)
+                {
+                    RADIO_SPI_STROBE(CC2500_SNOP, 0);
+                }
+
+            // Return GDO0 to the RX FIFO threshold
+            if(RADIO_txStream)
+                {
+                    RADIO_txStream = 0;
+                    RADIO_SPI_WRITE((CC2500_IOCFG0 | CC2500_WRITE_SINGLE),
+                                    (uint8_t*)&RADIO_REG_SETTINGS[CC2500_IOCFG0 - RADIO_REG_BLOCK_START], 1, 0);
+                    BSP_GDO_PIES &= ~BSP_GDO0_BIT;
+                    BSP_GDO_PIFG &= ~BSP_GDO0_BIT;
+                    ie &= ~BSP_GDO0_BIT;
+                }
+
+#if(RADIO_USE_ARQ)
+            RADIO_ARQ_TX_DONE();
+#endif
+
+            // GDO0 and GDO2 stay enabled only for reception (or an ACK)
+#if(RADIO_USE_ARQ)
+            if(RADIO_rxCallback || RADIO_ackWait)
+#else
+            if(RADIO_rxCallback)
+#endif
+                {
+                    ie |= BSP_GDO0_BIT;
+                }
+            else
+                {
+                    ie &= ~BSP_GDO2_BIT;
+                }
+
+            RADIO_txBusy = 0;
+            txDone = 1;
+        }
+#if(RADIO_USE_ARQ)
+    else if((flags & BSP_GDO2_BIT) && RADIO_ackBusy)
+        {
+            // End of the ACK for a received packet: hand the packet over now
+            RADIO_ARQ_ACK_SENT();
+            rxDone = 1;
+        }
+#endif
+    else if(flags & BSP_GDO2_BIT)
+        {
+            // End of a received packet: read the rest of it. Nothing else
+            //	is written to the RX FIFO until the next sync word.
+            //	On RX FIFO overflow, the status byte of this read has already
+            //	had the FIFO flushed and reception restarted.
+            RADIO_SPI_READ(CC2500_RXBYTES | CC2500_READ_BURST, &avail, 1, 0);
+            if(!(avail & 0x80))
+                {
+                    rxDone |= RADIO_RX_DRAIN(avail, 1);
+                }
+        }
+
+#if(RADIO_USE_ARQ)
+    // Acknowledge a received packet straight away. rxCallback follows at
+    //	the end of the ACK, so that it can't cut the ACK short.
+    if(rxDone && RADIO_ackPending)
+        {
+            RADIO_ARQ_SEND_ACK();
+            rxDone = 0;
+        }
+#endif
+
+    if(rxDone)
+        {
+            // The radio went to IDLE at the end of the packet; resume WOR polling
+            if(RADIO_rxWor)
+                {
+                    RADIO_SPI_STROBE(CC2500_SWOR, 0);
+                }
+#if(RADIO_USE_ARQ)
+            // With ARQ it waits in FSTXON instead; resume RX
+            else
+                {
+                    RADIO_SPI_STROBE(CC2500_SRX, 0);
+                }
+
+            if(RADIO_rxCallback)
+#endif
+                {
+                    // Enable interrupts to avoid confusion in rxCallback()
+                    HAL_ENABLE_INTERRUPTS();
+
+                    // Call the user's callback function in an ISR context.
+                    RADIO_rxCallback();
+
+                    // Turn off global interrupts for remainder of ISR to avoid nesting
+                    HAL_DISABLE_INTERRUPTS();
+                }
+        }
+
+#if(RADIO_USE_ARQ)
+    // The awaited ACK arrived: wake RADIO_TX
+    if(ackWait && !RADIO_ackWait)
+        {
+            HAL_LPM3_WAKEUP();
+        }
+#endif
+
+    if(txDone)
+        {
+            // Wake RADIO_TX and tell the user
+            if(RADIO_txCallback)
+                {
+                    RADIO_txCallback();
+                }
+
+            HAL_LPM3_WAKEUP();
+        }
+
+    // Re-enable the GDO interrupts
+    BSP_GDO_PIE |= ie;
+
+    // The RX FIFO threshold is a level. If the FIFO filled past it again
+    //	while it was being read, there was no new edge.
+    if(!RADIO_txStream && (ie & BSP_GDO0_BIT) && (BSP_GDO_PIN & BSP_GDO0_BIT))
+        {
+            BSP_GDO_PIFG |= BSP_GDO0_BIT;
+        }
+
+    RADIO_CLOCK_BACK(mhz);
+}
+#else
+/**
+ * Interrupt vector for the radio GDO lines. Ends a transmission on the GDO2
+ * falling edge, and performs rxCallback when a packet received on GDO0 is
+ * queued.
+ * With RADIO_USE_CRC the radio flushes packets which fail CRC itself, and
+ * only interrupts for good ones (except under WOR, see RADIO_RX_WOR).
+ * With RADIO_USE_ARQ GDO0 interrupts at the end of every packet, and also
+ * ends the ACKs sent, after which rxCallback is performed.
  *
- * @todo Don't allow through any packets which fail CRC!!
  * @todo It's not good if this ISR executes while other routines are talking to the radio.
 
  */
 #pragma vector=BSP_GDO_VECTOR
 __interrupt void RADIO_GDO_ISR ( void )
 {
+    RADIO_rx_slot_t* slot = &RADIO_rxQueue[RADIO_rxTail];
+    uint8_t mhz;
+    uint8_t queued = 0;
+#if(RADIO_USE_ARQ)
+    uint8_t ackWait = RADIO_ackWait;
+#endif
+
+    // End of a transmitted packet: wake RADIO_TX and tell the user
+    if(BSP_GDO_PIFG & BSP_GDO_PIE & BSP_GDO2_BIT)
+        {
+            BSP_GDO_PIE &= ~BSP_GDO2_BIT;
+            BSP_GDO_PIFG &= ~BSP_GDO2_BIT;
+            RADIO_txBusy = 0;
+
+#if(RADIO_USE_ARQ)
+            // GDO0 follows the same Sync signal, but nothing was received
+            BSP_GDO_PIFG &= ~BSP_GDO0_BIT;
+            RADIO_ARQ_TX_DONE();
+#endif
+
+            if(RADIO_txCallback)
+                {
+                    RADIO_txCallback();
+                }
+
+            HAL_LPM3_WAKEUP();
+        }
+
+    if(!(BSP_GDO_PIFG & BSP_GDO_PIE & BSP_GDO0_BIT))
+        {
+            return;
+        }
+
 	// Disable port interrupt to avoid nested interrupting
     BSP_GDO_PIE &= ~BSP_GDO0_BIT;
 
-    // Copy the receive FIFO contents into the local rx Buffer
-    HAL_SPI_READ(CC2500_RXFIFO | CC2500_READ_BURST, RADIO_rxBuf, RADIO_PKT_LEN, RADIO_CS_DLY());
+    mhz = RADIO_CLOCK_FAST();
+    slot->len = 0;
 
-    // Signal that new data is present
-    RADIO_rxNewData = 1;
-
-    // Enable interrupts to avoid confusion in rxCallback()
-    HAL_ENABLE_INTERRUPTS();
+#if(RADIO_USE_ARQ)
+    // End of an ACK sent for a received packet: nothing to read, hand over
+    //	what was queued
+    if(RADIO_ackBusy)
+        {
+            RADIO_ARQ_ACK_SENT();
+            queued = (RADIO_rxHead != RADIO_rxTail);
+        }
+    else
+#endif
+#if(RADIO_USE_CRC || RADIO_USE_ARQ)
+        // Only read a packet which is still there. CRC OK drops if the FIFO
+        //	was flushed since the edge. Under WOR or ARQ every packet
+        //	interrupts, and one which failed CRC has already been flushed:
+        //	check the RX FIFO instead.
+        if((RADIO_rxWor || RADIO_USE_ARQ)
+                ? (RADIO_SPI_STROBE(CC2500_SNOP | CC2500_READ_SINGLE, RADIO_CS_DLY()), RADIO_rxAvail)
+                : (BSP_GDO_PIN & BSP_GDO0_BIT))
+#endif
+            {
+#if(RADIO_VAR_LEN)
+                // The length byte tells how many bytes of the packet follow it.
+                //	The radio itself drops packets longer than PKTLEN.
+                RADIO_SPI_READ(CC2500_RXFIFO | CC2500_READ_SINGLE, &slot->len, 1, RADIO_CS_DLY());
+
+                // Too short for a header: the rest of the FIFO can't be
+                //	parsed. Flush it and listen again (WOR polling is
+                //	resumed below).
+                if(slot->len < RADIO_HDR_LEN)
+                    {
+                        RADIO_SPI_STROBE(CC2500_SIDLE, 0);
+                        RADIO_SPI_STROBE(CC2500_SFRX, 0);
+                        if(!RADIO_rxWor)
+                            {
+                                RADIO_SPI_STROBE(CC2500_SRX, 0);
+                            }
+                        slot->len = 0;
+                    }
+#else
+                slot->len = RADIO_FIXED_LEN();
+#endif
+            }
+
+    if((slot->len >= RADIO_HDR_LEN) && (slot->len <= RADIO_PKT_LEN))
+        {
+            // Copy the receive FIFO contents, and any status bytes, into the free slot
+            RADIO_SPI_READ(CC2500_RXFIFO | CC2500_READ_BURST, slot->data, slot->len + RADIO_STATUS_LEN, RADIO_CS_DLY());
+
+            // Queue the packet, or drop it if the queue is full. ACKs and
+            //	resent duplicates are not queued.
+#if(RADIO_USE_ARQ)
+            if(RADIO_ARQ_RX(slot))
+#endif
+                {
+                    if(RADIO_RX_NEXT(RADIO_rxTail) == RADIO_rxHead)
+                        {
+                            RADIO_rxOverflows++;
+                        }
+                    else
+                        {
+                            RADIO_rxTail = RADIO_RX_NEXT(RADIO_rxTail);
+                            queued = 1;
+                        }
+                }
+        }
 
-    // Call the user's callback function in an ISR context.
-    RADIO_rxCallback();
+#if(RADIO_USE_ARQ)
+    // Acknowledge a received packet straight away. rxCallback follows at
+    //	the end of the ACK, so that it can't cut the ACK short.
+    if(RADIO_ackPending)
+        {
+            RADIO_ARQ_SEND_ACK();
+        }
+    else
+#endif
+        {
+            // The radio went to IDLE at the end of the packet; resume WOR polling
+            if(RADIO_rxWor)
+                {
+                    RADIO_SPI_STROBE(CC2500_SWOR, 0);
+                }
+#if(RADIO_USE_ARQ)
+            // With ARQ it waits in FSTXON instead; resume RX
+            else
+                {
+                    RADIO_SPI_STROBE(CC2500_SRX, 0);
+                }
+#endif
+
+            // Only a packet which was queued is handed over
+#if(RADIO_USE_ARQ)
+            if(queued && RADIO_rxCallback)
+#else
+            if(queued)
+#endif
+                {
+                    // Enable interrupts to avoid confusion in rxCallback()
+                    HAL_ENABLE_INTERRUPTS();
+
+                    // Call the user's callback function in an ISR context.
+                    RADIO_rxCallback();
+
+                    // Turn off global interrupts for remainder of ISR to avoid nesting
+                    HAL_DISABLE_INTERRUPTS();
+                }
+        }
 
-    // Turn off global interrupts for remainder of ISR to avoid nesting
+#if(RADIO_USE_ARQ)
+    // The SPI functions enabled global interrupts, and the GDO0 flag of
+    //	this packet is still set
     HAL_DISABLE_INTERRUPTS();
+#endif
 
-    // Re-enable receive interrupt
-    BSP_GDO_PIE |= BSP_GDO0_BIT;
+    // Re-enable receive interrupt (with ARQ, if still receiving)
+#if(RADIO_USE_ARQ)
+    if(RADIO_rxCallback || RADIO_ackWait || RADIO_ackBusy)
+#endif
+        {
+            BSP_GDO_PIE |= BSP_GDO0_BIT;
+        }
 
     // Clear IFG
-    P2IFG = 0x00;
+    BSP_GDO_PIFG &= ~BSP_GDO0_BIT;
+
+#if(RADIO_USE_ARQ)
+    // The awaited ACK arrived: wake RADIO_TX
+    if(ackWait && !RADIO_ackWait)
+        {
+            HAL_LPM3_WAKEUP();
+        }
+#endif
+
+#if(RADIO_USE_CRC && !RADIO_USE_ARQ)
+    // CRC OK is a level held until the RX FIFO is read. If another packet
+    //	completed while the interrupt was off, its edge was lost: raise the
+    //	flag again so that it is drained.
+    if(!RADIO_rxWor && (BSP_GDO_PIN & BSP_GDO0_BIT))
+        {
+            BSP_GDO_PIFG |= BSP_GDO0_BIT;
+        }
+#endif
     // The radio is assumed to be configured to remain in RX state after receive.
+
+    RADIO_CLOCK_BACK(mhz);
 }
+#endif
 
 ///////////////////////////////////////////////////////////////////////////////
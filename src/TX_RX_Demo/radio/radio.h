@@ -21,15 +21,62 @@
 /// Packet sizing information
 ///////////////////////////////////////////////////////////////////////////////
 
-// Radio packet header length
-#define RADIO_HDR_LEN	2
+// Transmitted/received packet size in bytes {HDR, PAYLOAD}, not counting
+//	the length byte. Maximum packet size in variable-length mode.
+#define RADIO_PKT_LEN	(RADIO_HDR_LEN + RADIO_PAY_LEN)
 
-// Transmitted/received packet size in bytes {HDR, PAYLOAD}
-#define RADIO_PKT_LEN	RADIO_HDR_LEN + RADIO_PAY_LEN
+// Size of each of the radio's TX and RX FIFOs in bytes
+#define RADIO_FIFO_LEN	64
 
-// Number of low-power timer cycles for radio to wake from sleep mode after
-//	CS line pulled low.
-#define	RADIO_CS_DLY_TIME	5
+// FIFO thresholds set by FIFOTHR: GDO0 signals the RX FIFO filling to
+//	RADIO_RX_THR bytes, and the TX FIFO draining below RADIO_TX_THR bytes.
+#define RADIO_RX_THR	(4 * ((SMARTRF_SETTING_FIFOTHR & 0x0F) + 1))
+#define RADIO_TX_THR	(61 - 4 * (SMARTRF_SETTING_FIFOTHR & 0x0F))
+
+// Destination address accepted by every device. The radio also accepts 0xFF.
+#define RADIO_ADDR_BROADCAST	0x00
+
+// RSSI offset of the CC2500 at 250 kBaud (dB), and the RSSI reported by
+//	RADIO_RECEIVE when status bytes are not appended
+#define RADIO_RSSI_OFFSET	72
+#define RADIO_RSSI_NONE		(-128)
+
+// Number of low-power timer cycles from SRX until the RSSI, and so the clear
+//	channel assessment, is valid: RX settling (~90 us) plus RSSI response.
+#define RADIO_CCA_SETTLE	5
+
+///////////////////////////////////////////////////////////////////////////////
+/// Transmit power ladder
+///////////////////////////////////////////////////////////////////////////////
+
+// Levels of RADIO_SET_TX_LEVEL: the CC2500's optimum PATABLE settings from
+//	-30 dBm (level 0) up to +1 dBm (RADIO_PWR_MAX), in steps of about 2 dB.
+#define RADIO_PWR_LEVELS	17
+#define RADIO_PWR_MAX		(RADIO_PWR_LEVELS - 1)
+
+///////////////////////////////////////////////////////////////////////////////
+/// Wake-on-Radio settings
+///////////////////////////////////////////////////////////////////////////////
+
+// WORCTRL: RC oscillator on with calibration, Event 1 eight RC periods
+//	(231 us) ahead of Event 0 to start the crystal, WOR_RES = 1. One Event 0
+//	count is then 750 * 2^5 / 26 MHz = 923 us, up to 60 s.
+#define RADIO_WORCTRL		0x29
+
+// RX_TIME value for no RX timeout (listen until a packet arrives)
+#define RADIO_WOR_RX_TIME_NONE	7
+
+///////////////////////////////////////////////////////////////////////////////
+/// Radio profiles
+///////////////////////////////////////////////////////////////////////////////
+
+// Modem settings of RADIO_SET_PROFILE, from longest range to shortest airtime.
+//	RADIO_INIT selects RADIO_PROFILE_250K, the SmartRF settings. The 10 kBaud
+//	and 250 kBaud profiles use FEC as RADIO_USE_FEC; 500 kBaud never does.
+#define RADIO_PROFILE_10K	0	// 10 kBaud 2-FSK, about 12 dB more sensitive than 250K
+#define RADIO_PROFILE_250K	1	// 250 kBaud MSK
+#define RADIO_PROFILE_500K	2	// 500 kBaud MSK, about 6 dB less sensitive than 250K
+#define RADIO_PROFILES		3
 
 ///////////////////////////////////////////////////////////////////////////////
 /// Return status definitions
@@ -37,6 +84,7 @@
 #define RADIO_SUCCESS 	0	// Successful completion of function
 #define RADIO_FAIL		1	// Non-specific failure occurred
 #define RADIO_CCA_FAIL 	2	// Clear channel assessment failed
+#define RADIO_NO_ACK	3	// Packet not acknowledged after RADIO_ARQ_RETRIES
 
 ///////////////////////////////////////////////////////////////////////////////
 /// Includes
@@ -46,6 +94,106 @@
 #include "../hal/bsp.h"		// Board-specific functions
 #include <stdint.h>			// Data type definitions
 
+// The CC2500 supports FEC only in fixed packet length mode.
+#if(RADIO_VAR_LEN && RADIO_USE_FEC)
+#error "RADIO_VAR_LEN can't be combined with RADIO_USE_FEC"
+#endif
+
+// Radio packet header length: the destination address, if any, then with
+//	RADIO_USE_ARQ the source address and the ARQ control byte
+#if(RADIO_USE_ARQ && !RADIO_USE_ADDR)
+#error "RADIO_USE_ARQ needs RADIO_USE_ADDR"
+#endif
+#if(RADIO_USE_ARQ)
+#define RADIO_HDR_LEN	3
+#elif(RADIO_USE_ADDR)
+#define RADIO_HDR_LEN	1
+#else
+#define RADIO_HDR_LEN	0
+#endif
+
+// Length byte preceding the header in variable-length mode
+#if(RADIO_VAR_LEN)
+#define RADIO_LEN_FIELD	1
+#else
+#define RADIO_LEN_FIELD	0
+#endif
+
+// RSSI and LQI/CRC_OK bytes appended to received packets
+#if(RADIO_RX_STATUS)
+#define RADIO_STATUS_LEN	2
+#else
+#define RADIO_STATUS_LEN	0
+#endif
+
+// Bytes a received packet occupies in the RX FIFO
+#define RADIO_RX_FRAME_LEN	(RADIO_LEN_FIELD + RADIO_PKT_LEN + RADIO_STATUS_LEN)
+
+#if(RADIO_PKT_LEN > 255)
+#error "RADIO_PAY_LEN is too long for the radio's packet handler"
+#endif
+#if(!RADIO_STREAM && RADIO_RX_FRAME_LEN > RADIO_FIFO_LEN)
+#error "Packets longer than the radio FIFO need RADIO_STREAM"
+#endif
+
+// The radio can only flush packets failing CRC itself when a whole packet
+//	fits in the RX FIFO; otherwise the MCU checks CRC_OK.
+#define RADIO_CRC_AUTOFLUSH	(RADIO_USE_CRC && RADIO_RX_FRAME_LEN <= RADIO_FIFO_LEN)
+
+// Destination addresses which are never acknowledged
+#define RADIO_IS_BROADCAST(addr)	(RADIO_ADDR_BROADCAST == (addr) || 0xFF == (addr))
+
+///////////////////////////////////////////////////////////////////////////////
+/// Acknowledgements (RADIO_USE_ARQ)
+///////////////////////////////////////////////////////////////////////////////
+
+// ARQ control byte: {ACK, ACK requested, sequence number [5:0]}
+#define RADIO_ARQ_ACK		0x80
+#define RADIO_ARQ_REQ		0x40
+#define RADIO_ARQ_SEQ_BM	0x3F
+
+// ACK packet: the header, then the RSSI/LQI status bytes the acknowledged
+//	packet was received with, if any
+#define RADIO_ACK_LEN		(RADIO_HDR_LEN + RADIO_STATUS_LEN)
+
+// ACK air time at usPerByte (32 us at 250 kBaud): preamble and sync (8 bytes),
+//	then the length byte, ACK and CRC, doubled by FEC
+#define RADIO_ACK_AIR_US(usPerByte, fec)	((usPerByte) * (8 + ((fec) ? 2 : 1) \
+								* (RADIO_LEN_FIELD + RADIO_ACK_LEN + (RADIO_USE_CRC ? 2 : 0))))
+
+// Longest time from the end of a packet to the start of its ACK (us): the
+//	receiver's GDO ISR reading what is left of the packet in the RX FIFO
+//	(about 12 us per byte at 1 MHz) and loading the ACK
+#if(RADIO_STREAM)
+#define RADIO_ARQ_TURNAROUND_US	(200 + 12 * (RADIO_RX_THR + RADIO_STATUS_LEN))
+#else
+#define RADIO_ARQ_TURNAROUND_US	(200 + 12 * RADIO_RX_FRAME_LEN)
+#endif
+
+// ACK timeout in VLO ticks, counted at the fastest VLO (20 kHz), for a profile
+//	with the given byte time and FEC
+#define RADIO_ARQ_TIMEOUT(usPerByte, fec)	((RADIO_ARQ_TURNAROUND_US + RADIO_ACK_AIR_US(usPerByte, fec)) / 50 + 1)
+
+#if(RADIO_HOP_CHANNELS < 1 || RADIO_HOP_CHANNELS > 16)
+#error "RADIO_HOP_CHANNELS must be 1 to 16"
+#endif
+#if(SMARTRF_SETTING_CHANNR + (RADIO_HOP_CHANNELS - 1) * RADIO_HOP_SPACING > 255)
+#error "The hopping channels run past CHANNR 255"
+#endif
+
+///////////////////////////////////////////////////////////////////////////////
+/// Transmit statistics
+///////////////////////////////////////////////////////////////////////////////
+typedef struct RADIO_tx_stats_s
+{
+    uint16_t packets;		// Packets started, retries included
+    uint16_t ccaFails;		// Clear channel assessments which found the channel busy
+    uint16_t drops;			// Packets abandoned with RADIO_CCA_FAIL
+    uint16_t underflows;	// Packets cut short because the TX FIFO ran dry
+    uint16_t retries;		// Packets resent for lack of an ACK
+    uint16_t noAcks;		// Packets abandoned with RADIO_NO_ACK
+    uint32_t backoffTicks;	// VLO ticks spent backing off
+} RADIO_tx_stats_t;
 
 ///////////////////////////////////////////////////////////////////////////////
 /// Prototypes
@@ -58,26 +206,76 @@ int16_t RADIO_SETUP_RX(void (*rxCallback)(void));
 // Start polling
 int16_t RADIO_RX_POLL( void );
 
+// Select Wake-on-Radio polling with the given Event 0 period and RX timeout
+int16_t RADIO_RX_WOR( uint16_t event0, uint8_t rxTime );
+// Select continuous receive polling (default)
+int16_t RADIO_RX_CONTINUOUS( void );
+// Longest Event 0 period which wakes the receiver within latencyMs
+uint16_t RADIO_WOR_EVENT0( uint16_t latencyMs );
+// Shortest RX timeout which listens for at least listenUs per wake-up
+uint8_t RADIO_WOR_RX_TIME( uint16_t event0, uint16_t listenUs );
+
 // Set radio state
 int16_t RADIO_SLEEP();
 int16_t RADIO_IDLE();
+// Wake the radio from SLEEP into IDLE, restoring what SLEEP lost
+int16_t RADIO_WAKE( void );
+// Chip status byte of the last SPI transaction (see CC2500_STATUS_*)
+uint8_t RADIO_CHIP_STATUS( void );
 
 
 // Turn on/off receive polling
 int16_t RADIO_RX_ON();
 int16_t RADIO_RX_OFF();
 
-// Copy received data to dest array, and report network and transmitter ID
-uint16_t RADIO_RECEIVE( uint8_t* dest, uint8_t* nwkID, uint8_t* txID);
+// Copy received payload to dest array, and report the address it was sent to
+//	and the packet's signal strength (dBm) and link quality
+uint16_t RADIO_RECEIVE( uint8_t* dest, uint8_t* addr, int8_t* rssi, uint8_t* lqi);
+// Number of received packets dropped because the receive queue was full
+uint16_t RADIO_RX_OVERFLOWS( void );
 
 // Set the transmit power level
 int16_t RADIO_SET_TX_PWR(uint8_t pwr);
+// Set the transmit power to a level of the power ladder
+int16_t RADIO_SET_TX_LEVEL( uint8_t level );
+// Output power (dBm) of a level of the power ladder
+int8_t RADIO_TX_LEVEL_DBM( uint8_t level );
 
-// Send a packet with the given payload message
-int16_t RADIO_TX(uint8_t* msg );
+// Configure a TX completion callback function (optional)
+int16_t RADIO_SETUP_TX(void (*txCallback)(void));
+// Send a packet to addr with the given payload message of len bytes, sleeping
+//	until it has been sent (and with RADIO_USE_ARQ, acknowledged)
+int16_t RADIO_TX(uint8_t addr, uint8_t* msg, uint8_t len );
+// Start sending a packet and return without waiting for its end
+int16_t RADIO_TX_START(uint8_t addr, uint8_t* msg, uint8_t len );
+// Check whether a packet started by RADIO_TX_START is still being sent
+uint8_t RADIO_TX_BUSY( void );
+// Retries used by the last RADIO_TX, and the RSSI/LQI its ACK reported
+uint8_t RADIO_TX_RETRIES( int8_t* rssi, uint8_t* lqi );
+// Copy the transmit, ARQ and CCA backoff counters since RADIO_INIT
+void RADIO_TX_STATS( RADIO_tx_stats_t* stats );
 
 // Command the radio to perform manual frequency synth calibration routine.
 int16_t RADIO_CALIBRATE( void );
+// Calibrate for the current channel and temperature, from the cache if possible
+int16_t RADIO_CALIBRATE_CACHED( uint16_t temp );
+// Check whether the calibration matches the current channel and temperature
+uint8_t RADIO_CAL_VALID( uint16_t temp );
+
+// Tune to a channel, with its cached calibration
+int16_t RADIO_SET_CHANNEL( uint8_t chan );
+// Channel the radio is tuned to
+uint8_t RADIO_CHANNEL( void );
+// Hop to an entry of the network's channel sequence, or to the next one
+int16_t RADIO_HOP_TO( uint8_t hop );
+int16_t RADIO_HOP_NEXT( void );
+// Exclude a (noisy) channel from the hopping sequence, or use it again
+int16_t RADIO_HOP_EXCLUDE( uint8_t chan, uint8_t exclude );
+
+// Switch to a modem profile, writing only the registers which change
+int16_t RADIO_SET_PROFILE( uint8_t profile );
+// Modem profile in use
+uint8_t RADIO_PROFILE( void );
 
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -1,10 +1,15 @@
 /**
- * @brief Provides a const array based on radio register settings.
+ * @brief Provides const arrays based on radio register settings.
  *
  * Makes it easy to copy the settings over to the chip via SPI.
  * This file is specific to the CC2500. Actual register settings can
  * be found in the smartrf_CCXXXX header file.
  *
+ * After a reset only the registers whose setting differs from the chip's
+ * reset value need writing. RADIO_REG_RUNS holds just those, as contiguous
+ * burst runs, and is worked out by the preprocessor from the settings below,
+ * so it follows any change to them or to config.h.
+ *
  * @file radio_register_map.h
  * @author Aaron Parks, UW Sensor Systems Laboratory
  * @version 1.0
@@ -32,74 +37,141 @@
 #define RADIO_REG_BLOCK_LEN	0x2F // 0x00 to 0x2E
 
 ///////////////////////////////////////////////////////////////////////////////
-//	Radio register settings array - Only necessary registers included
+//	Radio register settings - Kept to expressions #if can evaluate
 ///////////////////////////////////////////////////////////////////////////////
 
-const uint8_t RADIO_REG_SETTINGS[] =
-{
-    0x06,/*SMARTF_SETTING_IOCFG2*/ // MODIFIED to assert on TX and deassert on TXFIFO underflow
-    0x29,/*SMARTRF_SETTING_IOCFG1*/// MODIFIED to mirror CHIP_RDYn
-    0x06,/*SMARTRF_SETTING_IOCFG0*/ // MODIFIED from 0x0C to 0x06 (Sync) to cause new packet to assert GDO0
-    SMARTRF_SETTING_FIFOTHR,
-    SMARTRF_SETTING_SYNC1,
-    SMARTRF_SETTING_SYNC0,
-    RADIO_PKT_LEN,/*SMARTRF_SETTING_PKTLEN,*/
-
-    //@todo Experiment with Preamble Quality Estimator Threshold (PQT), and try reading RSSI and CRC params.
-    0x00, /*SMARTRF_SETTING_PKTCTRL1*/ // MODIFIED from 0x04 to 0x00 to disable status transmission
-
-    /*SMARTRF_SETTING_PKTCTRL0*/ // MODIFIED from 0x12 to 0x00 to use fixed pkt len, and to use FIFOs. 0x04 to use CRC.
-#if(RADIO_USE_CRC)
-    0x04,
+#define RADIO_CFG_IOCFG2	0x06	// MODIFIED to assert on TX and deassert on TXFIFO underflow
+#define RADIO_CFG_IOCFG1	0x29	// MODIFIED to mirror CHIP_RDYn
+#if(RADIO_STREAM)
+#define RADIO_CFG_IOCFG0	0x00	// MODIFIED from 0x0C to 0x00 to assert GDO0 on the RX FIFO threshold
+#elif(RADIO_USE_CRC && !RADIO_USE_ARQ)
+#define RADIO_CFG_IOCFG0	0x07	// MODIFIED from 0x0C to 0x07 to assert GDO0 on a packet with CRC OK
 #else
-    0x00,
+#define RADIO_CFG_IOCFG0	0x06	// MODIFIED from 0x0C to 0x06 (Sync) to cause new packet to assert GDO0
 #endif
+#define RADIO_CFG_FIFOTHR	SMARTRF_SETTING_FIFOTHR
+#define RADIO_CFG_SYNC1		RADIO_NWK_ID	// MODIFIED to carry the network ID
+#define RADIO_CFG_SYNC0		(0xFF & ~RADIO_NWK_ID)	// MODIFIED to the complement, for a balanced sync word
+#define RADIO_CFG_PKTLEN	RADIO_PKT_LEN	// Maximum length in variable-length mode
 
-    SMARTRF_SETTING_ADDR,
-    SMARTRF_SETTING_CHANNR,
-    SMARTRF_SETTING_FSCTRL1,
-    SMARTRF_SETTING_FSCTRL0,
-    SMARTRF_SETTING_FREQ2,
-    SMARTRF_SETTING_FREQ1,
-    SMARTRF_SETTING_FREQ0,
-    SMARTRF_SETTING_MDMCFG4,
-    SMARTRF_SETTING_MDMCFG3,
-    SMARTRF_SETTING_MDMCFG2,//@todo Experiment with SYNC_MODE threshold
+//@todo Experiment with Preamble Quality Estimator Threshold (PQT), and try reading RSSI and CRC params.
+// MODIFIED from 0x04: 0x08 to flush packets failing CRC, 0x04 to append RSSI/LQI status,
+//	0x03 to check the address with 0x00 and 0xFF broadcast.
+#define RADIO_CFG_PKTCTRL1	((RADIO_CRC_AUTOFLUSH ? 0x08 : 0x00) | (RADIO_RX_STATUS ? 0x04 : 0x00) | (RADIO_USE_ADDR ? 0x03 : 0x00))
 
-    /*SMARTRF_SETTING_MDMCFG1*/
+// MODIFIED from 0x12 to 0x00 to use fixed pkt len, and to use FIFOs. 0x04 to use CRC, 0x01 for variable pkt len.
+#if(RADIO_USE_CRC && RADIO_VAR_LEN)
+#define RADIO_CFG_PKTCTRL0	0x05
+#elif(RADIO_USE_CRC)
+#define RADIO_CFG_PKTCTRL0	0x04
+#elif(RADIO_VAR_LEN)
+#define RADIO_CFG_PKTCTRL0	0x01
+#else
+#define RADIO_CFG_PKTCTRL0	0x00
+#endif
+
+#define RADIO_CFG_ADDR		RADIO_DEV_ID	// MODIFIED to this device's address
+#define RADIO_CFG_CHANNR	SMARTRF_SETTING_CHANNR
+#define RADIO_CFG_FSCTRL1	SMARTRF_SETTING_FSCTRL1
+#define RADIO_CFG_FSCTRL0	SMARTRF_SETTING_FSCTRL0
+#define RADIO_CFG_FREQ2		SMARTRF_SETTING_FREQ2
+#define RADIO_CFG_FREQ1		SMARTRF_SETTING_FREQ1
+#define RADIO_CFG_FREQ0		SMARTRF_SETTING_FREQ0
+#define RADIO_CFG_MDMCFG4	SMARTRF_SETTING_MDMCFG4
+#define RADIO_CFG_MDMCFG3	SMARTRF_SETTING_MDMCFG3
+#define RADIO_CFG_MDMCFG2	SMARTRF_SETTING_MDMCFG2	//@todo Experiment with SYNC_MODE threshold
 #if(RADIO_USE_FEC)
-    0x80 | SMARTRF_SETTING_MDMCFG1, // OR the existing setting with 0x80 to enable FEC.
+#define RADIO_CFG_MDMCFG1	(0x80 | SMARTRF_SETTING_MDMCFG1)	// OR the existing setting with 0x80 to enable FEC.
+#else
+#define RADIO_CFG_MDMCFG1	SMARTRF_SETTING_MDMCFG1
+#endif
+#define RADIO_CFG_MDMCFG0	SMARTRF_SETTING_MDMCFG0
+#define RADIO_CFG_DEVIATN	SMARTRF_SETTING_DEVIATN
+#define RADIO_CFG_MCSM2		SMARTRF_SETTING_MCSM2	//@todo Learn more about RX_TIME and RX_TIME_QUAL
+#if(RADIO_USE_ARQ)
+// MODIFIED from 0x30 to 0x37 to wait in FSTXON after a packet is received, ready to
+//	send its ACK, and to go straight to RX after a packet is sent, to hear the ACK
+#define RADIO_CFG_MCSM1		0x37
 #else
-    SMARTRF_SETTING_MDMCFG1,
-#endif
-
-    SMARTRF_SETTING_MDMCFG0,
-    SMARTRF_SETTING_DEVIATN,
-    SMARTRF_SETTING_MCSM2, //@todo Learn more about RX_TIME and RX_TIME_QUAL
-    0x3C, /*SMARTRF_SETTING_MCSM1*/ // MODIFIED from 0x30 to 0x3C to force radio to stay in RX after packet received
-    0x08, /*SMARTRF_SETTING_MCSM0*/ // MODIFIED from 0x18 to 0x08 to disable autocal
-    SMARTRF_SETTING_FOCCFG,
-    SMARTRF_SETTING_BSCFG,
-    SMARTRF_SETTING_AGCCTRL2, // @todo  Experiment with maximum gain settings
-    SMARTRF_SETTING_AGCCTRL1,
-    SMARTRF_SETTING_AGCCTRL0,
-    SMARTRF_SETTING_WOREVT1,
-    SMARTRF_SETTING_WOREVT0,
-    SMARTRF_SETTING_WORCTRL,
-    SMARTRF_SETTING_FREND1,
-    SMARTRF_SETTING_FREND0,
-    SMARTRF_SETTING_FSCAL3,
-    SMARTRF_SETTING_FSCAL2,
-    SMARTRF_SETTING_FSCAL1,
-    SMARTRF_SETTING_FSCAL0,
-    SMARTRF_SETTING_RCCTRL1,
-    SMARTRF_SETTING_RCCTRL0,
-    SMARTRF_SETTING_FSTEST,
-    SMARTRF_SETTING_PTEST,
-    SMARTRF_SETTING_AGCTEST,
-    SMARTRF_SETTING_TEST2,
-    SMARTRF_SETTING_TEST1,
-    SMARTRF_SETTING_TEST0, // 0x2E, end of test section
+#define RADIO_CFG_MCSM1		0x3C	// MODIFIED from 0x30 to 0x3C to force radio to stay in RX after packet received
+#endif
+#define RADIO_CFG_MCSM0		0x08	// MODIFIED from 0x18 to 0x08 to disable autocal
+#define RADIO_CFG_FOCCFG	SMARTRF_SETTING_FOCCFG
+#define RADIO_CFG_BSCFG		SMARTRF_SETTING_BSCFG
+#define RADIO_CFG_AGCCTRL2	SMARTRF_SETTING_AGCCTRL2	// @todo  Experiment with maximum gain settings
+#define RADIO_CFG_AGCCTRL1	SMARTRF_SETTING_AGCCTRL1
+#define RADIO_CFG_AGCCTRL0	SMARTRF_SETTING_AGCCTRL0
+#define RADIO_CFG_WOREVT1	SMARTRF_SETTING_WOREVT1
+#define RADIO_CFG_WOREVT0	SMARTRF_SETTING_WOREVT0
+#define RADIO_CFG_WORCTRL	SMARTRF_SETTING_WORCTRL
+#define RADIO_CFG_FREND1	SMARTRF_SETTING_FREND1
+#define RADIO_CFG_FREND0	SMARTRF_SETTING_FREND0
+#define RADIO_CFG_FSCAL3	SMARTRF_SETTING_FSCAL3
+#define RADIO_CFG_FSCAL2	SMARTRF_SETTING_FSCAL2
+#define RADIO_CFG_FSCAL1	SMARTRF_SETTING_FSCAL1
+#define RADIO_CFG_FSCAL0	SMARTRF_SETTING_FSCAL0
+#define RADIO_CFG_RCCTRL1	SMARTRF_SETTING_RCCTRL1
+#define RADIO_CFG_RCCTRL0	SMARTRF_SETTING_RCCTRL0
+#define RADIO_CFG_FSTEST	SMARTRF_SETTING_FSTEST
+#define RADIO_CFG_PTEST		SMARTRF_SETTING_PTEST
+#define RADIO_CFG_AGCTEST	SMARTRF_SETTING_AGCTEST
+#define RADIO_CFG_TEST2		SMARTRF_SETTING_TEST2
+#define RADIO_CFG_TEST1		SMARTRF_SETTING_TEST1
+#define RADIO_CFG_TEST0		SMARTRF_SETTING_TEST0	// 0x2E, end of test section
+
+///////////////////////////////////////////////////////////////////////////////
+//	Radio register settings array - Only necessary registers included
+///////////////////////////////////////////////////////////////////////////////
+
+const uint8_t RADIO_REG_SETTINGS[] =
+{
+    RADIO_CFG_IOCFG2,
+    RADIO_CFG_IOCFG1,
+    RADIO_CFG_IOCFG0,
+    RADIO_CFG_FIFOTHR,
+    RADIO_CFG_SYNC1,
+    RADIO_CFG_SYNC0,
+    RADIO_CFG_PKTLEN,
+    RADIO_CFG_PKTCTRL1,
+    RADIO_CFG_PKTCTRL0,
+    RADIO_CFG_ADDR,
+    RADIO_CFG_CHANNR,
+    RADIO_CFG_FSCTRL1,
+    RADIO_CFG_FSCTRL0,
+    RADIO_CFG_FREQ2,
+    RADIO_CFG_FREQ1,
+    RADIO_CFG_FREQ0,
+    RADIO_CFG_MDMCFG4,
+    RADIO_CFG_MDMCFG3,
+    RADIO_CFG_MDMCFG2,
+    RADIO_CFG_MDMCFG1,
+    RADIO_CFG_MDMCFG0,
+    RADIO_CFG_DEVIATN,
+    RADIO_CFG_MCSM2,
+    RADIO_CFG_MCSM1,
+    RADIO_CFG_MCSM0,
+    RADIO_CFG_FOCCFG,
+    RADIO_CFG_BSCFG,
+    RADIO_CFG_AGCCTRL2,
+    RADIO_CFG_AGCCTRL1,
+    RADIO_CFG_AGCCTRL0,
+    RADIO_CFG_WOREVT1,
+    RADIO_CFG_WOREVT0,
+    RADIO_CFG_WORCTRL,
+    RADIO_CFG_FREND1,
+    RADIO_CFG_FREND0,
+    RADIO_CFG_FSCAL3,
+    RADIO_CFG_FSCAL2,
+    RADIO_CFG_FSCAL1,
+    RADIO_CFG_FSCAL0,
+    RADIO_CFG_RCCTRL1,
+    RADIO_CFG_RCCTRL0,
+    RADIO_CFG_FSTEST,
+    RADIO_CFG_PTEST,
+    RADIO_CFG_AGCTEST,
+    RADIO_CFG_TEST2,
+    RADIO_CFG_TEST1,
+    RADIO_CFG_TEST0, // 0x2E, end of test section
     /*SMARTRF_SETTING_PARTNUM,
     SMARTRF_SETTING_VERSION,
     SMARTRF_SETTING_FREQEST,
@@ -116,6 +188,524 @@ const uint8_t RADIO_REG_SETTINGS[] =
     SMARTRF_SETTING_RCCTRL0_STATUS,*/
 };
 
+///////////////////////////////////////////////////////////////////////////////
+//	Differential initialisation - Registers differing from the reset values
+///////////////////////////////////////////////////////////////////////////////
+
+// Non-zero if a register's configured value differs from its reset value
+#define RADIO_DIF_00	(RADIO_CFG_IOCFG2 != 0x29)
+#define RADIO_DIF_01	(RADIO_CFG_IOCFG1 != 0x2E)
+#define RADIO_DIF_02	(RADIO_CFG_IOCFG0 != 0x3F)
+#define RADIO_DIF_03	(RADIO_CFG_FIFOTHR != 0x07)
+#define RADIO_DIF_04	(RADIO_CFG_SYNC1 != 0xD3)
+#define RADIO_DIF_05	(RADIO_CFG_SYNC0 != 0x91)
+#define RADIO_DIF_06	(RADIO_CFG_PKTLEN != 0xFF)
+#define RADIO_DIF_07	(RADIO_CFG_PKTCTRL1 != 0x04)
+#define RADIO_DIF_08	(RADIO_CFG_PKTCTRL0 != 0x45)
+#define RADIO_DIF_09	(RADIO_CFG_ADDR != 0x00)
+#define RADIO_DIF_0A	(RADIO_CFG_CHANNR != 0x00)
+#define RADIO_DIF_0B	(RADIO_CFG_FSCTRL1 != 0x0F)
+#define RADIO_DIF_0C	(RADIO_CFG_FSCTRL0 != 0x00)
+#define RADIO_DIF_0D	(RADIO_CFG_FREQ2 != 0x5E)
+#define RADIO_DIF_0E	(RADIO_CFG_FREQ1 != 0xC4)
+#define RADIO_DIF_0F	(RADIO_CFG_FREQ0 != 0xEC)
+#define RADIO_DIF_10	(RADIO_CFG_MDMCFG4 != 0x8C)
+#define RADIO_DIF_11	(RADIO_CFG_MDMCFG3 != 0x22)
+#define RADIO_DIF_12	(RADIO_CFG_MDMCFG2 != 0x02)
+#define RADIO_DIF_13	(RADIO_CFG_MDMCFG1 != 0x22)
+#define RADIO_DIF_14	(RADIO_CFG_MDMCFG0 != 0xF8)
+#define RADIO_DIF_15	(RADIO_CFG_DEVIATN != 0x47)
+#define RADIO_DIF_16	(RADIO_CFG_MCSM2 != 0x07)
+#define RADIO_DIF_17	(RADIO_CFG_MCSM1 != 0x30)
+#define RADIO_DIF_18	(RADIO_CFG_MCSM0 != 0x04)
+#define RADIO_DIF_19	(RADIO_CFG_FOCCFG != 0x36)
+#define RADIO_DIF_1A	(RADIO_CFG_BSCFG != 0x6C)
+#define RADIO_DIF_1B	(RADIO_CFG_AGCCTRL2 != 0x03)
+#define RADIO_DIF_1C	(RADIO_CFG_AGCCTRL1 != 0x40)
+#define RADIO_DIF_1D	(RADIO_CFG_AGCCTRL0 != 0x91)
+#define RADIO_DIF_1E	(RADIO_CFG_WOREVT1 != 0x87)
+#define RADIO_DIF_1F	(RADIO_CFG_WOREVT0 != 0x6B)
+#define RADIO_DIF_20	(RADIO_CFG_WORCTRL != 0xF8)
+#define RADIO_DIF_21	(RADIO_CFG_FREND1 != 0x56)
+#define RADIO_DIF_22	(RADIO_CFG_FREND0 != 0x10)
+#define RADIO_DIF_23	(RADIO_CFG_FSCAL3 != 0xA9)
+#define RADIO_DIF_24	(RADIO_CFG_FSCAL2 != 0x0A)
+#define RADIO_DIF_25	(RADIO_CFG_FSCAL1 != 0x20)
+#define RADIO_DIF_26	(RADIO_CFG_FSCAL0 != 0x0D)
+#define RADIO_DIF_27	(RADIO_CFG_RCCTRL1 != 0x41)
+#define RADIO_DIF_28	(RADIO_CFG_RCCTRL0 != 0x00)
+#define RADIO_DIF_29	(RADIO_CFG_FSTEST != 0x59)
+#define RADIO_DIF_2A	(RADIO_CFG_PTEST != 0x7F)
+#define RADIO_DIF_2B	(RADIO_CFG_AGCTEST != 0x3F)
+#define RADIO_DIF_2C	(RADIO_CFG_TEST2 != 0x88)
+#define RADIO_DIF_2D	(RADIO_CFG_TEST1 != 0x31)
+#define RADIO_DIF_2E	(RADIO_CFG_TEST0 != 0x0B)
+
+// Non-zero if a register is written: where it differs, or where it is a
+//	single register between two that differ. Writing it costs one data byte,
+//	no more than the address byte of a new run, and saves a transaction.
+#define RADIO_WR_00	RADIO_DIF_00
+#define RADIO_WR_01	(RADIO_DIF_01 || (RADIO_DIF_00 && RADIO_DIF_02))
+#define RADIO_WR_02	(RADIO_DIF_02 || (RADIO_DIF_01 && RADIO_DIF_03))
+#define RADIO_WR_03	(RADIO_DIF_03 || (RADIO_DIF_02 && RADIO_DIF_04))
+#define RADIO_WR_04	(RADIO_DIF_04 || (RADIO_DIF_03 && RADIO_DIF_05))
+#define RADIO_WR_05	(RADIO_DIF_05 || (RADIO_DIF_04 && RADIO_DIF_06))
+#define RADIO_WR_06	(RADIO_DIF_06 || (RADIO_DIF_05 && RADIO_DIF_07))
+#define RADIO_WR_07	(RADIO_DIF_07 || (RADIO_DIF_06 && RADIO_DIF_08))
+#define RADIO_WR_08	(RADIO_DIF_08 || (RADIO_DIF_07 && RADIO_DIF_09))
+#define RADIO_WR_09	(RADIO_DIF_09 || (RADIO_DIF_08 && RADIO_DIF_0A))
+#define RADIO_WR_0A	(RADIO_DIF_0A || (RADIO_DIF_09 && RADIO_DIF_0B))
+#define RADIO_WR_0B	(RADIO_DIF_0B || (RADIO_DIF_0A && RADIO_DIF_0C))
+#define RADIO_WR_0C	(RADIO_DIF_0C || (RADIO_DIF_0B && RADIO_DIF_0D))
+#define RADIO_WR_0D	(RADIO_DIF_0D || (RADIO_DIF_0C && RADIO_DIF_0E))
+#define RADIO_WR_0E	(RADIO_DIF_0E || (RADIO_DIF_0D && RADIO_DIF_0F))
+#define RADIO_WR_0F	(RADIO_DIF_0F || (RADIO_DIF_0E && RADIO_DIF_10))
+#define RADIO_WR_10	(RADIO_DIF_10 || (RADIO_DIF_0F && RADIO_DIF_11))
+#define RADIO_WR_11	(RADIO_DIF_11 || (RADIO_DIF_10 && RADIO_DIF_12))
+#define RADIO_WR_12	(RADIO_DIF_12 || (RADIO_DIF_11 && RADIO_DIF_13))
+#define RADIO_WR_13	(RADIO_DIF_13 || (RADIO_DIF_12 && RADIO_DIF_14))
+#define RADIO_WR_14	(RADIO_DIF_14 || (RADIO_DIF_13 && RADIO_DIF_15))
+#define RADIO_WR_15	(RADIO_DIF_15 || (RADIO_DIF_14 && RADIO_DIF_16))
+#define RADIO_WR_16	(RADIO_DIF_16 || (RADIO_DIF_15 && RADIO_DIF_17))
+#define RADIO_WR_17	(RADIO_DIF_17 || (RADIO_DIF_16 && RADIO_DIF_18))
+#define RADIO_WR_18	(RADIO_DIF_18 || (RADIO_DIF_17 && RADIO_DIF_19))
+#define RADIO_WR_19	(RADIO_DIF_19 || (RADIO_DIF_18 && RADIO_DIF_1A))
+#define RADIO_WR_1A	(RADIO_DIF_1A || (RADIO_DIF_19 && RADIO_DIF_1B))
+#define RADIO_WR_1B	(RADIO_DIF_1B || (RADIO_DIF_1A && RADIO_DIF_1C))
+#define RADIO_WR_1C	(RADIO_DIF_1C || (RADIO_DIF_1B && RADIO_DIF_1D))
+#define RADIO_WR_1D	(RADIO_DIF_1D || (RADIO_DIF_1C && RADIO_DIF_1E))
+#define RADIO_WR_1E	(RADIO_DIF_1E || (RADIO_DIF_1D && RADIO_DIF_1F))
+#define RADIO_WR_1F	(RADIO_DIF_1F || (RADIO_DIF_1E && RADIO_DIF_20))
+#define RADIO_WR_20	(RADIO_DIF_20 || (RADIO_DIF_1F && RADIO_DIF_21))
+#define RADIO_WR_21	(RADIO_DIF_21 || (RADIO_DIF_20 && RADIO_DIF_22))
+#define RADIO_WR_22	(RADIO_DIF_22 || (RADIO_DIF_21 && RADIO_DIF_23))
+#define RADIO_WR_23	(RADIO_DIF_23 || (RADIO_DIF_22 && RADIO_DIF_24))
+#define RADIO_WR_24	(RADIO_DIF_24 || (RADIO_DIF_23 && RADIO_DIF_25))
+#define RADIO_WR_25	(RADIO_DIF_25 || (RADIO_DIF_24 && RADIO_DIF_26))
+#define RADIO_WR_26	(RADIO_DIF_26 || (RADIO_DIF_25 && RADIO_DIF_27))
+#define RADIO_WR_27	(RADIO_DIF_27 || (RADIO_DIF_26 && RADIO_DIF_28))
+#define RADIO_WR_28	(RADIO_DIF_28 || (RADIO_DIF_27 && RADIO_DIF_29))
+#define RADIO_WR_29	(RADIO_DIF_29 || (RADIO_DIF_28 && RADIO_DIF_2A))
+#define RADIO_WR_2A	(RADIO_DIF_2A || (RADIO_DIF_29 && RADIO_DIF_2B))
+#define RADIO_WR_2B	(RADIO_DIF_2B || (RADIO_DIF_2A && RADIO_DIF_2C))
+#define RADIO_WR_2C	(RADIO_DIF_2C || (RADIO_DIF_2B && RADIO_DIF_2D))
+#define RADIO_WR_2D	(RADIO_DIF_2D || (RADIO_DIF_2C && RADIO_DIF_2E))
+#define RADIO_WR_2E	RADIO_DIF_2E
+
+// Number of registers in the run written from each register on
+#define RADIO_RUN_2E	(RADIO_WR_2E ? 1 : 0)
+#define RADIO_RUN_2D	(RADIO_WR_2D ? 1 + RADIO_RUN_2E : 0)
+#define RADIO_RUN_2C	(RADIO_WR_2C ? 1 + RADIO_RUN_2D : 0)
+#define RADIO_RUN_2B	(RADIO_WR_2B ? 1 + RADIO_RUN_2C : 0)
+#define RADIO_RUN_2A	(RADIO_WR_2A ? 1 + RADIO_RUN_2B : 0)
+#define RADIO_RUN_29	(RADIO_WR_29 ? 1 + RADIO_RUN_2A : 0)
+#define RADIO_RUN_28	(RADIO_WR_28 ? 1 + RADIO_RUN_29 : 0)
+#define RADIO_RUN_27	(RADIO_WR_27 ? 1 + RADIO_RUN_28 : 0)
+#define RADIO_RUN_26	(RADIO_WR_26 ? 1 + RADIO_RUN_27 : 0)
+#define RADIO_RUN_25	(RADIO_WR_25 ? 1 + RADIO_RUN_26 : 0)
+#define RADIO_RUN_24	(RADIO_WR_24 ? 1 + RADIO_RUN_25 : 0)
+#define RADIO_RUN_23	(RADIO_WR_23 ? 1 + RADIO_RUN_24 : 0)
+#define RADIO_RUN_22	(RADIO_WR_22 ? 1 + RADIO_RUN_23 : 0)
+#define RADIO_RUN_21	(RADIO_WR_21 ? 1 + RADIO_RUN_22 : 0)
+#define RADIO_RUN_20	(RADIO_WR_20 ? 1 + RADIO_RUN_21 : 0)
+#define RADIO_RUN_1F	(RADIO_WR_1F ? 1 + RADIO_RUN_20 : 0)
+#define RADIO_RUN_1E	(RADIO_WR_1E ? 1 + RADIO_RUN_1F : 0)
+#define RADIO_RUN_1D	(RADIO_WR_1D ? 1 + RADIO_RUN_1E : 0)
+#define RADIO_RUN_1C	(RADIO_WR_1C ? 1 + RADIO_RUN_1D : 0)
+#define RADIO_RUN_1B	(RADIO_WR_1B ? 1 + RADIO_RUN_1C : 0)
+#define RADIO_RUN_1A	(RADIO_WR_1A ? 1 + RADIO_RUN_1B : 0)
+#define RADIO_RUN_19	(RADIO_WR_19 ? 1 + RADIO_RUN_1A : 0)
+#define RADIO_RUN_18	(RADIO_WR_18 ? 1 + RADIO_RUN_19 : 0)
+#define RADIO_RUN_17	(RADIO_WR_17 ? 1 + RADIO_RUN_18 : 0)
+#define RADIO_RUN_16	(RADIO_WR_16 ? 1 + RADIO_RUN_17 : 0)
+#define RADIO_RUN_15	(RADIO_WR_15 ? 1 + RADIO_RUN_16 : 0)
+#define RADIO_RUN_14	(RADIO_WR_14 ? 1 + RADIO_RUN_15 : 0)
+#define RADIO_RUN_13	(RADIO_WR_13 ? 1 + RADIO_RUN_14 : 0)
+#define RADIO_RUN_12	(RADIO_WR_12 ? 1 + RADIO_RUN_13 : 0)
+#define RADIO_RUN_11	(RADIO_WR_11 ? 1 + RADIO_RUN_12 : 0)
+#define RADIO_RUN_10	(RADIO_WR_10 ? 1 + RADIO_RUN_11 : 0)
+#define RADIO_RUN_0F	(RADIO_WR_0F ? 1 + RADIO_RUN_10 : 0)
+#define RADIO_RUN_0E	(RADIO_WR_0E ? 1 + RADIO_RUN_0F : 0)
+#define RADIO_RUN_0D	(RADIO_WR_0D ? 1 + RADIO_RUN_0E : 0)
+#define RADIO_RUN_0C	(RADIO_WR_0C ? 1 + RADIO_RUN_0D : 0)
+#define RADIO_RUN_0B	(RADIO_WR_0B ? 1 + RADIO_RUN_0C : 0)
+#define RADIO_RUN_0A	(RADIO_WR_0A ? 1 + RADIO_RUN_0B : 0)
+#define RADIO_RUN_09	(RADIO_WR_09 ? 1 + RADIO_RUN_0A : 0)
+#define RADIO_RUN_08	(RADIO_WR_08 ? 1 + RADIO_RUN_09 : 0)
+#define RADIO_RUN_07	(RADIO_WR_07 ? 1 + RADIO_RUN_08 : 0)
+#define RADIO_RUN_06	(RADIO_WR_06 ? 1 + RADIO_RUN_07 : 0)
+#define RADIO_RUN_05	(RADIO_WR_05 ? 1 + RADIO_RUN_06 : 0)
+#define RADIO_RUN_04	(RADIO_WR_04 ? 1 + RADIO_RUN_05 : 0)
+#define RADIO_RUN_03	(RADIO_WR_03 ? 1 + RADIO_RUN_04 : 0)
+#define RADIO_RUN_02	(RADIO_WR_02 ? 1 + RADIO_RUN_03 : 0)
+#define RADIO_RUN_01	(RADIO_WR_01 ? 1 + RADIO_RUN_02 : 0)
+#define RADIO_RUN_00	(RADIO_WR_00 ? 1 + RADIO_RUN_01 : 0)
+
+///////////////////////////////////////////////////////////////////////////////
+//	Differential register settings - {burst address, length, values...} for
+//	each run of registers written, ending with a 0
+///////////////////////////////////////////////////////////////////////////////
+
+const uint8_t RADIO_REG_RUNS[] =
+{
+#if(RADIO_WR_00)
+    CC2500_IOCFG2 | CC2500_WRITE_BURST, RADIO_RUN_00,
+    RADIO_CFG_IOCFG2,
+#endif
+#if(RADIO_WR_01)
+#if(!RADIO_WR_00)
+    CC2500_IOCFG1 | CC2500_WRITE_BURST, RADIO_RUN_01,
+#endif
+    RADIO_CFG_IOCFG1,
+#endif
+#if(RADIO_WR_02)
+#if(!RADIO_WR_01)
+    CC2500_IOCFG0 | CC2500_WRITE_BURST, RADIO_RUN_02,
+#endif
+    RADIO_CFG_IOCFG0,
+#endif
+#if(RADIO_WR_03)
+#if(!RADIO_WR_02)
+    CC2500_FIFOTHR | CC2500_WRITE_BURST, RADIO_RUN_03,
+#endif
+    RADIO_CFG_FIFOTHR,
+#endif
+#if(RADIO_WR_04)
+#if(!RADIO_WR_03)
+    CC2500_SYNC1 | CC2500_WRITE_BURST, RADIO_RUN_04,
+#endif
+    RADIO_CFG_SYNC1,
+#endif
+#if(RADIO_WR_05)
+#if(!RADIO_WR_04)
+    CC2500_SYNC0 | CC2500_WRITE_BURST, RADIO_RUN_05,
+#endif
+    RADIO_CFG_SYNC0,
+#endif
+#if(RADIO_WR_06)
+#if(!RADIO_WR_05)
+    CC2500_PKTLEN | CC2500_WRITE_BURST, RADIO_RUN_06,
+#endif
+    RADIO_CFG_PKTLEN,
+#endif
+#if(RADIO_WR_07)
+#if(!RADIO_WR_06)
+    CC2500_PKTCTRL1 | CC2500_WRITE_BURST, RADIO_RUN_07,
+#endif
+    RADIO_CFG_PKTCTRL1,
+#endif
+#if(RADIO_WR_08)
+#if(!RADIO_WR_07)
+    CC2500_PKTCTRL0 | CC2500_WRITE_BURST, RADIO_RUN_08,
+#endif
+    RADIO_CFG_PKTCTRL0,
+#endif
+#if(RADIO_WR_09)
+#if(!RADIO_WR_08)
+    CC2500_ADDR | CC2500_WRITE_BURST, RADIO_RUN_09,
+#endif
+    RADIO_CFG_ADDR,
+#endif
+#if(RADIO_WR_0A)
+#if(!RADIO_WR_09)
+    CC2500_CHANNR | CC2500_WRITE_BURST, RADIO_RUN_0A,
+#endif
+    RADIO_CFG_CHANNR,
+#endif
+#if(RADIO_WR_0B)
+#if(!RADIO_WR_0A)
+    CC2500_FSCTRL1 | CC2500_WRITE_BURST, RADIO_RUN_0B,
+#endif
+    RADIO_CFG_FSCTRL1,
+#endif
+#if(RADIO_WR_0C)
+#if(!RADIO_WR_0B)
+    CC2500_FSCTRL0 | CC2500_WRITE_BURST, RADIO_RUN_0C,
+#endif
+    RADIO_CFG_FSCTRL0,
+#endif
+#if(RADIO_WR_0D)
+#if(!RADIO_WR_0C)
+    CC2500_FREQ2 | CC2500_WRITE_BURST, RADIO_RUN_0D,
+#endif
+    RADIO_CFG_FREQ2,
+#endif
+#if(RADIO_WR_0E)
+#if(!RADIO_WR_0D)
+    CC2500_FREQ1 | CC2500_WRITE_BURST, RADIO_RUN_0E,
+#endif
+    RADIO_CFG_FREQ1,
+#endif
+#if(RADIO_WR_0F)
+#if(!RADIO_WR_0E)
+    CC2500_FREQ0 | CC2500_WRITE_BURST, RADIO_RUN_0F,
+#endif
+    RADIO_CFG_FREQ0,
+#endif
+#if(RADIO_WR_10)
+#if(!RADIO_WR_0F)
+    CC2500_MDMCFG4 | CC2500_WRITE_BURST, RADIO_RUN_10,
+#endif
+    RADIO_CFG_MDMCFG4,
+#endif
+#if(RADIO_WR_11)
+#if(!RADIO_WR_10)
+    CC2500_MDMCFG3 | CC2500_WRITE_BURST, RADIO_RUN_11,
+#endif
+    RADIO_CFG_MDMCFG3,
+#endif
+#if(RADIO_WR_12)
+#if(!RADIO_WR_11)
+    CC2500_MDMCFG2 | CC2500_WRITE_BURST, RADIO_RUN_12,
+#endif
+    RADIO_CFG_MDMCFG2,
+#endif
+#if(RADIO_WR_13)
+#if(!RADIO_WR_12)
+    CC2500_MDMCFG1 | CC2500_WRITE_BURST, RADIO_RUN_13,
+#endif
+    RADIO_CFG_MDMCFG1,
+#endif
+#if(RADIO_WR_14)
+#if(!RADIO_WR_13)
+    CC2500_MDMCFG0 | CC2500_WRITE_BURST, RADIO_RUN_14,
+#endif
+    RADIO_CFG_MDMCFG0,
+#endif
+#if(RADIO_WR_15)
+#if(!RADIO_WR_14)
+    CC2500_DEVIATN | CC2500_WRITE_BURST, RADIO_RUN_15,
+#endif
+    RADIO_CFG_DEVIATN,
+#endif
+#if(RADIO_WR_16)
+#if(!RADIO_WR_15)
+    CC2500_MCSM2 | CC2500_WRITE_BURST, RADIO_RUN_16,
+#endif
+    RADIO_CFG_MCSM2,
+#endif
+#if(RADIO_WR_17)
+#if(!RADIO_WR_16)
+    CC2500_MCSM1 | CC2500_WRITE_BURST, RADIO_RUN_17,
+#endif
+    RADIO_CFG_MCSM1,
+#endif
+#if(RADIO_WR_18)
+#if(!RADIO_WR_17)
+    CC2500_MCSM0 | CC2500_WRITE_BURST, RADIO_RUN_18,
+#endif
+    RADIO_CFG_MCSM0,
+#endif
+#if(RADIO_WR_19)
+#if(!RADIO_WR_18)
+    CC2500_FOCCFG | CC2500_WRITE_BURST, RADIO_RUN_19,
+#endif
+    RADIO_CFG_FOCCFG,
+#endif
+#if(RADIO_WR_1A)
+#if(!RADIO_WR_19)
+    CC2500_BSCFG | CC2500_WRITE_BURST, RADIO_RUN_1A,
+#endif
+    RADIO_CFG_BSCFG,
+#endif
+#if(RADIO_WR_1B)
+#if(!RADIO_WR_1A)
+    CC2500_AGCCTRL2 | CC2500_WRITE_BURST, RADIO_RUN_1B,
+#endif
+    RADIO_CFG_AGCCTRL2,
+#endif
+#if(RADIO_WR_1C)
+#if(!RADIO_WR_1B)
+    CC2500_AGCCTRL1 | CC2500_WRITE_BURST, RADIO_RUN_1C,
+#endif
+    RADIO_CFG_AGCCTRL1,
+#endif
+#if(RADIO_WR_1D)
+#if(!RADIO_WR_1C)
+    CC2500_AGCCTRL0 | CC2500_WRITE_BURST, RADIO_RUN_1D,
+#endif
+    RADIO_CFG_AGCCTRL0,
+#endif
+#if(RADIO_WR_1E)
+#if(!RADIO_WR_1D)
+    CC2500_WOREVT1 | CC2500_WRITE_BURST, RADIO_RUN_1E,
+#endif
+    RADIO_CFG_WOREVT1,
+#endif
+#if(RADIO_WR_1F)
+#if(!RADIO_WR_1E)
+    CC2500_WOREVT0 | CC2500_WRITE_BURST, RADIO_RUN_1F,
+#endif
+    RADIO_CFG_WOREVT0,
+#endif
+#if(RADIO_WR_20)
+#if(!RADIO_WR_1F)
+    CC2500_WORCTRL | CC2500_WRITE_BURST, RADIO_RUN_20,
+#endif
+    RADIO_CFG_WORCTRL,
+#endif
+#if(RADIO_WR_21)
+#if(!RADIO_WR_20)
+    CC2500_FREND1 | CC2500_WRITE_BURST, RADIO_RUN_21,
+#endif
+    RADIO_CFG_FREND1,
+#endif
+#if(RADIO_WR_22)
+#if(!RADIO_WR_21)
+    CC2500_FREND0 | CC2500_WRITE_BURST, RADIO_RUN_22,
+#endif
+    RADIO_CFG_FREND0,
+#endif
+#if(RADIO_WR_23)
+#if(!RADIO_WR_22)
+    CC2500_FSCAL3 | CC2500_WRITE_BURST, RADIO_RUN_23,
+#endif
+    RADIO_CFG_FSCAL3,
+#endif
+#if(RADIO_WR_24)
+#if(!RADIO_WR_23)
+    CC2500_FSCAL2 | CC2500_WRITE_BURST, RADIO_RUN_24,
+#endif
+    RADIO_CFG_FSCAL2,
+#endif
+#if(RADIO_WR_25)
+#if(!RADIO_WR_24)
+    CC2500_FSCAL1 | CC2500_WRITE_BURST, RADIO_RUN_25,
+#endif
+    RADIO_CFG_FSCAL1,
+#endif
+#if(RADIO_WR_26)
+#if(!RADIO_WR_25)
+    CC2500_FSCAL0 | CC2500_WRITE_BURST, RADIO_RUN_26,
+#endif
+    RADIO_CFG_FSCAL0,
+#endif
+#if(RADIO_WR_27)
+#if(!RADIO_WR_26)
+    CC2500_RCCTRL1 | CC2500_WRITE_BURST, RADIO_RUN_27,
+#endif
+    RADIO_CFG_RCCTRL1,
+#endif
+#if(RADIO_WR_28)
+#if(!RADIO_WR_27)
+    CC2500_RCCTRL0 | CC2500_WRITE_BURST, RADIO_RUN_28,
+#endif
+    RADIO_CFG_RCCTRL0,
+#endif
+#if(RADIO_WR_29)
+#if(!RADIO_WR_28)
+    CC2500_FSTEST | CC2500_WRITE_BURST, RADIO_RUN_29,
+#endif
+    RADIO_CFG_FSTEST,
+#endif
+#if(RADIO_WR_2A)
+#if(!RADIO_WR_29)
+    CC2500_PTEST | CC2500_WRITE_BURST, RADIO_RUN_2A,
+#endif
+    RADIO_CFG_PTEST,
+#endif
+#if(RADIO_WR_2B)
+#if(!RADIO_WR_2A)
+    CC2500_AGCTEST | CC2500_WRITE_BURST, RADIO_RUN_2B,
+#endif
+    RADIO_CFG_AGCTEST,
+#endif
+#if(RADIO_WR_2C)
+#if(!RADIO_WR_2B)
+    CC2500_TEST2 | CC2500_WRITE_BURST, RADIO_RUN_2C,
+#endif
+    RADIO_CFG_TEST2,
+#endif
+#if(RADIO_WR_2D)
+#if(!RADIO_WR_2C)
+    CC2500_TEST1 | CC2500_WRITE_BURST, RADIO_RUN_2D,
+#endif
+    RADIO_CFG_TEST1,
+#endif
+#if(RADIO_WR_2E)
+#if(!RADIO_WR_2D)
+    CC2500_TEST0 | CC2500_WRITE_BURST, RADIO_RUN_2E,
+#endif
+    RADIO_CFG_TEST0,
+#endif
+    0 // End of runs
+};
+
+///////////////////////////////////////////////////////////////////////////////
+//	Radio profiles - Modem registers set by RADIO_SET_PROFILE
+///////////////////////////////////////////////////////////////////////////////
+
+// Registers which differ between profiles, in address order
+#define RADIO_PROFILE_REG_COUNT	12
+
+const uint8_t RADIO_PROFILE_REGS[RADIO_PROFILE_REG_COUNT] =
+{
+    CC2500_FSCTRL1,
+    CC2500_MDMCFG4,
+    CC2500_MDMCFG3,
+    CC2500_MDMCFG2,
+    CC2500_MDMCFG1,
+    CC2500_DEVIATN,
+    CC2500_FOCCFG,
+    CC2500_BSCFG,
+    CC2500_AGCCTRL2,
+    CC2500_AGCCTRL1,
+    CC2500_AGCCTRL0,
+    CC2500_FREND1
+};
+
+// Their values in each profile. RADIO_PROFILE_250K is the register map above;
+//	the others take SmartRF Studio's 10 kBaud and 500 kBaud modem settings, and
+//	keep the map's preamble, sync mode and channel spacing.
+const uint8_t RADIO_PROFILE_SETTINGS[RADIO_PROFILES][RADIO_PROFILE_REG_COUNT] =
+{
+    {
+        // RADIO_PROFILE_10K
+        0x06,
+        0x78,						// 232 kHz channel filter, 10 kBaud
+        0x93,
+        RADIO_CFG_MDMCFG2 & 0x0F,	// 2-FSK, DC blocking filter on
+        RADIO_CFG_MDMCFG1,
+        0x44,						// 38 kHz deviation
+        0x16,
+        0x6C,
+        0x43,
+        0x40,
+        0x91,
+        0x56
+    },
+    {
+        // RADIO_PROFILE_250K
+        RADIO_CFG_FSCTRL1,
+        RADIO_CFG_MDMCFG4,
+        RADIO_CFG_MDMCFG3,
+        RADIO_CFG_MDMCFG2,
+        RADIO_CFG_MDMCFG1,
+        RADIO_CFG_DEVIATN,
+        RADIO_CFG_FOCCFG,
+        RADIO_CFG_BSCFG,
+        RADIO_CFG_AGCCTRL2,
+        RADIO_CFG_AGCCTRL1,
+        RADIO_CFG_AGCCTRL0,
+        RADIO_CFG_FREND1
+    },
+    {
+        // RADIO_PROFILE_500K
+        0x10,
+        0x0E,						// 812 kHz channel filter, 500 kBaud
+        0x3B,
+        0x70 | (RADIO_CFG_MDMCFG2 & 0x0F),	// MSK, DC blocking filter on
+        RADIO_CFG_MDMCFG1 & 0x7F,	// No FEC
+        0x00,
+        0x1D,
+        0x1C,
+        0xC7,
+        0x40,
+        0xB0,
+        0xB6
+    }
+};
+
 ///////////////////////////////////////////////////////////////////////////////
 #endif /* RADIO_REGISTER_MAP_H */
 ///////////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,231 @@
+/**
+ * @brief Closed-loop transmit power control on top of the radio power ladder.
+ *
+ * Every tracked destination starts at RADIO_PWR_MAX. After TXPWR_DOWN_AFTER
+ * good reports in a row its level steps down: with RSSI, by as many ladder
+ * steps as the RSSI is above TXPWR_RSSI_TARGET + TXPWR_RSSI_HYST, plus one;
+ * without, by one step at a time. A report below the target (or above
+ * TXPWR_LQI_MAX) raises the level one step, and a lost packet raises it
+ * TXPWR_UP_STEP steps. When the table is full, destinations are replaced in
+ * turn.
+ *
+ * @file txpower.c
+ * @author Aaron Parks, UW Sensor Systems Laboratory
+ * @version 1.0
+
+ */
+
+///////////////////////////////////////////////////////////////////////////////
+/// Includes
+///////////////////////////////////////////////////////////////////////////////
+#include "txpower.h"
+
+///////////////////////////////////////////////////////////////////////////////
+/// Power control state variables
+///////////////////////////////////////////////////////////////////////////////
+typedef struct TXPWR_dest_s
+{
+    uint8_t addr;
+    uint8_t level;					// Power ladder level used for addr
+    uint8_t good;					// Good reports in a row at this level
+} TXPWR_dest_t;
+
+TXPWR_dest_t	TXPWR_dests[TXPWR_DESTS];
+uint8_t			TXPWR_count;		// Entries of TXPWR_dests in use
+uint8_t			TXPWR_victim;		// Entry replaced next when the table is full
+
+///////////////////////////////////////////////////////////////////////////////
+// Local prototypes
+///////////////////////////////////////////////////////////////////////////////
+TXPWR_dest_t* TXPWR_FIND( uint8_t addr, uint8_t add );
+void TXPWR_RAISE( TXPWR_dest_t* d, uint8_t steps );
+
+///////////////////////////////////////////////////////////////////////////////
+
+/**
+ * Forget every destination. Until reports come in, packets to any
+ * destination are sent at RADIO_PWR_MAX.
+ */
+void TXPWR_INIT( void )
+{
+    TXPWR_count = 0;
+    TXPWR_victim = 0;
+}
+
+/**
+ * @param addr the destination device address
+ * @return The power ladder level chosen for addr; RADIO_PWR_MAX if it is not
+ *			tracked.
+ */
+uint8_t TXPWR_LEVEL( uint8_t addr )
+{
+    TXPWR_dest_t* d = TXPWR_FIND(addr, 0);
+
+    return d ? d->level : RADIO_PWR_MAX;
+}
+
+/**
+ * Set the radio's transmit power to the level chosen for addr. Call before
+ * every packet to addr; the radio only writes a changed level.
+ *
+ * @param addr the destination device address
+ * @return As RADIO_SET_TX_LEVEL.
+ */
+int16_t TXPWR_APPLY( uint8_t addr )
+{
+    return RADIO_SET_TX_LEVEL(TXPWR_LEVEL(addr));
+}
+
+/**
+ * Report a packet delivered to addr at the current level, e.g. an
+ * acknowledgement.
+ *
+ * @param addr the destination device address
+ * @param rssi the packet's RSSI at addr (dBm), or RADIO_RSSI_NONE if only
+ *			delivery is known
+ * @param lqi the packet's LQI at addr, or 0 if unknown
+ */
+void TXPWR_LINK_OK( uint8_t addr, int8_t rssi, uint8_t lqi )
+{
+    TXPWR_dest_t* d = TXPWR_FIND(addr, 1);
+    int16_t spare;
+
+    if(lqi > TXPWR_LQI_MAX
+            || (RADIO_RSSI_NONE != rssi && rssi < TXPWR_RSSI_TARGET))
+        {
+            TXPWR_RAISE(d, 1);
+            return;
+        }
+
+    if(RADIO_RSSI_NONE == rssi)
+        {
+            spare = 0;
+        }
+    else if(rssi >= TXPWR_RSSI_TARGET + TXPWR_RSSI_HYST)
+        {
+            spare = rssi - (TXPWR_RSSI_TARGET + TXPWR_RSSI_HYST);
+        }
+    else
+        {
+            // Within the hysteresis band: hold the level
+            d->good = 0;
+            return;
+        }
+
+    if(++d->good < TXPWR_DOWN_AFTER || !d->level)
+        {
+            return;
+        }
+    d->good = 0;
+
+    // One step down is always covered by the hysteresis, further steps by
+    //	the RSSI to spare.
+    d->level--;
+    while(d->level
+            && RADIO_TX_LEVEL_DBM(d->level) - RADIO_TX_LEVEL_DBM(d->level - 1) <= spare)
+        {
+            spare -= RADIO_TX_LEVEL_DBM(d->level) - RADIO_TX_LEVEL_DBM(d->level - 1);
+            d->level--;
+        }
+}
+
+/**
+ * Report a packet to addr lost, e.g. no acknowledgement arrived.
+ *
+ * @param addr the destination device address
+ */
+void TXPWR_LINK_FAIL( uint8_t addr )
+{
+    TXPWR_RAISE(TXPWR_FIND(addr, 1), TXPWR_UP_STEP);
+}
+
+/**
+ * Report the outcome of a RADIO_TX to addr, from the ARQ: every retry counts
+ * as a lost packet, and the ACK carries the RSSI/LQI the packet arrived
+ * with. Without RADIO_USE_ARQ, and for broadcasts, nothing is known.
+ *
+ * @param addr the destination device address
+ * @param rc the RADIO_TX status
+ */
+void TXPWR_REPORT_TX( uint8_t addr, int16_t rc )
+{
+#if(RADIO_USE_ARQ)
+    uint8_t retries;
+    int8_t rssi;
+    uint8_t lqi;
+
+    if(RADIO_IS_BROADCAST(addr)
+            || (RADIO_SUCCESS != rc && RADIO_NO_ACK != rc))
+        {
+            return;
+        }
+
+    for(retries = RADIO_TX_RETRIES(&rssi, &lqi); retries; retries--)
+        {
+            TXPWR_LINK_FAIL(addr);
+        }
+
+    if(RADIO_SUCCESS == rc)
+        {
+            TXPWR_LINK_OK(addr, rssi, lqi);
+        }
+    else
+        {
+            TXPWR_LINK_FAIL(addr);
+        }
+#endif
+}
+
+/**
+ * Look up the entry for addr.
+ *
+ * @param addr the destination device address
+ * @param add non-zero to start a new entry at RADIO_PWR_MAX if addr is not
+ *			tracked, replacing an old one if the table is full
+ * @return The entry, or 0 if addr is not tracked and add is zero.
+ */
+TXPWR_dest_t* TXPWR_FIND( uint8_t addr, uint8_t add )
+{
+    TXPWR_dest_t* d;
+    uint8_t i;
+
+    for(i = 0; i < TXPWR_count; i++)
+        {
+            if(TXPWR_dests[i].addr == addr)
+                {
+                    return &TXPWR_dests[i];
+                }
+        }
+
+    if(!add)
+        {
+            return 0;
+        }
+
+    if(TXPWR_count < TXPWR_DESTS)
+        {
+            d = &TXPWR_dests[TXPWR_count++];
+        }
+    else
+        {
+            d = &TXPWR_dests[TXPWR_victim];
+            TXPWR_victim = (TXPWR_victim + 1) % TXPWR_DESTS;
+        }
+
+    d->addr = addr;
+    d->level = RADIO_PWR_MAX;
+    d->good = 0;
+
+    return d;
+}
+
+/**
+ * Raise the level of an entry, at most to RADIO_PWR_MAX.
+ */
+void TXPWR_RAISE( TXPWR_dest_t* d, uint8_t steps )
+{
+    d->level = (d->level + steps > RADIO_PWR_MAX) ? RADIO_PWR_MAX : d->level + steps;
+    d->good = 0;
+}
+
+///////////////////////////////////////////////////////////////////////////////
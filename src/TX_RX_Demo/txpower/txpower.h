@@ -0,0 +1,51 @@
+/**
+ * @brief Closed-loop transmit power control on top of the radio power ladder.
+ *
+ * Keeps a transmit power level per destination, lowered while the link to it
+ * reports margin to spare (RSSI/LQI at the far end, or delivery alone) and
+ * raised when the link weakens or a packet is lost. Nodes close to their
+ * receiver then spend far less current on the air than at full power.
+ *
+ * @file txpower.h
+ * @author Aaron Parks, UW Sensor Systems Laboratory
+ * @version 1.0
+
+ */
+
+/*---------------------Include Guard-----------------------------------------*/
+#ifndef TXPWR_H
+#define TXPWR_H
+/*---------------------------------------------------------------------------*/
+
+///////////////////////////////////////////////////////////////////////////////
+/// Includes
+///////////////////////////////////////////////////////////////////////////////
+#include "../config/config.h"// Platform-specific definitions
+#include "../radio/radio.h"	// Radio functions and return status definitions
+#include <stdint.h>			// Data type definitions
+
+#if(TXPWR_RSSI_HYST < 2)
+#error "TXPWR_RSSI_HYST must cover one power ladder step (2 dB)"
+#endif
+
+///////////////////////////////////////////////////////////////////////////////
+/// Prototypes
+///////////////////////////////////////////////////////////////////////////////
+
+// Forget every destination; all start again at RADIO_PWR_MAX
+void TXPWR_INIT( void );
+// Power ladder level currently chosen for addr
+uint8_t TXPWR_LEVEL( uint8_t addr );
+// Set the radio to the level chosen for addr, before sending to it
+int16_t TXPWR_APPLY( uint8_t addr );
+// Report a packet delivered to addr, with the RSSI/LQI it arrived with
+void TXPWR_LINK_OK( uint8_t addr, int8_t rssi, uint8_t lqi );
+// Report a packet to addr lost
+void TXPWR_LINK_FAIL( uint8_t addr );
+// Report the acknowledgement outcome of a RADIO_TX to addr (RADIO_USE_ARQ)
+void TXPWR_REPORT_TX( uint8_t addr, int16_t rc );
+
+
+///////////////////////////////////////////////////////////////////////////////
+#endif /* TXPWR_H */
+///////////////////////////////////////////////////////////////////////////////
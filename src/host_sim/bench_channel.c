@@ -0,0 +1,364 @@
+/**
+ * @brief Multi-node delivery benchmark on a shared simulated channel
+ *
+ * One receiver runs the demoReceiver.c path (HAL, BSP, UART, RADIO_INIT,
+ * RADIO_SETUP_RX, GDO ISR, callback with UART forwarding and cached
+ * recalibration, WDT recalibration) on the simulated MCU. The transmitters
+ * are modeled by the channel (channel_sim.c) rather than run as separate MCU
+ * instances: their frame timing, frame contents and energy per frame are
+ * first profiled by running the demoTransmitter.c loop (samples batched with
+ * BATCH_ADD, power set by TXPWR, HAL_SLEEP_MS between samples) on the
+ * simulator, then replayed for every node with its own VLO error, start
+ * phase and signal level.
+ *
+ * Reports offered and delivered packets per second, loss rate and energy per
+ * delivered packet as the node count and the sampling period change.
+ * With RADIO_USE_ARQ the profiled transmitter is acknowledged, but the
+ * replayed nodes don't ask for ACKs: the channel has no retransmissions.
+ *
+ * Usage: bench_channel [seconds] [ber] [seed]
+ *
+ * @file bench_channel.c
+ * @author Aaron Parks, UW Sensor Systems Laboratory
+ * @version 1.0
+ */
+
+///////////////////////////////////////////////////////////////////////////////
+/// Includes
+///////////////////////////////////////////////////////////////////////////////
+#include "sim.h"
+#include "channel_sim.h"
+#include "../TX_RX_Demo/hal/hal.h"
+#include "../TX_RX_Demo/radio/radio.h"
+#include "../TX_RX_Demo/batch/batch.h"
+#include "../TX_RX_Demo/txpower/txpower.h"
+#include "../TX_RX_Demo/sensor_id.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+///////////////////////////////////////////////////////////////////////////////
+/// Definitions
+///////////////////////////////////////////////////////////////////////////////
+#define BENCH_PROFILE_FRAMES	8		// Transmitter frames averaged per profile
+#define BENCH_VLO_TOL			0.10	// Spread of the transmitters' VLO clocks
+#define BENCH_DBM_MIN			(-80)	// Received level range of transmitters
+#define BENCH_DBM_MAX			(-40)
+#define BENCH_USE_RX_ID			RADIO_DEV_ID	// As USE_RX_ID in demoTransmitter.c
+#define BENCH_MAX_LATENCY		10000ul	// As MAX_LATENCY in demoTransmitter.c (ms)
+#define BENCH_ACK_DELAY_US		400		// Receiver turnaround before an ACK
+#define WDT_ACLK_TICKS			32768u	// As in demoReceiver.c
+
+/**
+ * Cost of the demoTransmitter.c loop iterations that make up one frame,
+ * measured on the simulator.
+ */
+typedef struct BENCH_profile_s
+{
+    uint64_t	period;		// Frame period (ps)
+    uint64_t	offset;		// First sample of the batch to frame start (ps)
+    double		energyNj;	// MCU + radio energy per frame
+    SIM_frame_t	frame;		// Frame as sent
+} BENCH_profile_t;
+
+///////////////////////////////////////////////////////////////////////////////
+/// Globals
+///////////////////////////////////////////////////////////////////////////////
+static const uint16_t BENCH_SAMPLE_MS[] = {1000, 500, 250, 100};
+static const uint16_t BENCH_NODES[] = {1, 2, 5, 10, 20, 50, 100};
+
+SIM_frame_t	BENCH_lastTx;
+uint8_t		BENCH_txSeen;
+uint8_t		BENCH_hdr[RADIO_LEN_FIELD + RADIO_HDR_LEN];	// Header of the replayed frames
+
+// Receiver application state, as in demoReceiver.c
+uint8_t		rxBuf[RADIO_PAY_LEN];
+uint8_t		msgBuf[2 * RADIO_PAY_LEN + 2];
+uint16_t	msgLen;
+uint8_t		calibrateSem;
+
+///////////////////////////////////////////////////////////////////////////////
+/// Prototypes
+///////////////////////////////////////////////////////////////////////////////
+void dataReceived( void );
+void calibrateAndRestartRX( uint8_t* inUse );
+
+///////////////////////////////////////////////////////////////////////////////
+
+static void BENCH_AIR_TX( SIM_cc2500_t* chip, const SIM_frame_t* frame )
+{
+#if(RADIO_USE_ARQ)
+    const uint8_t* hdr = &frame->data[RADIO_LEN_FIELD];
+    uint8_t ack[RADIO_LEN_FIELD + RADIO_ACK_LEN];
+
+    // Acknowledge as the receiver would, at a typical level
+    if(hdr[2] & RADIO_ARQ_REQ)
+        {
+#if(RADIO_VAR_LEN)
+            ack[0] = RADIO_ACK_LEN;
+#endif
+            ack[RADIO_LEN_FIELD] = hdr[1];
+            ack[RADIO_LEN_FIELD + 1] = hdr[0];
+            ack[RADIO_LEN_FIELD + 2] = RADIO_ARQ_ACK | (hdr[2] & RADIO_ARQ_SEQ_BM);
+#if(RADIO_RX_STATUS)
+            ack[RADIO_LEN_FIELD + RADIO_HDR_LEN] = (uint8_t)((BENCH_DBM_MAX + RADIO_RSSI_OFFSET) * 2);
+            ack[RADIO_LEN_FIELD + RADIO_HDR_LEN + 1] = 0x80 | 10;
+#endif
+            SIM_CC_REPLY(chip, frame, ack, sizeof(ack),
+                         (uint64_t)BENCH_ACK_DELAY_US * SIM_PS_PER_US, BENCH_DBM_MAX);
+        }
+#endif
+    BENCH_lastTx = *frame;
+    BENCH_txSeen = 1;
+}
+
+/**
+ * Run the demoTransmitter.c loop with the given sampling period and measure
+ * it per frame. Every BATCH_MAX_RECORDS samples make one frame, unless
+ * BENCH_MAX_LATENCY sends the batch earlier.
+ */
+static void BENCH_PROFILE( uint16_t sampleMs, BENCH_profile_t* p )
+{
+    uint8_t msg[BATCH_REC_LEN];
+    uint16_t tempValue;
+    uint16_t photoValue;
+    uint64_t start;
+    uint64_t batchStart = 0;
+    uint64_t offsets = 0;
+    double energy;
+    uint16_t frames = 0;
+
+    SIM_INIT();
+    memset(&SIM_CC_air, 0, sizeof(SIM_CC_air));
+    SIM_CC_air.tx = BENCH_AIR_TX;
+
+    HAL_INIT();
+    BSP_INIT();
+    RADIO_INIT();
+    TXPWR_INIT();
+    RADIO_SLEEP();
+    BATCH_INIT(BENCH_USE_RX_ID);
+    BATCH_SET_SIZE(BATCH_MAX_RECORDS);
+    BATCH_SET_LATENCY(BENCH_MAX_LATENCY);
+    HAL_ADC_INIT();
+    HAL_ADC_CHANNEL_SELECT(BSP_INCH_TEMP);
+
+    start = SIM_now;
+    energy = SIM_stats.energyNj + SIM_radio.stats.energyNj;
+
+    while(frames < BENCH_PROFILE_FRAMES)
+        {
+            if(!BATCH_PENDING())
+                {
+                    batchStart = SIM_now;
+                }
+            BENCH_txSeen = 0;
+
+            HAL_ADC_CHANNEL_SELECT(BSP_INCH_TEMP);
+            tempValue = HAL_ADC_SAMPLE();
+            BSP_PHOTO_ENABLE();
+            HAL_PRECISE_DELAY(1);
+            HAL_ADC_CHANNEL_SELECT(BSP_INCH_PHOTO);
+            photoValue = HAL_ADC_SAMPLE();
+            BSP_PHOTO_DISABLE();
+
+            msg[0] = SENSOR_ID_TEMP;
+            msg[1] = (uint8_t)(tempValue >> 8) & 0x03u;
+            msg[2] = tempValue & 0xFFu;
+            msg[3] = SENSOR_ID_PHOTO;
+            msg[4] = (uint8_t)(photoValue >> 8) & 0x03u;
+            msg[5] = photoValue & 0xFFu;
+
+            BATCH_ADD(msg, sampleMs);
+
+            BSP_LDO_HOLD_POUT &= ~BSP_LDO_HOLD_BIT;
+            HAL_SLEEP_MS(sampleMs);
+            BSP_LDO_HOLD_POUT |= BSP_LDO_HOLD_BIT;
+
+            if(BENCH_txSeen)
+                {
+                    offsets += BENCH_lastTx.start - batchStart;
+                    frames++;
+                }
+            else if(!BATCH_PENDING())
+                {
+                    fprintf(stderr, "bench: transmitter sent no frame\n");
+                    exit(1);
+                }
+        }
+
+    p->period = (SIM_now - start) / BENCH_PROFILE_FRAMES;
+    p->offset = offsets / BENCH_PROFILE_FRAMES;
+    p->energyNj = (SIM_stats.energyNj + SIM_radio.stats.energyNj - energy) / BENCH_PROFILE_FRAMES;
+    p->frame = BENCH_lastTx;
+}
+
+/**
+ * Bring up the receiver exactly as demoReceiver.c does.
+ */
+static void BENCH_RECEIVER_INIT( void )
+{
+    calibrateSem = 0;
+
+    HAL_INIT();
+    BSP_INIT();
+    HAL_UART_INIT();
+    RADIO_INIT();
+    HAL_ADC_INIT();
+    HAL_ADC_CHANNEL_SELECT(BSP_INCH_TEMP);
+    RADIO_CALIBRATE_CACHED(HAL_ADC_SAMPLE());
+    RADIO_SETUP_RX(&dataReceived);
+
+    WDTCTL = WDT_ADLY_1000 | WDTPW;
+    IFG1 &= ~WDTIFG;
+    IE1 |= WDTIE;
+}
+
+int main( int argc, char** argv )
+{
+    double seconds = (argc > 1) ? atof(argv[1]) : 60.0;
+    double ber = (argc > 2) ? atof(argv[2]) : 1e-4;
+    uint32_t seed = (argc > 3) ? (uint32_t)strtoul(argv[3], NULL, 0) : 1;
+    BENCH_profile_t prof;
+    SIM_chan_cfg_t cfg;
+    uint64_t t0;
+    double rxEnergy;
+    double sent;
+    double deliv;
+    uint8_t d;
+    uint8_t n;
+
+    printf("%.0f s per point, post-FEC BER %.1e, VLO spread +/-%.0f%%, "
+           "levels %d..%d dBm\n\n", seconds, ber, BENCH_VLO_TOL * 100,
+           BENCH_DBM_MIN, BENCH_DBM_MAX);
+    printf("%6s %9s %5s %9s %9s %6s %6s %6s %6s %6s %11s %11s\n",
+           "smp_ms", "period_ms", "nodes", "offered/s", "deliv/s", "loss%",
+           "coll", "biterr", "rxlost", "bad", "tx_mJ/pkt", "rx_mJ/pkt");
+
+    for(d = 0; d < sizeof(BENCH_SAMPLE_MS) / sizeof(BENCH_SAMPLE_MS[0]); d++)
+        {
+            BENCH_PROFILE(BENCH_SAMPLE_MS[d], &prof);
+
+            for(n = 0; n < sizeof(BENCH_NODES) / sizeof(BENCH_NODES[0]); n++)
+                {
+                    SIM_INIT();
+                    BENCH_RECEIVER_INIT();
+
+                    memset(&cfg, 0, sizeof(cfg));
+                    cfg.nodes = BENCH_NODES[n];
+                    cfg.period = prof.period;
+                    cfg.periodTol = BENCH_VLO_TOL;
+                    cfg.ber = ber;
+                    cfg.dbmMin = BENCH_DBM_MIN;
+                    cfg.dbmMax = BENCH_DBM_MAX;
+                    cfg.seed = seed;
+                    cfg.tmpl = prof.frame;
+#if(RADIO_USE_ARQ)
+                    cfg.tmpl.data[RADIO_LEN_FIELD + 2] &= ~RADIO_ARQ_REQ;
+#endif
+                    memcpy(BENCH_hdr, cfg.tmpl.data, sizeof(BENCH_hdr));
+                    cfg.idPos = RADIO_LEN_FIELD + RADIO_HDR_LEN;
+                    SIM_CHAN_INIT(&cfg);
+
+                    t0 = SIM_now;
+                    rxEnergy = SIM_stats.energyNj + SIM_radio.stats.energyNj;
+                    SIM_CHAN_RUN_UNTIL(t0 + (uint64_t)(seconds * SIM_PS_PER_S));
+                    rxEnergy = SIM_stats.energyNj + SIM_radio.stats.energyNj - rxEnergy;
+
+                    sent = SIM_CHAN_stats.sent;
+                    deliv = SIM_CHAN_stats.delivered;
+
+                    printf("%6u %9.1f %5u %9.2f %9.2f %6.1f %6lu %6lu %6lu %6lu %11.3f %11.3f\n",
+                           BENCH_SAMPLE_MS[d], prof.period / (double)SIM_PS_PER_MS,
+                           BENCH_NODES[n], sent / seconds, deliv / seconds,
+                           sent ? 100.0 * (1.0 - deliv / sent) : 0.0,
+                           (unsigned long)SIM_CHAN_stats.collided,
+                           (unsigned long)SIM_CHAN_stats.bitErrors,
+                           (unsigned long)(SIM_CHAN_stats.sent - SIM_CHAN_stats.delivered
+                                           - SIM_CHAN_stats.collided - SIM_CHAN_stats.bitErrors),
+                           (unsigned long)SIM_CHAN_stats.corrupt,
+                           deliv ? sent * prof.energyNj / deliv / 1e6 : 0.0,
+                           deliv ? rxEnergy / deliv / 1e6 : 0.0);
+                    fflush(stdout);
+                }
+        }
+
+    return 0;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// Receiver application (from demoReceiver.c)
+///////////////////////////////////////////////////////////////////////////////
+
+/**
+ * A packet has been received. Forward it over the UART and restart RX.
+ */
+void dataReceived( void )
+{
+    uint8_t addr;
+    uint8_t frame[RADIO_LEN_FIELD + RADIO_PKT_LEN];
+    int8_t rssi;
+    uint8_t lqi;
+    uint16_t len;
+
+    BSP_LED0_TOGGLE();
+
+    while((len = RADIO_RECEIVE(rxBuf, &addr, &rssi, &lqi)))
+        {
+            if(RADIO_DEV_ID == addr)
+                {
+                    BSP_LED1_TOGGLE();
+                }
+
+            msgLen = HAL_UART_FORMATTER(msgBuf, rxBuf, len);
+            HAL_UART_TX(msgBuf, msgLen);
+
+            // Rebuild the frame data as sent for the channel's check
+            memcpy(frame, BENCH_hdr, sizeof(BENCH_hdr));
+            frame[0] = RADIO_HDR_LEN + len;
+            frame[RADIO_LEN_FIELD] = addr;
+            memcpy(&frame[RADIO_LEN_FIELD + RADIO_HDR_LEN], rxBuf, len);
+            SIM_CHAN_DELIVER(frame, RADIO_LEN_FIELD + RADIO_HDR_LEN + len);
+        }
+
+    calibrateAndRestartRX(&calibrateSem);
+}
+
+#pragma vector=WDT_VECTOR
+__interrupt void WDT_ISR( void )
+{
+    HAL_VLO_ELAPSED(WDT_ACLK_TICKS);
+    calibrateAndRestartRX(&calibrateSem);
+    IFG1 &= ~WDTIFG;
+}
+
+void calibrateAndRestartRX( uint8_t* inUse )
+{
+    uint16_t temp;
+    uint8_t vlo;
+
+    if(*inUse)
+        {
+            return;
+        }
+
+    *inUse = 1;
+
+    temp = HAL_ADC_SAMPLE();
+    vlo = HAL_VLO_ELAPSED(0);
+    if(vlo || !RADIO_CAL_VALID(temp))
+        {
+            RADIO_IDLE();
+            if(vlo)
+                {
+                    HAL_VLO_CALIBRATE();
+                }
+            if(!RADIO_CAL_VALID(temp))
+                {
+                    RADIO_CALIBRATE_CACHED(temp);
+                }
+            RADIO_RX_POLL();
+        }
+
+    *inUse = 0;
+}
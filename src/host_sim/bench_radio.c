@@ -0,0 +1,1068 @@
+/**
+ * @brief Per-packet cost baseline for the radio stack, run on the host
+ *			simulator.
+ *
+ * Drives the unmodified HAL and radio sources through the same sequence as
+ * demoTransmitter.c, then loops the transmitted frame back into the radio to
+ * exercise the receive path (RADIO_GDO_ISR, RADIO_RECEIVE). For each
+ * operation it reports SPI transactions and bytes, command strobes, ~CS low
+ * time, MCU active time and MCU/radio energy.
+ *
+ * @file bench_radio.c
+ * @author Aaron Parks, UW Sensor Systems Laboratory
+ * @version 1.0
+ */
+
+///////////////////////////////////////////////////////////////////////////////
+/// Includes
+///////////////////////////////////////////////////////////////////////////////
+#include "sim.h"
+#include "../TX_RX_Demo/hal/hal.h"
+#include "../TX_RX_Demo/radio/radio.h"
+#include "../TX_RX_Demo/batch/batch.h"
+#include "../TX_RX_Demo/txpower/txpower.h"
+#include <stdio.h>
+#include <string.h>
+
+///////////////////////////////////////////////////////////////////////////////
+/// Definitions
+///////////////////////////////////////////////////////////////////////////////
+#define BENCH_PACKETS		64		// Packets per measurement
+#define BENCH_RX_DBM		(-50)	// Signal level of looped-back frames
+#define BENCH_WOR_LATENCY	250		// Wake-on-Radio latency target (ms)
+#define BENCH_WOR_GAP_US	200		// Gap between repeated wake-up frames
+#define BENCH_IDLE_S		10		// Idle listening time per receive mode
+#define BENCH_BUSY_SLOT_US	2000	// Granularity of the simulated interferer
+#define BENCH_BUSY_PCT		50		// Share of slots the interferer is on air
+#define BENCH_NEAR_LOSS		50		// Path loss to a receiver a few metres away (dB)
+#define BENCH_FAR_LOSS		80		// Path loss after the link is obstructed (dB)
+#define BENCH_EDGE_LOSS		86		// Path loss beyond the reach of 500 kBaud (dB)
+#define BENCH_RANGE_LOSS	96		// Path loss beyond the reach of 250 kBaud (dB)
+#define BENCH_ACK_DELAY_US	400		// Receiver turnaround before an ACK
+#define BENCH_ACK_DROP_PCT	30		// Share of ACKs lost in the ARQ measurement
+#define BENCH_RX_WAIT_MS	2		// Wait after a looped-back frame (and its ACK)
+#define BENCH_TEMP_SWING	20		// Chip temperature rise over half a swing (C)
+#define BENCH_WORK_CYCLES	200		// MCU work overlapped with a submitted SPI transfer
+#define BENCH_DELAY_TICKS	24		// HAL_PRECISE_DELAY of a calibration (732 us)
+#define BENCH_VLO_DRIFT_HZ	10000	// VLO after drifting from 12 kHz
+#define BENCH_VLO_FAST_HZ	12600	// VLO 5% fast, as it may drift between calibrations
+#define BENCH_WDT_TICKS		32768u	// WDT_ADLY_1000 interval, as in demoReceiver.c
+
+/**
+ * Snapshot of every cumulative counter.
+ */
+typedef struct BENCH_snap_s
+{
+    uint64_t		t;
+    SIM_mcu_stats_t	mcu;
+    SIM_cc_stats_t	cc;
+} BENCH_snap_t;
+
+///////////////////////////////////////////////////////////////////////////////
+/// Globals
+///////////////////////////////////////////////////////////////////////////////
+SIM_frame_t	BENCH_lastTx;		// Last frame the radio put on the air
+uint16_t	BENCH_rxCount;		// Payloads delivered to the application
+uint64_t	BENCH_rxAt;			// Time of the last delivery
+int8_t		BENCH_rxRssi;		// Signal strength reported with the last delivery
+uint8_t		BENCH_rxBuf[RADIO_PAY_LEN];
+#if(RADIO_USE_ARQ)
+uint8_t		BENCH_loss;			// Path loss to the emulated receiver (dB)
+uint8_t		BENCH_ackDropPct;	// Share of its ACKs lost
+uint32_t	BENCH_ackRand = 1;	// ACK loss generator
+uint32_t	BENCH_acksSent;		// ACKs the radio put on the air
+uint64_t	BENCH_ackAt;		// Start of the last one
+uint8_t		BENCH_seq;			// Sequence number of looped-back frames
+#endif
+
+// Register settings of radio_register_map.h, included by radio.c only
+extern const uint8_t RADIO_REG_SETTINGS[];
+extern const uint8_t RADIO_REG_RUNS[];
+
+///////////////////////////////////////////////////////////////////////////////
+
+static void BENCH_SNAP( BENCH_snap_t* s )
+{
+    s->t = SIM_now;
+    s->mcu = SIM_stats;
+    s->cc = SIM_radio.stats;
+}
+
+static void BENCH_HEADER( void )
+{
+    printf("%-22s %8s %9s %7s %7s %6s %9s %6s %9s %9s\n",
+           "operation", "wall_us", "active_us", "spi_txn", "spi_B", "strobe",
+           "cs_lo_us", "irqs", "mcu_uJ", "radio_uJ");
+}
+
+/**
+ * Print per-operation averages between two snapshots.
+ */
+static void BENCH_PRINT( const char* name, const BENCH_snap_t* a,
+                         const BENCH_snap_t* b, uint32_t n )
+{
+    double k = 1.0 / n;
+
+    printf("%-22s %8.1f %9.1f %7.2f %7.2f %6.2f %9.1f %6.2f %9.3f %9.3f\n",
+           name,
+           (b->t - a->t) * k / SIM_PS_PER_US,
+           (b->mcu.modePs[SIM_MODE_ACTIVE] - a->mcu.modePs[SIM_MODE_ACTIVE]) * k / SIM_PS_PER_US,
+           (b->cc.spiTxns - a->cc.spiTxns) * k,
+           (b->cc.spiBytes - a->cc.spiBytes) * k,
+           (b->cc.strobes - a->cc.strobes) * k,
+           (b->cc.csLowPs - a->cc.csLowPs) * k / SIM_PS_PER_US,
+           (b->mcu.irqs - a->mcu.irqs) * k,
+           (b->mcu.energyNj - a->mcu.energyNj) * k / 1000.0,
+           (b->cc.energyNj - a->cc.energyNj) * k / 1000.0);
+}
+
+/**
+ * Print the time the radio spent in each power group between two snapshots.
+ */
+static void BENCH_STATES( const char* name, const BENCH_snap_t* a,
+                          const BENCH_snap_t* b, uint32_t n )
+{
+    static const char* grp[SIM_CC_PWR_COUNT] = {"sleep", "xoff", "idle", "fs", "rx", "tx"};
+    uint8_t i;
+
+    printf("  %s radio state (us/op):", name);
+    for(i = 0; i < SIM_CC_PWR_COUNT; i++)
+        {
+            printf(" %s=%.1f", grp[i],
+                   (b->cc.statePs[i] - a->cc.statePs[i]) / (double)n / SIM_PS_PER_US);
+        }
+    printf("\n");
+}
+
+/**
+ * Channel hook: remember the frame just transmitted. With RADIO_USE_ARQ, a
+ * receiver BENCH_loss dB away acknowledges it if it can hear it, and ACKs
+ * sent by the radio are only counted.
+ */
+static void BENCH_AIR_TX( SIM_cc2500_t* chip, const SIM_frame_t* frame )
+{
+#if(RADIO_USE_ARQ)
+    const uint8_t* hdr = &frame->data[RADIO_LEN_FIELD];
+    uint8_t ack[RADIO_LEN_FIELD + RADIO_ACK_LEN];
+    int8_t rssi = frame->dbm - BENCH_loss;
+
+    if(hdr[2] & RADIO_ARQ_ACK)
+        {
+            BENCH_acksSent++;
+            BENCH_ackAt = frame->start;
+            return;
+        }
+
+    BENCH_ackRand = BENCH_ackRand * 1103515245 + 12345;
+    if((hdr[2] & RADIO_ARQ_REQ) && rssi >= SIM_CC_SENS_DBM(frame->baud)
+            && (BENCH_ackRand >> 8) % 100 >= BENCH_ackDropPct)
+        {
+#if(RADIO_VAR_LEN)
+            ack[0] = RADIO_ACK_LEN;
+#endif
+            ack[RADIO_LEN_FIELD] = hdr[1];
+            ack[RADIO_LEN_FIELD + 1] = hdr[0];
+            ack[RADIO_LEN_FIELD + 2] = RADIO_ARQ_ACK | (hdr[2] & RADIO_ARQ_SEQ_BM);
+#if(RADIO_RX_STATUS)
+            ack[RADIO_LEN_FIELD + RADIO_HDR_LEN] = (uint8_t)((rssi + RADIO_RSSI_OFFSET) * 2);
+            ack[RADIO_LEN_FIELD + RADIO_HDR_LEN + 1] = 0x80 | 10;
+#endif
+            SIM_CC_REPLY(chip, frame, ack, sizeof(ack),
+                         (uint64_t)BENCH_ACK_DELAY_US * SIM_PS_PER_US, BENCH_RX_DBM);
+        }
+#endif
+    BENCH_lastTx = *frame;
+}
+
+/**
+ * Receive callback, as in demoReceiver.c.
+ */
+static void BENCH_RX_CB( void )
+{
+    uint8_t addr;
+    int8_t rssi;
+    uint8_t lqi;
+
+    // The radio has already dropped frames for other networks and devices
+    if(RADIO_RECEIVE(BENCH_rxBuf, &addr, &rssi, &lqi))
+        {
+            BENCH_rxCount++;
+            BENCH_rxAt = SIM_now;
+            BENCH_rxRssi = rssi;
+        }
+}
+
+/**
+ * Loop a copy of a transmitted frame back into the radio at time t.
+ */
+static void BENCH_LOOPBACK( const SIM_frame_t* src, uint64_t t )
+{
+    SIM_frame_t f = *src;
+
+    f.start = t;
+    f.syncEnd = f.start + (src->syncEnd - src->start);
+    f.end = f.start + (src->end - src->start);
+    f.dbm = BENCH_RX_DBM;
+    f.lqi = 10;
+#if(RADIO_USE_ARQ)
+    // A new packet each time, not a resent one
+    f.data[RADIO_LEN_FIELD + 2] = (f.data[RADIO_LEN_FIELD + 2] & ~RADIO_ARQ_SEQ_BM)
+                                  | (++BENCH_seq & RADIO_ARQ_SEQ_BM);
+#endif
+    SIM_CC_RX_FRAME(&SIM_radio, &f);
+}
+
+/**
+ * Send one packet as BATCH_FLUSH does over a link with the given path loss,
+ * and report the outcome to the power control loop as an acknowledgement
+ * would (with RADIO_USE_ARQ, as the acknowledgement does). Returns the RSSI
+ * at the far end, or RADIO_RSSI_NONE if lost.
+ */
+static int8_t BENCH_PWR_SEND( uint8_t* msg, uint8_t loss, uint8_t adapt )
+{
+#if(RADIO_USE_ARQ)
+    int16_t rc;
+#else
+    int8_t rssi;
+#endif
+
+    RADIO_CALIBRATE();
+    if(adapt)
+        {
+            TXPWR_APPLY(RADIO_DEV_ID);
+        }
+    else
+        {
+            RADIO_SET_TX_LEVEL(RADIO_PWR_MAX);
+        }
+#if(RADIO_USE_ARQ)
+    BENCH_loss = loss;
+    rc = RADIO_TX(RADIO_DEV_ID, msg, RADIO_PAY_LEN);
+    RADIO_SLEEP();
+    BENCH_loss = 0;
+
+    TXPWR_REPORT_TX(RADIO_DEV_ID, rc);
+    return (RADIO_SUCCESS == rc) ? BENCH_lastTx.dbm - loss : RADIO_RSSI_NONE;
+#else
+    RADIO_TX(RADIO_DEV_ID, msg, RADIO_PAY_LEN);
+    RADIO_SLEEP();
+
+    rssi = BENCH_lastTx.dbm - loss;
+    if(rssi < SIM_CC_SENS_DBM(BENCH_lastTx.baud))
+        {
+            TXPWR_LINK_FAIL(RADIO_DEV_ID);
+            return RADIO_RSSI_NONE;
+        }
+
+    TXPWR_LINK_OK(RADIO_DEV_ID, rssi, 10);
+    return rssi;
+#endif
+}
+
+#if(RADIO_TX_CCA)
+/**
+ * Signal level seen by the radio: an interferer occupying a pseudo-random
+ * BENCH_BUSY_PCT of the time slots.
+ */
+static int8_t BENCH_BUSY_RSSI( SIM_cc2500_t* chip, uint64_t t )
+{
+    uint32_t h = (uint32_t)(t / (BENCH_BUSY_SLOT_US * SIM_PS_PER_US)) * 2654435761u;
+
+    return ((h >> 16) % 100 < BENCH_BUSY_PCT) ? BENCH_RX_DBM : -110;
+}
+#endif
+
+/**
+ * Print the mean radio current between two snapshots.
+ */
+static void BENCH_IDLE_CURRENT( const char* name, const BENCH_snap_t* a,
+                                const BENCH_snap_t* b )
+{
+    printf("  %s: radio %.1f uA, MCU %.1f uA\n", name,
+           (b->cc.energyNj - a->cc.energyNj) / 3.0 / ((b->t - a->t) / 1e12) / 1000.0,
+           (b->mcu.energyNj - a->mcu.energyNj) / 3.0 / ((b->t - a->t) / 1e12) / 1000.0);
+}
+
+int main( void )
+{
+    BENCH_snap_t s0, s1, s2, s3;
+    uint8_t msg[RADIO_PAY_LEN];
+    uint8_t calScheduler = 0;
+    uint64_t txActivePs = 0;
+    uint32_t frames0;
+    double cycleNj;
+    uint64_t airPs;
+    uint64_t latencyPs = 0;
+    uint64_t latencyMax = 0;
+    uint64_t start;
+    uint64_t t;
+    uint32_t prng = 1;
+    uint32_t i;
+    uint16_t event0;
+    uint16_t caught = 0;
+    SIM_frame_t foreign;
+    double txNj[3];
+    uint16_t delivered;
+    uint8_t k;
+    uint8_t level;
+    uint32_t d;
+    uint64_t calPs;
+    double calNj;
+    uint16_t visits[256];
+    uint16_t wrong;
+    uint8_t regs[CC2500_TEST0 + 1];
+    uint8_t rd[CC2500_TEST0 + 1];
+    HAL_SPI_xfer_t xfer;
+    static const uint8_t spiDiv[2] = {1, 4};
+    const uint8_t* run;
+    uint16_t runs;
+    uint16_t bytes;
+    static const char* profiles[RADIO_PROFILES] = {"10K", "250K", "500K"};
+    static const uint8_t losses[3] = {BENCH_NEAR_LOSS, BENCH_EDGE_LOSS, BENCH_RANGE_LOSS};
+    static const uint8_t order[RADIO_PROFILES] = {RADIO_PROFILE_500K, RADIO_PROFILE_10K, RADIO_PROFILE_250K};
+    char name[32];
+    uint8_t j;
+    uint16_t aclkHz;
+    static const uint32_t vloHz[3] = {4000, 12000, 20000};
+#if(!RADIO_USE_ARQ)
+    uint8_t ie;
+#endif
+#if(RADIO_TX_CCA || RADIO_USE_ARQ)
+    uint16_t frames;
+    RADIO_tx_stats_t txStats;
+#endif
+#if(RADIO_USE_ARQ)
+    RADIO_tx_stats_t txStats0;
+    uint32_t acks0;
+    uint64_t ackPs = 0;
+#endif
+
+    SIM_INIT();
+    SIM_CC_air.tx = BENCH_AIR_TX;
+
+    HAL_INIT();
+    BSP_INIT();
+
+    //------------------------------------------------------------------------
+    // Initialization
+    BENCH_SNAP(&s0);
+    RADIO_INIT();
+    BENCH_SNAP(&s1);
+
+    printf("CC2500 %lu baud, %u byte packet, %.1f us on air\n\n",
+           (unsigned long)SIM_CC_BAUD(&SIM_radio), (unsigned)(RADIO_LEN_FIELD + RADIO_PKT_LEN),
+           SIM_CC_AIRTIME(&SIM_radio, RADIO_LEN_FIELD + RADIO_PKT_LEN) / (double)SIM_PS_PER_US);
+
+    BENCH_HEADER();
+    BENCH_PRINT("RADIO_INIT", &s0, &s1, 1);
+
+    // The differential settings against the full burst they replaced, which
+    //	must leave the same registers behind
+    memcpy(regs, SIM_radio.reg, sizeof(regs));
+    BENCH_SNAP(&s0);
+    HAL_SPI_STROBE(CC2500_SRES, 0);
+    while(BSP_SPI_PIN & BSP_SPI_SOMI_BIT);
+    HAL_SPI_WRITE(CC2500_WRITE_BURST, (uint8_t*)RADIO_REG_SETTINGS, sizeof(regs), 0);
+    BENCH_SNAP(&s1);
+    BENCH_PRINT("Reset + full burst", &s0, &s1, 1);
+    runs = 0;
+    bytes = 0;
+    for(run = RADIO_REG_RUNS; *run; run += 2 + run[1])
+        {
+            runs++;
+            bytes += 1 + run[1];
+        }
+    printf("  settings: %u SPI bytes in %u bursts against %u, saving %u; registers %s\n",
+           bytes, runs, (unsigned)(1 + sizeof(regs)), (unsigned)(1 + sizeof(regs) - bytes),
+           memcmp(regs, SIM_radio.reg, sizeof(regs)) ? "DIFFER" : "match");
+
+    // SPI burst throughput: every configuration register written back and
+    //	read, timed by ~CS low
+    BENCH_SNAP(&s0);
+    HAL_SPI_WRITE(CC2500_WRITE_BURST, regs, sizeof(regs), 0);
+    BENCH_SNAP(&s1);
+    HAL_SPI_READ(CC2500_READ_BURST, regs, sizeof(regs), 0);
+    BENCH_SNAP(&s2);
+    printf("  %u byte burst: write %.1f us ~CS low (%.0f byte/s), read %.1f us (%.0f byte/s)\n",
+           (unsigned)(1 + sizeof(regs)),
+           (s1.cc.csLowPs - s0.cc.csLowPs) / (double)SIM_PS_PER_US,
+           (1 + sizeof(regs)) * (double)SIM_PS_PER_S / (s1.cc.csLowPs - s0.cc.csLowPs),
+           (s2.cc.csLowPs - s1.cc.csLowPs) / (double)SIM_PS_PER_US,
+           (1 + sizeof(regs)) * (double)SIM_PS_PER_S / (s2.cc.csLowPs - s1.cc.csLowPs));
+
+    // The same read polled, by the interrupt-driven engine in LPM1, and
+    //	submitted with other work done meanwhile, at the full SPI clock and
+    //	at a quarter of it
+    xfer.addr = CC2500_READ_BURST;
+    xfer.buf = rd;
+    xfer.len = sizeof(rd);
+    xfer.dir = HAL_SPI_XFER_READ;
+    xfer.dly = 0;
+    xfer.callback = 0;
+    for(j = 0; j < 2; j++)
+        {
+            UCB0CTL1 |= UCSWRST;
+            UCB0BR0 = spiDiv[j];
+            UCB0CTL1 &= ~UCSWRST;
+
+            wrong = 0;
+            BENCH_SNAP(&s0);
+            HAL_SPI_READ(CC2500_READ_BURST, rd, sizeof(rd), 0);
+            BENCH_SNAP(&s1);
+            wrong += memcmp(rd, regs, sizeof(rd)) != 0;
+            sprintf(name, "SPI read, polled /%u", spiDiv[j]);
+            BENCH_PRINT(name, &s0, &s1, 1);
+            calPs = s1.t - s0.t;
+
+            memset(rd, 0, sizeof(rd));
+            BENCH_SNAP(&s0);
+            HAL_SPI_XFER(&xfer);
+            BENCH_SNAP(&s2);
+            wrong += memcmp(rd, regs, sizeof(rd)) != 0;
+            sprintf(name, "SPI read, LPM1 /%u", spiDiv[j]);
+            BENCH_PRINT(name, &s0, &s2, 1);
+
+            memset(rd, 0, sizeof(rd));
+            BENCH_SNAP(&s2);
+            HAL_SPI_SUBMIT(&xfer);
+            __delay_cycles(BENCH_WORK_CYCLES);
+            HAL_SPI_XFER_WAIT();
+            BENCH_SNAP(&s3);
+            wrong += memcmp(rd, regs, sizeof(rd)) != 0;
+            sprintf(name, "SPI read + work /%u", spiDiv[j]);
+            BENCH_PRINT(name, &s2, &s3, 1);
+            printf("  %u cycles of work overlapped: %.1f us against %.1f us polled then work; data %s\n",
+                   BENCH_WORK_CYCLES, (s3.t - s2.t) / (double)SIM_PS_PER_US,
+                   calPs / (double)SIM_PS_PER_US + BENCH_WORK_CYCLES * 1e6 / SIM_MCLK_HZ(),
+                   wrong ? "DIFFERS" : "match");
+        }
+    UCB0CTL1 |= UCSWRST;
+    UCB0BR0 = 1;
+    UCB0CTL1 &= ~UCSWRST;
+
+    RADIO_SET_TX_PWR(0xFF);
+    RADIO_SLEEP();
+    HAL_ADC_INIT();
+
+    // Wake from SLEEP: RADIO_WAKE against the fixed ~CS delay it replaced
+    //	and against rebooting into RADIO_INIT
+    wrong = 0;
+    calPs = 0;
+    calNj = 0;
+    for(i = 0; i < BENCH_PACKETS; i++)
+        {
+            HAL_LONG_DELAY(120);
+            BENCH_SNAP(&s2);
+            RADIO_WAKE();
+            BENCH_SNAP(&s3);
+            calPs += s3.t - s2.t;
+            calNj += s3.mcu.energyNj - s2.mcu.energyNj + s3.cc.energyNj - s2.cc.energyNj;
+            wrong += (SIM_MARC_IDLE != SIM_radio.marc) || (0xFF != SIM_radio.patable[0]);
+            RADIO_SLEEP();
+        }
+    BENCH_PRINT("RADIO_WAKE", &s2, &s3, 1);
+    printf("  wake-to-ready %.1f us, %.3f uJ, idle with PATABLE restored %u/%u\n",
+           calPs / (double)BENCH_PACKETS / SIM_PS_PER_US, calNj / BENCH_PACKETS / 1000.0,
+           BENCH_PACKETS - wrong, BENCH_PACKETS);
+
+    BENCH_SNAP(&s0);
+    HAL_SPI_STROBE(CC2500_SIDLE, 5);
+    HAL_SPI_WRITE(CC2500_PATABLE, msg, 1, 0);
+    BENCH_SNAP(&s1);
+    BENCH_PRINT("Wake, fixed ~CS delay", &s0, &s1, 1);
+    HAL_SPI_STROBE(CC2500_SPWD, 0);
+
+    BENCH_SNAP(&s0);
+    RADIO_INIT();
+    RADIO_SET_TX_PWR(0xFF);
+    BENCH_SNAP(&s1);
+    BENCH_PRINT("Wake by RADIO_INIT", &s0, &s1, 1);
+    RADIO_SLEEP();
+
+    // HAL_PRECISE_DELAY emulated with cycles, as while the ACLK frequency is
+    //	not known, against sleeping in LPM3 on Timer_A at the measured rate
+    aclkHz = HAL_aclkHz;
+    for(j = 0; j < 2; j++)
+        {
+            HAL_aclkHz = j ? (BSP_HAS_XTAL ? 32768 : SIM_vloHz) : 0;
+            BENCH_SNAP(&s0);
+            HAL_PRECISE_DELAY(BENCH_DELAY_TICKS);
+            BENCH_SNAP(&s1);
+            BENCH_PRINT(j ? "Precise delay, LPM3" : "Precise delay, cycles", &s0, &s1, 1);
+        }
+    HAL_aclkHz = aclkHz;
+
+    //------------------------------------------------------------------------
+    // Transmit cycle, one sample per frame (demoTransmitter.c without batching)
+    BENCH_SNAP(&s0);
+    for(i = 0; i < BENCH_PACKETS; i++)
+        {
+            if(!calScheduler)
+                {
+                    RADIO_CALIBRATE();
+                    calScheduler = 3;
+                }
+            else
+                {
+                    calScheduler--;
+                }
+
+            HAL_ADC_CHANNEL_SELECT(BSP_INCH_TEMP);
+            msg[0] = (uint8_t)i;
+            msg[1] = 0;
+            msg[2] = (uint8_t)HAL_ADC_SAMPLE();
+            msg[3] = msg[4] = msg[5] = 0;
+
+            BENCH_SNAP(&s2);
+            RADIO_TX(RADIO_DEV_ID, msg, RADIO_PAY_LEN);
+            RADIO_SLEEP();
+            BENCH_SNAP(&s3);
+            txActivePs += s3.t - s2.t;
+
+            HAL_LONG_DELAY(12000);
+        }
+    BENCH_SNAP(&s1);
+
+    BENCH_PRINT("TX cycle (1/frame)", &s0, &s1, BENCH_PACKETS);
+    cycleNj = (s1.mcu.energyNj - s0.mcu.energyNj + s1.cc.energyNj - s0.cc.energyNj) / BENCH_PACKETS;
+    BENCH_STATES("TX cycle", &s0, &s1, BENCH_PACKETS);
+
+    // RADIO_TX alone, without the sleep
+    RADIO_CALIBRATE();
+    BENCH_SNAP(&s0);
+    RADIO_TX(RADIO_DEV_ID, msg, RADIO_PAY_LEN);
+    BENCH_SNAP(&s1);
+    SIM_IDLE_UNTIL(SIM_now + 5 * SIM_PS_PER_MS);
+    BENCH_PRINT("RADIO_TX call", &s0, &s1, 1);
+    printf("  frames sent %lu, underflows %lu, airtime %.1f us, TX+sleep %.1f us/pkt\n",
+           (unsigned long)SIM_radio.stats.txFrames,
+           (unsigned long)SIM_radio.stats.txUnderflows,
+           (BENCH_lastTx.end - BENCH_lastTx.start) / (double)SIM_PS_PER_US,
+           txActivePs / (double)BENCH_PACKETS / SIM_PS_PER_US);
+
+    //------------------------------------------------------------------------
+    // Transmit cycle with sample batching, as in demoTransmitter.c
+    RADIO_SLEEP();
+    BATCH_INIT(RADIO_DEV_ID);
+    frames0 = SIM_radio.stats.txFrames;
+    BENCH_SNAP(&s0);
+    for(i = 0; i < BENCH_PACKETS; i++)
+        {
+            HAL_ADC_CHANNEL_SELECT(BSP_INCH_TEMP);
+            msg[0] = (uint8_t)i;
+            msg[1] = 0;
+            msg[2] = (uint8_t)HAL_ADC_SAMPLE();
+            msg[3] = msg[4] = msg[5] = 0;
+
+            BATCH_ADD(msg, 12000);
+            HAL_LONG_DELAY(12000);
+        }
+    BENCH_SNAP(&s1);
+
+    BENCH_PRINT("TX cycle (batched)", &s0, &s1, BENCH_PACKETS);
+    BENCH_STATES("Batched", &s0, &s1, BENCH_PACKETS);
+    printf("  %u samples/frame: frames sent %lu, last count %u, energy/sample %.1f%% of 1/frame\n",
+           (unsigned)BATCH_MAX_RECORDS,
+           (unsigned long)(SIM_radio.stats.txFrames - frames0),
+           (unsigned)BENCH_lastTx.data[RADIO_LEN_FIELD + RADIO_HDR_LEN],
+           100.0 * (s1.mcu.energyNj - s0.mcu.energyNj + s1.cc.energyNj - s0.cc.energyNj)
+           / BENCH_PACKETS / cycleNj);
+
+    //------------------------------------------------------------------------
+    // Calibration on every wake while the chip warms from 25 C by
+    //	BENCH_TEMP_SWING and cools again, twice: calibrating every time, from
+    //	the calibration cache, and only once
+    printf("\n");
+    BENCH_HEADER();
+    for(k = 0; k < 3; k++)
+        {
+            RADIO_INIT();
+            RADIO_SLEEP();
+            calPs = 0;
+            calNj = 0;
+            BENCH_SNAP(&s0);
+            for(i = 0; i < BENCH_PACKETS; i++)
+                {
+                    d = i % (BENCH_PACKETS / 2);
+                    SIM_CC_tempC = 25 + BENCH_TEMP_SWING * ((d < BENCH_PACKETS / 4) ? d : BENCH_PACKETS / 2 - d)
+                                   / (BENCH_PACKETS / 4);
+
+                    HAL_ADC_CHANNEL_SELECT(BSP_INCH_TEMP);
+                    t = HAL_ADC_SAMPLE();
+                    BENCH_SNAP(&s2);
+                    if(1 == k)
+                        {
+                            RADIO_CALIBRATE_CACHED((uint16_t)t);
+                        }
+                    else if(!k || !i)
+                        {
+                            RADIO_CALIBRATE();
+                        }
+                    BENCH_SNAP(&s3);
+                    calPs += s3.t - s2.t;
+                    calNj += s3.mcu.energyNj - s2.mcu.energyNj + s3.cc.energyNj - s2.cc.energyNj;
+
+                    RADIO_SET_TX_LEVEL(RADIO_PWR_MAX);
+                    RADIO_TX(RADIO_DEV_ID, msg, RADIO_PAY_LEN);
+                    RADIO_SLEEP();
+                    HAL_LONG_DELAY(12000);
+                }
+            BENCH_SNAP(&s1);
+            SIM_CC_tempC = 25;
+
+            BENCH_PRINT((1 == k) ? "Cal cached" : (k ? "Cal once" : "Cal every wake"), &s0, &s1, BENCH_PACKETS);
+            printf("  25..%u C: calibrations %lu, stale TX/RX %lu, calibration step %.1f us %.3f uJ/wake\n",
+                   25 + BENCH_TEMP_SWING,
+                   (unsigned long)(s1.cc.calibrations - s0.cc.calibrations),
+                   (unsigned long)(s1.cc.uncalibrated - s0.cc.uncalibrated),
+                   calPs / (double)BENCH_PACKETS / SIM_PS_PER_US, calNj / BENCH_PACKETS / 1000.0);
+        }
+
+    //------------------------------------------------------------------------
+    // Channel hopping: one packet per hop, first through cold channels, then
+    //	warm ones, then with two channels excluded
+    printf("\n");
+    BENCH_HEADER();
+    RADIO_INIT();
+    HAL_ADC_CHANNEL_SELECT(BSP_INCH_TEMP);
+    RADIO_CALIBRATE_CACHED(HAL_ADC_SAMPLE());
+    RADIO_SLEEP();
+    for(k = 0; k < 3; k++)
+        {
+            if(2 == k)
+                {
+                    RADIO_HOP_EXCLUDE(SMARTRF_SETTING_CHANNR + RADIO_HOP_SPACING, 1);
+                    RADIO_HOP_EXCLUDE(SMARTRF_SETTING_CHANNR + 3 * RADIO_HOP_SPACING, 1);
+                }
+            memset(visits, 0, sizeof(visits));
+            wrong = 0;
+            calPs = 0;
+            calNj = 0;
+            BENCH_SNAP(&s0);
+            for(i = 0; i < (k ? BENCH_PACKETS : RADIO_HOP_CHANNELS); i++)
+                {
+                    BENCH_SNAP(&s2);
+                    RADIO_HOP_NEXT();
+                    BENCH_SNAP(&s3);
+                    calPs += s3.t - s2.t;
+                    calNj += s3.mcu.energyNj - s2.mcu.energyNj + s3.cc.energyNj - s2.cc.energyNj;
+
+                    RADIO_SET_TX_LEVEL(RADIO_PWR_MAX);
+                    RADIO_TX(RADIO_DEV_ID, msg, RADIO_PAY_LEN);
+                    RADIO_SLEEP();
+                    visits[BENCH_lastTx.chan]++;
+                    wrong += (BENCH_lastTx.chan != RADIO_CHANNEL()) || !BENCH_lastTx.calOk;
+                }
+            BENCH_SNAP(&s1);
+
+            BENCH_PRINT((2 == k) ? "Hop, 2 excluded" : (k ? "Hop, warm" : "Hop, cold"), &s0, &s1,
+                        k ? BENCH_PACKETS : RADIO_HOP_CHANNELS);
+            printf("  channels used");
+            for(d = 0; d < 256; d++)
+                {
+                    if(visits[d])
+                        {
+                            printf(" %lu", (unsigned long)d);
+                        }
+                }
+            printf(": calibrations %lu, wrong/stale frames %u, hop %.1f us %.3f uJ\n",
+                   (unsigned long)(s1.cc.calibrations - s0.cc.calibrations), wrong,
+                   calPs / (double)(k ? BENCH_PACKETS : RADIO_HOP_CHANNELS) / SIM_PS_PER_US,
+                   calNj / (k ? BENCH_PACKETS : RADIO_HOP_CHANNELS) / 1000.0);
+        }
+    RADIO_INIT();
+
+    //------------------------------------------------------------------------
+    // Transmit power control: a near receiver, which later moves out of
+    //	reach of the level chosen for it
+    printf("\n");
+    BENCH_HEADER();
+    for(k = 0; k < 3; k++)
+        {
+            if(2 != k)
+                {
+                    TXPWR_INIT();
+                }
+            delivered = 0;
+            BENCH_SNAP(&s0);
+            for(i = 0; i < BENCH_PACKETS; i++)
+                {
+                    if(BENCH_PWR_SEND(msg, (2 == k) ? BENCH_FAR_LOSS : BENCH_NEAR_LOSS, k)
+                            != RADIO_RSSI_NONE)
+                        {
+                            delivered++;
+                        }
+                }
+            BENCH_SNAP(&s1);
+            txNj[k] = (s1.cc.energyNj - s0.cc.energyNj) / BENCH_PACKETS;
+
+            if(2 == k)
+                {
+                    // Converged near, then obstructed
+                    BENCH_PRINT("TX power obstructed", &s0, &s1, BENCH_PACKETS);
+                }
+            else
+                {
+                    BENCH_PRINT(k ? "TX power adaptive" : "TX power fixed max", &s0, &s1, BENCH_PACKETS);
+                }
+            level = k ? TXPWR_LEVEL(RADIO_DEV_ID) : RADIO_PWR_MAX;
+            printf("  path loss %u dB: delivered %u/%u, level %u (%d dBm), rssi %d dBm, "
+                   "radio energy/pkt %.1f%% of full power\n",
+                   (2 == k) ? BENCH_FAR_LOSS : BENCH_NEAR_LOSS, delivered, BENCH_PACKETS,
+                   level, RADIO_TX_LEVEL_DBM(level),
+                   BENCH_lastTx.dbm - ((2 == k) ? BENCH_FAR_LOSS : BENCH_NEAR_LOSS),
+                   100.0 * txNj[k] / txNj[0]);
+        }
+
+    //------------------------------------------------------------------------
+    // Radio profiles: the cost of switching to each, then delivery at full
+    //	power over a near link, one beyond the reach of 500 kBaud and one
+    //	beyond the reach of 250 kBaud. Ends back on the SmartRF profile.
+    printf("\n");
+    BENCH_HEADER();
+    for(k = 0; k < RADIO_PROFILES; k++)
+        {
+            BENCH_SNAP(&s0);
+            RADIO_SET_PROFILE(order[k]);
+            BENCH_SNAP(&s1);
+            snprintf(name, sizeof(name), "Profile to %s", profiles[RADIO_PROFILE()]);
+            BENCH_PRINT(name, &s0, &s1, 1);
+            RADIO_SLEEP();
+
+            for(j = 0; j < 3; j++)
+                {
+                    delivered = 0;
+                    BENCH_SNAP(&s0);
+                    for(i = 0; i < BENCH_PACKETS; i++)
+                        {
+                            if(BENCH_PWR_SEND(msg, losses[j], 0) != RADIO_RSSI_NONE)
+                                {
+                                    delivered++;
+                                }
+                        }
+                    BENCH_SNAP(&s1);
+                    printf("  path loss %u dB: delivered %u/%u, airtime %.1f us, radio %.3f uJ/pkt\n",
+                           losses[j], delivered, BENCH_PACKETS,
+                           (BENCH_lastTx.end - BENCH_lastTx.start) / (double)SIM_PS_PER_US,
+                           (s1.cc.energyNj - s0.cc.energyNj) / BENCH_PACKETS / 1000.0);
+                }
+        }
+
+#if(RADIO_USE_ARQ)
+    //------------------------------------------------------------------------
+    // Acknowledged transmission, with every ACK arriving and with
+    //	BENCH_ACK_DROP_PCT of them lost
+    printf("\n");
+    BENCH_HEADER();
+    for(k = 0; k < 2; k++)
+        {
+            BENCH_ackDropPct = k ? BENCH_ACK_DROP_PCT : 0;
+            RADIO_TX_STATS(&txStats0);
+            frames0 = SIM_radio.stats.txFrames;
+            frames = 0;
+            BENCH_SNAP(&s0);
+            for(i = 0; i < BENCH_PACKETS; i++)
+                {
+                    RADIO_CALIBRATE();
+                    RADIO_SET_TX_LEVEL(RADIO_PWR_MAX);
+                    if(RADIO_SUCCESS == RADIO_TX(RADIO_DEV_ID, msg, RADIO_PAY_LEN))
+                        {
+                            frames++;
+                        }
+                    RADIO_SLEEP();
+                }
+            BENCH_SNAP(&s1);
+            RADIO_TX_STATS(&txStats);
+            txNj[k] = (s1.mcu.energyNj - s0.mcu.energyNj + s1.cc.energyNj - s0.cc.energyNj) / BENCH_PACKETS;
+
+            BENCH_PRINT(k ? "ARQ, ACKs lost" : "ARQ, no loss", &s0, &s1, BENCH_PACKETS);
+            printf("  ACKs lost %u%%: acknowledged %u/%u, frames %lu, retries %u, no ACK %u, "
+                   "energy/pkt %.1f%% of no loss\n",
+                   BENCH_ackDropPct, frames, BENCH_PACKETS,
+                   (unsigned long)(SIM_radio.stats.txFrames - frames0),
+                   txStats.retries - txStats0.retries, txStats.noAcks - txStats0.noAcks,
+                   100.0 * txNj[k] / txNj[0]);
+        }
+    BENCH_ackDropPct = 0;
+#endif
+
+#if(RADIO_TX_CCA)
+    //------------------------------------------------------------------------
+    // Transmit with clear channel assessment next to a busy interferer
+    RADIO_INIT();
+    RADIO_CALIBRATE();
+    SIM_CC_air.rssi = BENCH_BUSY_RSSI;
+    frames = 0;
+    BENCH_SNAP(&s0);
+    for(i = 0; i < BENCH_PACKETS; i++)
+        {
+            if(RADIO_SUCCESS == RADIO_TX(RADIO_DEV_ID, msg, RADIO_PAY_LEN))
+                {
+                    frames++;
+                }
+            HAL_LONG_DELAY(60);
+        }
+    BENCH_SNAP(&s1);
+    SIM_CC_air.rssi = 0;
+    RADIO_TX_STATS(&txStats);
+
+    printf("\n");
+    BENCH_HEADER();
+    BENCH_PRINT("RADIO_TX with CCA", &s0, &s1, BENCH_PACKETS);
+    printf("  channel busy %u%%: sent %u/%u, CCA fails %u, drops %u, backoff %.2f ms/pkt\n",
+           BENCH_BUSY_PCT, frames, BENCH_PACKETS, txStats.ccaFails, txStats.drops,
+           txStats.backoffTicks / (double)BENCH_PACKETS / 12.0);
+#endif
+
+    //------------------------------------------------------------------------
+    // Receive path: loop the last frame back into the radio
+    RADIO_INIT();
+    RADIO_CALIBRATE();
+    RADIO_SETUP_RX(&BENCH_RX_CB);
+
+    BENCH_rxCount = 0;
+#if(RADIO_USE_ARQ)
+    acks0 = BENCH_acksSent;
+#endif
+    BENCH_SNAP(&s0);
+    airPs = BENCH_lastTx.end - BENCH_lastTx.start;
+    for(i = 0; i < BENCH_PACKETS; i++)
+        {
+            t = SIM_now + SIM_PS_PER_MS;
+            BENCH_LOOPBACK(&BENCH_lastTx, t);
+            SIM_IDLE_UNTIL(t + airPs + BENCH_RX_WAIT_MS * SIM_PS_PER_MS);
+            latencyPs += BENCH_rxAt - (t + airPs);
+#if(RADIO_USE_ARQ)
+            ackPs += BENCH_ackAt - (t + airPs);
+#endif
+        }
+    BENCH_SNAP(&s1);
+
+    BENCH_PRINT("RX frame (ISR+cb)", &s0, &s1, BENCH_PACKETS);
+    printf("  delivered %u/%u, rx frames %lu, missed %lu, queue drops %u, rssi %d dBm\n",
+           BENCH_rxCount, BENCH_PACKETS,
+           (unsigned long)(s1.cc.rxFrames - s0.cc.rxFrames),
+           (unsigned long)(s1.cc.rxMissed - s0.cc.rxMissed),
+           RADIO_RX_OVERFLOWS(), BENCH_rxRssi);
+    printf("  end of frame to callback %.1f us\n",
+           latencyPs / (double)BENCH_PACKETS / SIM_PS_PER_US);
+#if(RADIO_USE_ARQ)
+    printf("  ACKs sent %lu, end of frame to ACK %.1f us (budget %u us), callback after the ACK\n",
+           (unsigned long)(BENCH_acksSent - acks0), ackPs / (double)BENCH_PACKETS / SIM_PS_PER_US,
+           (unsigned)RADIO_ARQ_TURNAROUND_US);
+#endif
+    latencyPs = 0;
+
+#if(!RADIO_USE_ARQ)
+    // RX FIFO overflow: two frames arrive while the GDO interrupts are held
+    //	off. The first transaction afterwards finds the overflow in its status
+    //	byte, flushes the FIFO and listens again, ready for the next frame.
+    //	(Under ARQ the radio leaves RX after each packet, so can't overflow.)
+    BENCH_rxCount = 0;
+    BENCH_SNAP(&s0);
+    ie = BSP_GDO_PIE;
+    BSP_GDO_PIE = 0;
+    for(i = 0; i < 2; i++)
+        {
+            t = SIM_now + SIM_PS_PER_MS;
+            BENCH_LOOPBACK(&BENCH_lastTx, t);
+            SIM_IDLE_UNTIL(t + airPs + BENCH_RX_WAIT_MS * SIM_PS_PER_MS);
+        }
+    BSP_GDO_PIE = ie;
+    SIM_IDLE_UNTIL(SIM_now + BENCH_RX_WAIT_MS * SIM_PS_PER_MS);
+    d = BENCH_rxCount;
+    t = SIM_now + SIM_PS_PER_MS;
+    BENCH_LOOPBACK(&BENCH_lastTx, t);
+    SIM_IDLE_UNTIL(t + airPs + BENCH_RX_WAIT_MS * SIM_PS_PER_MS);
+    BENCH_SNAP(&s1);
+
+    printf("  RX FIFO overflow: overflows %lu, recovered to state 0x%02X, next frame delivered %u/1\n",
+           (unsigned long)(s1.cc.rxOverflows - s0.cc.rxOverflows),
+           (unsigned)(RADIO_CHIP_STATUS() & CC2500_STATUS_STATE_BM),
+           (unsigned)(BENCH_rxCount - d));
+#endif
+
+    // Foreign traffic: frames on another network's sync word and, with
+    //	RADIO_USE_ADDR, frames for another device
+    BENCH_rxCount = 0;
+    BENCH_SNAP(&s0);
+    for(i = 0; i < BENCH_PACKETS; i++)
+        {
+            foreign = BENCH_lastTx;
+#if(RADIO_USE_ADDR)
+            if(i & 1)
+                {
+                    foreign.data[RADIO_LEN_FIELD] ^= 0x01;
+                }
+            else
+#endif
+                {
+                    foreign.sync ^= 0x0100;
+                }
+            BENCH_LOOPBACK(&foreign, SIM_now + SIM_PS_PER_MS);
+            SIM_IDLE_UNTIL(SIM_now + SIM_PS_PER_MS + airPs + BENCH_RX_WAIT_MS * SIM_PS_PER_MS);
+        }
+    BENCH_SNAP(&s1);
+
+    BENCH_PRINT("Foreign frame", &s0, &s1, BENCH_PACKETS);
+    printf("  delivered %u/%u, rx frames %lu, rx FIFO bytes read %lu\n",
+           BENCH_rxCount, BENCH_PACKETS,
+           (unsigned long)(s1.cc.rxFrames - s0.cc.rxFrames),
+           (unsigned long)(s1.cc.rxFifoBytes - s0.cc.rxFifoBytes));
+
+    //------------------------------------------------------------------------
+    // Idle listening: continuous receive against Wake-on-Radio polling
+    BENCH_SNAP(&s0);
+    SIM_IDLE_UNTIL(SIM_now + BENCH_IDLE_S * SIM_PS_PER_S);
+    BENCH_SNAP(&s1);
+
+    event0 = RADIO_WOR_EVENT0(BENCH_WOR_LATENCY);
+    RADIO_IDLE();
+    // Listen for one repetition period plus a preamble and sync word
+    RADIO_RX_WOR(event0, RADIO_WOR_RX_TIME(event0, (airPs + (BENCH_lastTx.syncEnd - BENCH_lastTx.start))
+                                           / SIM_PS_PER_US + BENCH_WOR_GAP_US));
+    RADIO_RX_POLL();
+
+    BENCH_SNAP(&s2);
+    SIM_IDLE_UNTIL(SIM_now + BENCH_IDLE_S * SIM_PS_PER_S);
+    BENCH_SNAP(&s3);
+
+    printf("\nIdle listening, WOR Event 0 = %u (%u ms), RX_TIME %u\n",
+           event0, BENCH_WOR_LATENCY, SIM_radio.reg[0x16] & 0x07);
+    BENCH_IDLE_CURRENT("continuous RX", &s0, &s1);
+    BENCH_IDLE_CURRENT("WOR polling  ", &s2, &s3);
+    BENCH_STATES("WOR", &s2, &s3, BENCH_IDLE_S);
+
+    //------------------------------------------------------------------------
+    // Wake-up: transmitter repeats the frame for one Event 0 period, starting
+    //	at a random phase of the receiver's WOR cycle
+    BENCH_rxCount = 0;
+    BENCH_SNAP(&s0);
+    for(i = 0; i < BENCH_PACKETS; i++)
+        {
+            prng = prng * 1103515245 + 12345;
+            start = SIM_now + (uint64_t)((prng >> 8) % (BENCH_WOR_LATENCY * 1000)) * SIM_PS_PER_US;
+            BENCH_rxAt = 0;
+
+            // Repeat until heard, or for one Event 0 period and one frame
+            for(t = start; !BENCH_rxAt && t < start + BENCH_WOR_LATENCY * SIM_PS_PER_MS + airPs;
+                    t += airPs + BENCH_WOR_GAP_US * SIM_PS_PER_US)
+                {
+                    BENCH_LOOPBACK(&BENCH_lastTx, t);
+                    SIM_IDLE_UNTIL(t + airPs + BENCH_WOR_GAP_US * SIM_PS_PER_US);
+                }
+
+            if(BENCH_rxAt)
+                {
+                    caught++;
+                    latencyPs += BENCH_rxAt - start;
+                    if(BENCH_rxAt - start > latencyMax)
+                        {
+                            latencyMax = BENCH_rxAt - start;
+                        }
+                }
+            SIM_IDLE_UNTIL(SIM_now + BENCH_WOR_LATENCY * SIM_PS_PER_MS);
+        }
+    BENCH_SNAP(&s1);
+
+    printf("\n");
+    BENCH_HEADER();
+    BENCH_PRINT("WOR wake-up (per burst)", &s0, &s1, BENCH_PACKETS);
+    printf("  caught %u/%u bursts, latency mean %.1f ms max %.1f ms, wakeups %lu, RX timeouts %lu\n",
+           caught, BENCH_PACKETS,
+           caught ? latencyPs / (double)caught / SIM_PS_PER_MS : 0.0,
+           latencyMax / (double)SIM_PS_PER_MS,
+           (unsigned long)(s1.cc.worWakeups - s0.cc.worWakeups),
+           (unsigned long)(s1.cc.worTimeouts - s0.cc.worTimeouts));
+
+    //------------------------------------------------------------------------
+    // One second of sleep across the VLO spread: as HAL_VLO_NOM_HZ ticks of
+    //	HAL_LONG_DELAY, and by HAL_SLEEP_MS after HAL_VLO_CALIBRATE
+    RADIO_IDLE();
+    RADIO_SLEEP();
+    printf("\n");
+    BENCH_HEADER();
+    for(j = 0; j < 3; j++)
+        {
+            SIM_vloHz = vloHz[j];
+            HAL_TMR_INIT();
+
+            BENCH_SNAP(&s0);
+            HAL_LONG_DELAY(HAL_VLO_NOM_HZ);
+            BENCH_SNAP(&s1);
+            calPs = s1.t - s0.t;
+
+            BENCH_SNAP(&s0);
+            HAL_VLO_CALIBRATE();
+            BENCH_SNAP(&s1);
+            BENCH_SNAP(&s2);
+            HAL_SLEEP_MS(1000);
+            BENCH_SNAP(&s3);
+
+            sprintf(name, "VLO calibration %2lu kHz", (unsigned long)(vloHz[j] / 1000));
+            BENCH_PRINT(name, &s0, &s1, 1);
+            printf("  measured %u Hz; 1 s as %u ticks %.1f ms, HAL_SLEEP_MS %.1f ms\n",
+                   HAL_aclkHz, HAL_VLO_NOM_HZ, calPs / (double)SIM_PS_PER_MS,
+                   (s3.t - s2.t) / (double)SIM_PS_PER_MS);
+        }
+
+    // Drift after calibration, followed once HAL_VLO_RECAL_MS have been slept
+    SIM_vloHz = 12000;
+    HAL_TMR_INIT();
+    HAL_VLO_CALIBRATE();
+    SIM_vloHz = BENCH_VLO_DRIFT_HZ;
+    HAL_TMR_INIT();
+    BENCH_SNAP(&s0);
+    HAL_SLEEP_MS(1000);
+    BENCH_SNAP(&s1);
+    for(i = 0; i < HAL_VLO_RECAL_MS / 1000; i++)
+        {
+            BENCH_SNAP(&s2);
+            HAL_SLEEP_MS(1000);
+            BENCH_SNAP(&s3);
+        }
+    printf("  drift 12 -> %u kHz: HAL_SLEEP_MS(1000) %.1f ms, after %lu s %.1f ms (%u Hz)\n",
+           BENCH_VLO_DRIFT_HZ / 1000, (s1.t - s0.t) / (double)SIM_PS_PER_MS,
+           (unsigned long)(HAL_VLO_RECAL_MS / 1000), (s3.t - s2.t) / (double)SIM_PS_PER_MS, HAL_aclkHz);
+
+    // The same drift for a receiver, which reports its WDT intervals to
+    //	HAL_VLO_ELAPSED instead of sleeping through HAL_SLEEP_MS
+    SIM_vloHz = 12000;
+    HAL_TMR_INIT();
+    HAL_VLO_CALIBRATE();
+    SIM_vloHz = BENCH_VLO_DRIFT_HZ;
+    HAL_TMR_INIT();
+    BENCH_SNAP(&s0);
+    for(i = 0; HAL_aclkHz > BENCH_VLO_DRIFT_HZ + BENCH_VLO_DRIFT_HZ / 20 && i < 100; i++)
+        {
+            HAL_LONG_DELAY(BENCH_WDT_TICKS);
+            if(HAL_VLO_ELAPSED(BENCH_WDT_TICKS))
+                {
+                    HAL_VLO_CALIBRATE();
+                }
+        }
+    BENCH_SNAP(&s1);
+    printf("  drift 12 -> %u kHz: HAL_VLO_ELAPSED per WDT interval remeasured after %lu intervals, %.1f s (%u Hz)\n",
+           BENCH_VLO_DRIFT_HZ / 1000, (unsigned long)i,
+           (s1.t - s0.t) / (double)SIM_PS_PER_S, HAL_aclkHz);
+
+    // A settle wait measured at 12 kHz, then run on a VLO that has sped up
+    //	by as much as it drifts between calibrations
+    SIM_vloHz = 12000;
+    HAL_TMR_INIT();
+    HAL_VLO_CALIBRATE();
+    BENCH_SNAP(&s0);
+    HAL_PRECISE_DELAY(BENCH_DELAY_TICKS);
+    BENCH_SNAP(&s1);
+    SIM_vloHz = BENCH_VLO_FAST_HZ;
+    HAL_TMR_INIT();
+    BENCH_SNAP(&s2);
+    HAL_PRECISE_DELAY(BENCH_DELAY_TICKS);
+    BENCH_SNAP(&s3);
+    printf("  HAL_PRECISE_DELAY(%u) (%.1f us) measured at 12 kHz: %.1f us at 12 kHz, %.1f us at %.1f kHz\n",
+           BENCH_DELAY_TICKS, BENCH_DELAY_TICKS * 1e6 / 32768,
+           (s1.t - s0.t) / (double)SIM_PS_PER_US, (s3.t - s2.t) / (double)SIM_PS_PER_US,
+           BENCH_VLO_FAST_HZ / 1000.0);
+
+    return 0;
+}
@@ -0,0 +1,1499 @@
+/**
+ * @brief Timing model of the CC2500 transceiver for host-side benchmarking
+ *
+ * The model is advanced lazily: the simulator asks for the time of the next
+ * internal event (SIM_CC_NEXT), moves its clock there and lets the chip
+ * process it (SIM_CC_UPDATE). SPI bytes and ~CS edges are delivered by the
+ * USCI and port models in sim.c as they happen.
+ *
+ * Timing and current figures are typical values from the CC2500 datasheet
+ * (SWRS040) at 3.0 V and 26 MHz crystal.
+ *
+ * @file cc2500_sim.c
+ * @author Aaron Parks, UW Sensor Systems Laboratory
+ * @version 1.0
+ */
+
+///////////////////////////////////////////////////////////////////////////////
+/// Includes
+///////////////////////////////////////////////////////////////////////////////
+#include "cc2500_sim.h"
+#include <stddef.h>
+#include <string.h>
+
+///////////////////////////////////////////////////////////////////////////////
+/// Local definitions
+///////////////////////////////////////////////////////////////////////////////
+
+#define SIM_PS_PER_US			1000000ULL
+
+// State transition timing
+#define SIM_CC_XOSC_START_PS	(150 * SIM_PS_PER_US)	// SLEEP/XOFF to IDLE
+#define SIM_CC_RESET_PS			(41 * SIM_PS_PER_US)	// SRES to CHIP_RDYn low
+#define SIM_CC_CAL_PS			(721 * SIM_PS_PER_US)	// FS calibration
+#define SIM_CC_SETTLE_PS		(88400000ULL)			// IDLE to RX/TX, no cal
+#define SIM_CC_RXTX_PS			(9600000ULL)			// RX to TX turnaround
+#define SIM_CC_TXRX_PS			(21500000ULL)			// TX to RX turnaround
+#define SIM_CC_FSTXON_PS		(1 * SIM_PS_PER_US)		// FSTXON to RX/TX
+#define SIM_CC_RC_PS			(28846154ULL)			// RC oscillator period, 750/fXOSC
+
+// Link thresholds
+#define SIM_CC_CS_DBM			(-85)	// Carrier sense / CCA threshold
+#define SIM_CC_RSSI_OFFSET		72		// RSSI register offset (dB)
+
+#define SIM_CC_SUPPLY_V			3.0
+#define SIM_CC_WOR_MA			0.0009	// SLEEP with the RC oscillator running
+
+// Register addresses used by the model
+#define R_IOCFG2	0x00
+#define R_IOCFG1	0x01
+#define R_IOCFG0	0x02
+#define R_FIFOTHR	0x03
+#define R_SYNC1		0x04
+#define R_SYNC0		0x05
+#define R_PKTLEN	0x06
+#define R_PKTCTRL1	0x07
+#define R_PKTCTRL0	0x08
+#define R_ADDR		0x09
+#define R_CHANNR	0x0A
+#define R_MDMCFG4	0x10
+#define R_MDMCFG3	0x11
+#define R_MDMCFG2	0x12
+#define R_MDMCFG1	0x13
+#define R_MCSM2		0x16
+#define R_MCSM1		0x17
+#define R_MCSM0		0x18
+#define R_WOREVT1	0x1E
+#define R_WOREVT0	0x1F
+#define R_WORCTRL	0x20
+#define R_FREND0	0x22
+#define R_FSCAL3	0x23
+#define R_FSCAL2	0x24
+#define R_FSCAL1	0x25
+
+///////////////////////////////////////////////////////////////////////////////
+/// Shared model state
+///////////////////////////////////////////////////////////////////////////////
+SIM_cc_air_t SIM_CC_air;
+int8_t SIM_CC_tempC = 25;
+
+/**
+ * Register values after power-on reset or SRES (datasheet register overview).
+ */
+static const uint8_t SIM_CC_RESET_REGS[SIM_CC_REG_COUNT] =
+{
+    0x29, 0x2E, 0x3F, 0x07, 0xD3, 0x91, 0xFF, 0x04,
+    0x45, 0x00, 0x00, 0x0F, 0x00, 0x5E, 0xC4, 0xEC,
+    0x8C, 0x22, 0x02, 0x22, 0xF8, 0x47, 0x07, 0x30,
+    0x04, 0x36, 0x6C, 0x03, 0x40, 0x91, 0x87, 0x6B,
+    0xF8, 0x56, 0x10, 0xA9, 0x0A, 0x20, 0x0D, 0x41,
+    0x00, 0x59, 0x7F, 0x3F, 0x88, 0x31, 0x0B
+};
+
+/**
+ * Optimum PATABLE settings and the resulting output power and TX current.
+ */
+static const struct
+{
+    uint8_t pa;
+    int8_t  dbm;
+    float   ma;
+} SIM_CC_PA_TABLE[] =
+{
+    {0x00, -55,  8.4f}, {0x50, -30,  9.9f}, {0x44, -28,  9.7f},
+    {0xC0, -26, 10.2f}, {0x84, -24, 10.1f}, {0x81, -22, 10.0f},
+    {0x46, -20, 10.1f}, {0x93, -18, 11.7f}, {0x55, -16, 10.8f},
+    {0x8D, -14, 12.2f}, {0xC6, -12, 11.1f}, {0x97, -10, 12.2f},
+    {0x6E,  -8, 14.1f}, {0x7F,  -6, 15.0f}, {0xA9,  -4, 16.2f},
+    {0xBB,  -2, 18.1f}, {0xFE,   0, 21.2f}, {0xFF,   1, 21.5f}
+};
+
+// Supply current (mA) for each power group other than TX
+static const float SIM_CC_PWR_MA[SIM_CC_PWR_COUNT] =
+{
+    0.0004f,	// SLEEP
+    0.16f,		// XOFF
+    1.5f,		// IDLE
+    7.4f,		// Synthesizer running
+    17.0f,		// RX, 250 kBaud
+    21.2f		// TX, replaced by PATABLE lookup
+};
+
+///////////////////////////////////////////////////////////////////////////////
+/// Local prototypes
+///////////////////////////////////////////////////////////////////////////////
+static void SIM_CC_ENTER( SIM_cc2500_t* c, uint8_t marc, uint64_t now );
+static void SIM_CC_GOTO( SIM_cc2500_t* c, uint8_t marc, uint64_t dly,
+                         uint64_t now );
+static void SIM_CC_LEAVE_ACTIVE( SIM_cc2500_t* c, uint64_t now );
+static void SIM_CC_START_ACTIVE( SIM_cc2500_t* c, uint8_t target, uint64_t now );
+static void SIM_CC_STROBE( SIM_cc2500_t* c, uint8_t cmd, uint64_t now );
+static void SIM_CC_CALIBRATE( SIM_cc2500_t* c );
+static uint8_t SIM_CC_CAL_OK( const SIM_cc2500_t* c );
+static uint8_t SIM_CC_CLEAR( SIM_cc2500_t* c, uint64_t now );
+static void SIM_CC_ACCOUNT( SIM_cc2500_t* c, uint64_t now );
+static void SIM_CC_RX_ABORT( SIM_cc2500_t* c );
+static void SIM_CC_RX_PUSH( SIM_cc2500_t* c, uint8_t b );
+static uint64_t SIM_CC_SYNC_PS( const SIM_cc2500_t* c );
+static uint64_t SIM_CC_DATA_BYTE_PS( const SIM_cc2500_t* c );
+static void SIM_CC_POWER_DOWN( SIM_cc2500_t* c, uint8_t marc );
+static uint64_t SIM_CC_EVENT0_PS( const SIM_cc2500_t* c );
+static void SIM_CC_WOR_SCHEDULE( SIM_cc2500_t* c, uint64_t evt0 );
+
+///////////////////////////////////////////////////////////////////////////////
+
+/**
+ * Power-on reset. The chip comes up in IDLE with the crystal running.
+ *
+ * @param chip	The chip model to reset
+ * @param now	Current simulator time (ps)
+ */
+void SIM_CC_INIT( SIM_cc2500_t* chip, uint64_t now )
+{
+    void* user = chip->user;
+
+    memset(chip, 0, sizeof(*chip));
+    memcpy(chip->reg, SIM_CC_RESET_REGS, SIM_CC_REG_COUNT);
+    chip->patable[0] = 0xC6;
+    chip->marc = SIM_MARC_IDLE;
+    chip->ready = 1;
+    chip->hdrPending = 1;
+    chip->pendingOff = SIM_CC_OFF_NONE;
+    chip->lastAcct = now;
+    chip->user = user;
+}
+
+/**
+ * ~CS line edge. A falling edge wakes the chip from SLEEP/XOFF and starts a
+ * new SPI transaction; a rising edge executes a pending SPWD/SXOFF.
+ */
+void SIM_CC_CS( SIM_cc2500_t* chip, uint8_t low, uint64_t now )
+{
+    SIM_CC_UPDATE(chip, now);
+
+    if(low)
+        {
+            chip->csLow = 1;
+            chip->hdrPending = 1;
+            chip->csLowAt = now;
+            chip->stats.spiTxns++;
+
+            if((SIM_MARC_SLEEP == chip->marc || SIM_MARC_XOFF == chip->marc)
+                    && !chip->readyAt)
+                {
+                    chip->readyAt = now + SIM_CC_XOSC_START_PS;
+                }
+        }
+    else
+        {
+            chip->csLow = 0;
+            chip->stats.csLowPs += now - chip->csLowAt;
+
+            if(SIM_CC_OFF_NONE != chip->pendingOff)
+                {
+                    SIM_CC_POWER_DOWN(chip, chip->pendingOff);
+                    chip->pendingOff = SIM_CC_OFF_NONE;
+                }
+        }
+}
+
+/**
+ * Exchange one byte with the chip. Called at the end of the byte on the bus.
+ *
+ * @return The byte driven on SO during the transfer
+ */
+uint8_t SIM_CC_SPI( SIM_cc2500_t* chip, uint8_t mosi, uint64_t now )
+{
+    uint8_t miso;
+
+    SIM_CC_UPDATE(chip, now);
+
+    chip->stats.spiBytes++;
+
+    if(!chip->ready)
+        {
+            chip->stats.notReady++;
+            return SIM_CC_STATUS(chip, 0);
+        }
+
+    // Header byte: decode address and access type
+    if(chip->hdrPending)
+        {
+            chip->addr = mosi & 0x3F;
+            chip->burst = mosi & 0x40;
+            chip->read = mosi & 0x80;
+            miso = SIM_CC_STATUS(chip, chip->read);
+
+            if(0x3E != chip->addr)
+                {
+                    chip->paIndex = 0;
+                }
+
+            if(chip->addr >= 0x30 && chip->addr <= 0x3D && !chip->burst)
+                {
+                    SIM_CC_STROBE(chip, chip->addr, now);
+                }
+            else
+                {
+                    chip->hdrPending = 0;
+                }
+
+            return miso;
+        }
+
+    // Data byte
+    if(chip->read)
+        {
+            if(chip->addr < SIM_CC_REG_COUNT)
+                {
+                    miso = chip->reg[chip->addr];
+                    chip->stats.regReads++;
+                }
+            else if(chip->addr >= 0x30 && chip->addr <= 0x3D)
+                {
+                    chip->stats.regReads++;
+                    switch(chip->addr)
+                        {
+                        case 0x30:
+                            miso = 0x80;
+                            break;
+                        case 0x31:
+                            miso = 0x03;
+                            break;
+                        case 0x33:
+                            miso = chip->lqi;
+                            break;
+                        case 0x34:
+                            if(SIM_MARC_RX == chip->marc && SIM_CC_air.rssi)
+                                {
+                                    chip->rssi = (uint8_t)(2 *
+                                                 (SIM_CC_air.rssi(chip, now) + SIM_CC_RSSI_OFFSET));
+                                }
+                            miso = chip->rssi;
+                            break;
+                        case 0x35:
+                            miso = chip->marc;
+                            break;
+                        case 0x38:
+                            miso = (chip->lqi & 0x80)
+                                   | (SIM_CC_CLEAR(chip, now) ? 0x10 : 0)
+                                   | (chip->syncFlag ? 0x08 : 0)
+                                   | (SIM_CC_GDO(chip, 2) ? 0x04 : 0)
+                                   | (SIM_CC_GDO(chip, 0) ? 0x01 : 0);
+                            break;
+                        case 0x3A:
+                            miso = chip->txCount
+                                   | ((SIM_MARC_TXFIFO_UNF == chip->marc) ? 0x80 : 0);
+                            break;
+                        case 0x3B:
+                            miso = chip->rxCount
+                                   | ((SIM_MARC_RXFIFO_OVF == chip->marc) ? 0x80 : 0);
+                            break;
+                        default:
+                            miso = 0x00;
+                            break;
+                        }
+                    // Status registers are single access even with burst bit
+                    chip->hdrPending = 1;
+                    return miso;
+                }
+            else if(0x3E == chip->addr)
+                {
+                    miso = chip->patable[chip->paIndex++ & 0x07];
+                }
+            else
+                {
+                    // RX FIFO
+                    if(chip->rxCount)
+                        {
+                            miso = chip->rxFifo[chip->rxHead];
+                            chip->rxHead = (chip->rxHead + 1) % SIM_CC_FIFO_LEN;
+                            chip->rxCount--;
+                            if(chip->rxPktBytes > chip->rxCount)
+                                {
+                                    chip->rxPktBytes = chip->rxCount;
+                                }
+                        }
+                    else
+                        {
+                            miso = 0x00;
+                        }
+                    chip->crcOkFlag = 0;
+                    if(!chip->rxCount)
+                        {
+                            chip->eopFlag = 0;
+                        }
+                    chip->stats.rxFifoBytes++;
+                }
+        }
+    else
+        {
+            miso = SIM_CC_STATUS(chip, 0);
+
+            if(chip->addr < SIM_CC_REG_COUNT)
+                {
+                    chip->reg[chip->addr] = mosi;
+                    chip->stats.regWrites++;
+                }
+            else if(0x3E == chip->addr)
+                {
+                    chip->patable[chip->paIndex++ & 0x07] = mosi;
+                    chip->stats.regWrites++;
+                }
+            else if(0x3F == chip->addr)
+                {
+                    if(chip->txCount < SIM_CC_FIFO_LEN)
+                        {
+                            chip->txFifo[(chip->txHead + chip->txCount) % SIM_CC_FIFO_LEN] = mosi;
+                            chip->txCount++;
+                        }
+                    chip->stats.txFifoBytes++;
+                }
+        }
+
+    if(chip->burst)
+        {
+            if(chip->addr < SIM_CC_REG_COUNT)
+                {
+                    chip->addr++;
+                }
+        }
+    else
+        {
+            chip->hdrPending = 1;
+        }
+
+    return miso;
+}
+
+/**
+ * Level of the SO pin. While ~CS is low SO shows CHIP_RDYn; otherwise it is
+ * the GDO1 output selected by IOCFG1.
+ */
+uint8_t SIM_CC_SO( SIM_cc2500_t* chip )
+{
+    if(chip->csLow)
+        {
+            return !chip->ready;
+        }
+
+    return SIM_CC_GDO(chip, 1);
+}
+
+/**
+ * Level of a GDO output as configured by its IOCFGx register.
+ *
+ * @param n 0, 1 or 2
+ */
+uint8_t SIM_CC_GDO( SIM_cc2500_t* chip, uint8_t n )
+{
+    uint8_t cfg;
+    uint8_t thr;
+    uint8_t v;
+
+    cfg = chip->reg[R_IOCFG2 + (2 - n)];
+    thr = chip->reg[R_FIFOTHR] & 0x0F;
+
+    switch(cfg & 0x3F)
+        {
+        case 0x00:
+            v = chip->rxCount >= 4 * (thr + 1);
+            break;
+        case 0x01:
+            v = (chip->rxCount >= 4 * (thr + 1)) || (chip->eopFlag && chip->rxCount);
+            break;
+        case 0x02:
+            v = chip->txCount >= 61 - 4 * thr;
+            break;
+        case 0x03:
+            v = SIM_CC_FIFO_LEN == chip->txCount;
+            break;
+        case 0x04:
+            v = SIM_MARC_RXFIFO_OVF == chip->marc;
+            break;
+        case 0x05:
+            v = SIM_MARC_TXFIFO_UNF == chip->marc;
+            break;
+        case 0x06:
+            v = chip->syncFlag;
+            break;
+        case 0x07:
+            v = chip->crcOkFlag;
+            break;
+        case 0x09:
+            v = (SIM_MARC_RX == chip->marc) && SIM_CC_CLEAR(chip, chip->lastAcct);
+            break;
+        case 0x0E:
+            v = (SIM_MARC_RX == chip->marc) && SIM_CC_air.rssi
+                && SIM_CC_air.rssi(chip, chip->lastAcct) >= SIM_CC_CS_DBM;
+            break;
+        case 0x29:
+            v = !chip->ready;
+            break;
+        default:
+            // High impedance and clock outputs read as low
+            return 0;
+        }
+
+    return (cfg & 0x40) ? !v : v;
+}
+
+/**
+ * Time of the next internal event of the chip.
+ */
+uint64_t SIM_CC_NEXT( SIM_cc2500_t* chip )
+{
+    uint64_t t = UINT64_MAX;
+    uint8_t i;
+
+#define SIM_CC_MIN(x)	if((x) && (x) < t) { t = (x); }
+
+    if(!chip->ready)
+        {
+            SIM_CC_MIN(chip->readyAt);
+        }
+
+    SIM_CC_MIN(chip->evtAt);
+
+    if(chip->wor)
+        {
+            SIM_CC_MIN(chip->worEvt1At);
+            SIM_CC_MIN(chip->worEvt0At);
+        }
+
+    if(SIM_MARC_RX == chip->marc && !chip->rxActive)
+        {
+            SIM_CC_MIN(chip->rxTimeoutAt);
+        }
+
+    if(SIM_MARC_TX == chip->marc)
+        {
+            SIM_CC_MIN(chip->txNextAt);
+            SIM_CC_MIN(chip->txEndAt);
+            if(!chip->syncFlag)
+                {
+                    SIM_CC_MIN(chip->txSyncAt);
+                }
+        }
+
+    if(SIM_MARC_RX == chip->marc && chip->rxActive)
+        {
+            SIM_CC_MIN(chip->rxNextAt);
+            SIM_CC_MIN(chip->rxEndAt);
+        }
+
+    for(i = 0; i < chip->airCount; i++)
+        {
+            SIM_CC_MIN(chip->air[i].syncEnd);
+        }
+
+#undef SIM_CC_MIN
+
+    return t;
+}
+
+/**
+ * Process every internal event up to and including now.
+ */
+void SIM_CC_UPDATE( SIM_cc2500_t* chip, uint64_t now )
+{
+    uint64_t t;
+    uint8_t b;
+    uint8_t i;
+
+    while((t = SIM_CC_NEXT(chip)) <= now)
+        {
+            SIM_CC_ACCOUNT(chip, t);
+
+            // Crystal started / reset complete
+            if(!chip->ready && chip->readyAt && chip->readyAt <= t)
+                {
+                    chip->ready = 1;
+                    chip->readyAt = 0;
+                    if(SIM_MARC_SLEEP == chip->marc || SIM_MARC_XOFF == chip->marc)
+                        {
+                            chip->marc = SIM_MARC_IDLE;
+                        }
+                }
+
+            // End of a transitional state
+            if(chip->evtAt && chip->evtAt <= t)
+                {
+                    chip->evtAt = 0;
+                    SIM_CC_ENTER(chip, chip->marcNext, t);
+                }
+
+            // Wake-on-Radio: Event 1 starts the crystal, Event 0 starts RX.
+            //	Event 0 only has an effect while the chip is sleeping in WOR.
+            if(chip->wor && chip->worEvt1At && chip->worEvt1At <= t)
+                {
+                    chip->worEvt1At = 0;
+                    if(SIM_MARC_SLEEP == chip->marc && !chip->readyAt)
+                        {
+                            chip->readyAt = t + SIM_CC_XOSC_START_PS;
+                            chip->worWake = 1;
+                        }
+                }
+
+            if(chip->wor && chip->worEvt0At <= t)
+                {
+                    uint64_t wait = 0;
+
+                    if(SIM_MARC_SLEEP == chip->marc
+                            || (SIM_MARC_IDLE == chip->marc && chip->worWake))
+                        {
+                            // Crystal not started yet (Event 1 too short)
+                            if(SIM_MARC_SLEEP == chip->marc)
+                                {
+                                    if(!chip->readyAt)
+                                        {
+                                            chip->readyAt = t + SIM_CC_XOSC_START_PS;
+                                        }
+                                    wait = chip->readyAt - t;
+                                }
+
+                            chip->stats.worWakeups++;
+                            chip->worRx = 1;
+                            SIM_CC_START_ACTIVE(chip, SIM_MARC_RX, t);
+                            chip->evtAt += wait;
+                        }
+
+                    chip->worWake = 0;
+                    SIM_CC_WOR_SCHEDULE(chip, chip->worEvt0At);
+                }
+
+            // RX_TIME expired without sync: back to WOR sleep
+            if(chip->rxTimeoutAt && chip->rxTimeoutAt <= t)
+                {
+                    chip->rxTimeoutAt = 0;
+                    if(SIM_MARC_RX == chip->marc && !chip->rxActive)
+                        {
+                            chip->stats.worTimeouts++;
+                            SIM_CC_POWER_DOWN(chip, SIM_MARC_SLEEP);
+                        }
+                }
+
+            // Transmitter
+            if(SIM_MARC_TX == chip->marc)
+                {
+                    if(!chip->syncFlag && chip->txSyncAt && chip->txSyncAt <= t)
+                        {
+                            chip->syncFlag = 1;
+                            chip->txFrame.syncEnd = t;
+                        }
+
+                    if(chip->txNextAt && chip->txNextAt <= t)
+                        {
+                            if(!chip->txCount)
+                                {
+                                    chip->marc = SIM_MARC_TXFIFO_UNF;
+                                    chip->syncFlag = 0;
+                                    chip->txNextAt = 0;
+                                    chip->stats.txUnderflows++;
+                                    continue;
+                                }
+
+                            b = chip->txFifo[chip->txHead];
+                            chip->txHead = (chip->txHead + 1) % SIM_CC_FIFO_LEN;
+                            chip->txCount--;
+                            chip->txFrame.data[chip->txFrame.len++] = b;
+
+                            if(1 == chip->txFrame.len)
+                                {
+                                    chip->txLen = (chip->reg[R_PKTCTRL0] & 0x03) ?
+                                                  (uint16_t)b + 1 : chip->reg[R_PKTLEN];
+                                }
+
+                            if(chip->txFrame.len >= chip->txLen)
+                                {
+                                    chip->txNextAt = 0;
+                                    chip->txEndAt = t + SIM_CC_AIRTIME(chip, chip->txLen)
+                                                    - SIM_CC_SYNC_PS(chip)
+                                                    - (uint64_t)(chip->txLen - 1) * SIM_CC_DATA_BYTE_PS(chip);
+                                }
+                            else
+                                {
+                                    chip->txNextAt = t + SIM_CC_DATA_BYTE_PS(chip);
+                                }
+                        }
+
+                    if(chip->txEndAt && chip->txEndAt <= t)
+                        {
+                            chip->txEndAt = 0;
+                            chip->syncFlag = 0;
+                            chip->txFrame.end = t;
+                            chip->stats.txFrames++;
+
+                            if(SIM_CC_air.tx)
+                                {
+                                    SIM_CC_air.tx(chip, &chip->txFrame);
+                                }
+
+                            // TXOFF_MODE
+                            switch(chip->reg[R_MCSM1] & 0x03)
+                                {
+                                case 1:
+                                    SIM_CC_ENTER(chip, SIM_MARC_FSTXON, t);
+                                    break;
+                                case 2:
+                                    SIM_CC_ENTER(chip, SIM_MARC_TX, t);
+                                    break;
+                                case 3:
+                                    SIM_CC_GOTO(chip, SIM_MARC_RX, SIM_CC_TXRX_PS, t);
+                                    chip->marc = SIM_MARC_TXRX_SWITCH;
+                                    break;
+                                default:
+                                    SIM_CC_LEAVE_ACTIVE(chip, t);
+                                    break;
+                                }
+                        }
+                }
+
+            // Receiver: lock onto a frame at the end of its sync word. The
+            //	receiver must have been listening for at least the second half
+            //	of preamble and sync to find it.
+            for(i = 0; i < chip->airCount; i++)
+                {
+                    SIM_frame_t* f = &chip->air[i];
+                    uint8_t syncMode = chip->reg[R_MDMCFG2] & 0x03;
+                    uint16_t sync = ((uint16_t)chip->reg[R_SYNC1] << 8) | chip->reg[R_SYNC0];
+                    uint32_t baud = SIM_CC_BAUD(chip);
+
+                    if(f->syncEnd > t)
+                        {
+                            continue;
+                        }
+
+                    if(SIM_MARC_RX == chip->marc && !chip->rxActive
+                            && chip->rxSince + SIM_CC_SYNC_PS(chip) / 2 <= f->syncEnd
+                            && f->chan == chip->reg[R_CHANNR]
+                            && (!syncMode || f->sync == sync)
+                            && f->baud > baud - baud / 20 && f->baud < baud + baud / 20
+                            && f->fec == !!(chip->reg[R_MDMCFG1] & 0x80)
+                            && f->dbm >= SIM_CC_SENS_DBM(baud)
+                            && f->calOk && !chip->offFreq)
+                        {
+                            chip->rxFrame = *f;
+                            chip->rxActive = 1;
+                            chip->rxPos = 0;
+                            chip->rxPktBytes = 0;
+                            chip->rxLen = (chip->reg[R_PKTCTRL0] & 0x03) ? 0 : chip->reg[R_PKTLEN];
+                            chip->rxNextAt = t + SIM_CC_DATA_BYTE_PS(chip);
+                            chip->rxEndAt = 0;
+                            chip->syncFlag = 1;
+                            chip->rssi = (uint8_t)(2 * (f->dbm + SIM_CC_RSSI_OFFSET));
+                            chip->lqi = f->lqi & 0x7F;
+                        }
+                    else
+                        {
+                            chip->stats.rxMissed++;
+                        }
+
+                    chip->airCount--;
+                    memmove(&chip->air[i], &chip->air[i + 1],
+                            (chip->airCount - i) * sizeof(SIM_frame_t));
+                    i--;
+                }
+
+            // Receiver: data bytes and end of packet
+            if(SIM_MARC_RX == chip->marc && chip->rxActive)
+                {
+                    if(chip->rxNextAt && chip->rxNextAt <= t)
+                        {
+                            uint8_t adrChk = chip->reg[R_PKTCTRL1] & 0x03;
+                            uint8_t var = chip->reg[R_PKTCTRL0] & 0x03;
+
+                            b = (chip->rxPos < chip->rxFrame.len) ? chip->rxFrame.data[chip->rxPos] : 0;
+                            chip->rxPos++;
+
+                            if(var && 1 == chip->rxPos)
+                                {
+                                    if(b > chip->reg[R_PKTLEN])
+                                        {
+                                            SIM_CC_RX_ABORT(chip);
+                                            continue;
+                                        }
+                                    chip->rxLen = (uint16_t)b + 1;
+                                }
+
+                            if(adrChk && chip->rxPos == (var ? 2 : 1)
+                                    && b != chip->reg[R_ADDR]
+                                    && !(adrChk >= 2 && 0x00 == b)
+                                    && !(3 == adrChk && 0xFF == b))
+                                {
+                                    SIM_CC_RX_ABORT(chip);
+                                    continue;
+                                }
+
+                            if(SIM_CC_FIFO_LEN == chip->rxCount)
+                                {
+                                    chip->marc = SIM_MARC_RXFIFO_OVF;
+                                    chip->rxActive = 0;
+                                    chip->syncFlag = 0;
+                                    chip->stats.rxOverflows++;
+                                    continue;
+                                }
+
+                            SIM_CC_RX_PUSH(chip, b);
+
+                            if(chip->rxPos >= chip->rxLen)
+                                {
+                                    chip->rxNextAt = 0;
+                                    chip->rxEndAt = chip->rxFrame.syncEnd
+                                                    + SIM_CC_AIRTIME(chip, chip->rxLen)
+                                                    - SIM_CC_SYNC_PS(chip);
+                                    if(chip->rxEndAt <= t)
+                                        {
+                                            chip->rxEndAt = t + 1;
+                                        }
+                                }
+                            else
+                                {
+                                    chip->rxNextAt = t + SIM_CC_DATA_BYTE_PS(chip);
+                                }
+                        }
+
+                    if(chip->rxEndAt && chip->rxEndAt <= t)
+                        {
+                            uint8_t crcEn = chip->reg[R_PKTCTRL0] & 0x04;
+                            uint8_t ok = crcEn && chip->rxFrame.crcOk;
+
+                            chip->rxActive = 0;
+                            chip->rxEndAt = 0;
+                            chip->syncFlag = 0;
+                            chip->lqi = (chip->lqi & 0x7F) | (ok ? 0x80 : 0);
+
+                            if(crcEn && !ok && (chip->reg[R_PKTCTRL1] & 0x08))
+                                {
+                                    // CRC_AUTOFLUSH drops the whole RX FIFO
+                                    chip->rxCount = 0;
+                                    chip->rxHead = 0;
+                                    chip->rxPktBytes = 0;
+                                    chip->stats.rxDiscarded++;
+                                }
+                            else
+                                {
+                                    if(chip->reg[R_PKTCTRL1] & 0x04)
+                                        {
+                                            if(chip->rxCount + 2 > SIM_CC_FIFO_LEN)
+                                                {
+                                                    chip->marc = SIM_MARC_RXFIFO_OVF;
+                                                    chip->stats.rxOverflows++;
+                                                    continue;
+                                                }
+                                            SIM_CC_RX_PUSH(chip, chip->rssi);
+                                            SIM_CC_RX_PUSH(chip, chip->lqi);
+                                        }
+                                    chip->stats.rxFrames++;
+                                    chip->crcOkFlag = ok;
+                                    chip->eopFlag = 1;
+                                }
+
+                            chip->rxPktBytes = 0;
+
+                            // RXOFF_MODE
+                            switch((chip->reg[R_MCSM1] >> 2) & 0x03)
+                                {
+                                case 1:
+                                    SIM_CC_ENTER(chip, SIM_MARC_FSTXON, t);
+                                    break;
+                                case 2:
+                                    SIM_CC_GOTO(chip, SIM_MARC_TX, SIM_CC_RXTX_PS, t);
+                                    chip->marc = SIM_MARC_RXTX_SWITCH;
+                                    break;
+                                case 3:
+                                    break;
+                                default:
+                                    SIM_CC_LEAVE_ACTIVE(chip, t);
+                                    break;
+                                }
+                        }
+                }
+        }
+
+    SIM_CC_ACCOUNT(chip, now);
+}
+
+/**
+ * Queue a frame for reception. The chip decides at the end of the sync word
+ * whether it can lock onto it.
+ */
+void SIM_CC_RX_FRAME( SIM_cc2500_t* chip, const SIM_frame_t* frame )
+{
+    uint8_t i;
+
+    if(SIM_CC_AIR_QUEUE == chip->airCount)
+        {
+            chip->stats.rxMissed++;
+            return;
+        }
+
+    // Keep the queue ordered by sync time
+    for(i = chip->airCount; i > 0 && chip->air[i - 1].syncEnd > frame->syncEnd; i--)
+        {
+            chip->air[i] = chip->air[i - 1];
+        }
+    chip->air[i] = *frame;
+    chip->airCount++;
+}
+
+/**
+ * Queue a frame answering the frame to, as the node it was sent to would
+ * transmit it: same data rate, sync word and channel, starting delay ps after
+ * the end of to and received at dbm.
+ */
+void SIM_CC_REPLY( SIM_cc2500_t* chip, const SIM_frame_t* to, const uint8_t* data,
+                   uint16_t len, uint64_t delay, int8_t dbm )
+{
+    SIM_frame_t f = *to;
+
+    f.start = to->end + delay;
+    f.syncEnd = f.start + SIM_CC_SYNC_PS(chip);
+    f.end = f.start + SIM_CC_AIRTIME(chip, len);
+    f.crcOk = 1;
+    f.calOk = 1;
+    f.dbm = dbm;
+    f.len = len;
+    memcpy(f.data, data, len);
+    f.src = 0;
+    SIM_CC_RX_FRAME(chip, &f);
+}
+
+/**
+ * Data rate in baud, from the DRATE_E/DRATE_M fields of MDMCFG4/MDMCFG3.
+ */
+uint32_t SIM_CC_BAUD( const SIM_cc2500_t* chip )
+{
+    uint64_t m = 256 + chip->reg[R_MDMCFG3];
+    uint8_t e = chip->reg[R_MDMCFG4] & 0x0F;
+
+    return (uint32_t)((m * (1ULL << e) * 26000000ULL) >> 28);
+}
+
+/**
+ * Weakest frame (dBm) the receiver locks onto at a data rate, after the
+ * CC2500 datasheet's sensitivity at 1% packet error rate.
+ */
+int8_t SIM_CC_SENS_DBM( uint32_t baud )
+{
+    if(baud <= 12000)
+        {
+            return -100;
+        }
+    if(baud <= 300000)
+        {
+            return -88;
+        }
+    return -82;
+}
+
+/**
+ * Time on air for a frame with the given number of data bytes, including
+ * preamble, sync word, CRC and FEC encoding.
+ */
+uint64_t SIM_CC_AIRTIME( const SIM_cc2500_t* chip, uint16_t dataLen )
+{
+    uint16_t n = dataLen;
+
+    if(chip->reg[R_PKTCTRL0] & 0x04)
+        {
+            n += 2;
+        }
+
+    // FEC encodes whole 16-bit words
+    if(chip->reg[R_MDMCFG1] & 0x80)
+        {
+            n += n & 1;
+        }
+
+    return SIM_CC_SYNC_PS(chip) + (uint64_t)n * SIM_CC_DATA_BYTE_PS(chip);
+}
+
+/**
+ * Output power (dBm) of the PATABLE entry selected by FREND0.PA_POWER.
+ */
+int8_t SIM_CC_TX_DBM( const SIM_cc2500_t* chip )
+{
+    uint8_t pa = chip->patable[chip->reg[R_FREND0] & 0x07];
+    uint8_t i;
+
+    for(i = 0; i < sizeof(SIM_CC_PA_TABLE) / sizeof(SIM_CC_PA_TABLE[0]); i++)
+        {
+            if(SIM_CC_PA_TABLE[i].pa == pa)
+                {
+                    return SIM_CC_PA_TABLE[i].dbm;
+                }
+        }
+
+    return 0;
+}
+
+/**
+ * Supply current (mA) in the chip's present state.
+ */
+double SIM_CC_CURRENT_MA( const SIM_cc2500_t* chip )
+{
+    uint8_t pa;
+    uint8_t i;
+
+    switch(chip->marc)
+        {
+        case SIM_MARC_SLEEP:
+            if(chip->readyAt)
+                {
+                    return SIM_CC_PWR_MA[SIM_CC_PWR_XOFF];
+                }
+            return chip->wor ? SIM_CC_WOR_MA : SIM_CC_PWR_MA[SIM_CC_PWR_SLEEP];
+        case SIM_MARC_XOFF:
+            return SIM_CC_PWR_MA[SIM_CC_PWR_XOFF];
+        case SIM_MARC_IDLE:
+        case SIM_MARC_RXFIFO_OVF:
+        case SIM_MARC_TXFIFO_UNF:
+            return SIM_CC_PWR_MA[SIM_CC_PWR_IDLE];
+        case SIM_MARC_RX:
+            return SIM_CC_PWR_MA[SIM_CC_PWR_RX];
+        case SIM_MARC_TX:
+            pa = chip->patable[chip->reg[R_FREND0] & 0x07];
+            for(i = 0; i < sizeof(SIM_CC_PA_TABLE) / sizeof(SIM_CC_PA_TABLE[0]); i++)
+                {
+                    if(SIM_CC_PA_TABLE[i].pa == pa)
+                        {
+                            return SIM_CC_PA_TABLE[i].ma;
+                        }
+                }
+            return SIM_CC_PWR_MA[SIM_CC_PWR_TX];
+        default:
+            return SIM_CC_PWR_MA[SIM_CC_PWR_FS];
+        }
+}
+
+/**
+ * Chip status byte as returned on SO during every header and write byte.
+ *
+ * @param read Non-zero for a read access (FIFO_BYTES_AVAILABLE counts RX
+ *				FIFO bytes), zero for a write (free TX FIFO bytes).
+ */
+uint8_t SIM_CC_STATUS( const SIM_cc2500_t* chip, uint8_t read )
+{
+    uint8_t state;
+    uint8_t bytes;
+
+    switch(chip->marc)
+        {
+        case SIM_MARC_RX:
+            state = 1;
+            break;
+        case SIM_MARC_TX:
+            state = 2;
+            break;
+        case SIM_MARC_FSTXON:
+            state = 3;
+            break;
+        case SIM_MARC_MANCAL:
+        case SIM_MARC_STARTCAL:
+            state = 4;
+            break;
+        case SIM_MARC_FS_LOCK:
+        case SIM_MARC_TXRX_SWITCH:
+        case SIM_MARC_RXTX_SWITCH:
+            state = 5;
+            break;
+        case SIM_MARC_RXFIFO_OVF:
+            state = 6;
+            break;
+        case SIM_MARC_TXFIFO_UNF:
+            state = 7;
+            break;
+        default:
+            state = 0;
+            break;
+        }
+
+    bytes = read ? chip->rxCount : (uint8_t)(SIM_CC_FIFO_LEN - chip->txCount);
+    if(bytes > 15)
+        {
+            bytes = 15;
+        }
+
+    return (chip->ready ? 0x00 : 0x80) | (state << 4) | bytes;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// Local functions
+///////////////////////////////////////////////////////////////////////////////
+
+/**
+ * Enter a state immediately and run its entry actions.
+ */
+static void SIM_CC_ENTER( SIM_cc2500_t* c, uint8_t marc, uint64_t now )
+{
+    c->marc = marc;
+
+    switch(marc)
+        {
+        case SIM_MARC_RX:
+            c->offFreq = !SIM_CC_CAL_OK(c);
+            c->stats.uncalibrated += c->offFreq;
+            c->rxActive = 0;
+            c->rxSince = now;
+            c->rxTimeoutAt = 0;
+
+            // MCSM2.RX_TIME limits the sync search of a WOR RX period. The
+            //	timeout is a fraction of Event 0 that halves with each step.
+            if(c->worRx && (c->reg[R_MCSM2] & 0x07) != 0x07)
+                {
+                    static const uint32_t rxTime0[4] = {36058, 180288, 324519, 468750};
+                    uint16_t evt0 = ((uint16_t)c->reg[R_WOREVT1] << 8) | c->reg[R_WOREVT0];
+
+                    c->rxTimeoutAt = now + (((uint64_t)evt0 * rxTime0[c->reg[R_WORCTRL] & 0x03] * 100)
+                                            >> (c->reg[R_MCSM2] & 0x07));
+                }
+            c->worRx = 0;
+            break;
+
+        case SIM_MARC_TX:
+            c->offFreq = !SIM_CC_CAL_OK(c);
+            c->stats.uncalibrated += c->offFreq;
+            memset(&c->txFrame, 0, offsetof(SIM_frame_t, data));
+            c->txFrame.start = now;
+            c->txFrame.baud = SIM_CC_BAUD(c);
+            c->txFrame.sync = ((uint16_t)c->reg[R_SYNC1] << 8) | c->reg[R_SYNC0];
+            c->txFrame.chan = c->reg[R_CHANNR];
+            c->txFrame.fec = !!(c->reg[R_MDMCFG1] & 0x80);
+            c->txFrame.crcOk = 1;
+            c->txFrame.calOk = !c->offFreq;
+            c->txFrame.dbm = SIM_CC_TX_DBM(c);
+            c->txFrame.src = c;
+            c->txLen = 0;
+            c->txSyncAt = now + SIM_CC_SYNC_PS(c);
+            c->txNextAt = c->txSyncAt;
+            c->txEndAt = 0;
+            c->syncFlag = 0;
+            break;
+
+        case SIM_MARC_IDLE:
+            c->syncFlag = 0;
+            c->rxActive = 0;
+            c->rxTimeoutAt = 0;
+            break;
+
+        default:
+            break;
+        }
+}
+
+/**
+ * Start a transitional state that ends in the given state after dly.
+ */
+static void SIM_CC_GOTO( SIM_cc2500_t* c, uint8_t marc, uint64_t dly,
+                         uint64_t now )
+{
+    c->marcNext = marc;
+    c->evtAt = now + dly;
+}
+
+/**
+ * Leave RX/TX for IDLE, calibrating on the way if FS_AUTOCAL asks for it.
+ */
+static void SIM_CC_LEAVE_ACTIVE( SIM_cc2500_t* c, uint64_t now )
+{
+    uint8_t autocal = (c->reg[R_MCSM0] >> 4) & 0x03;
+
+    c->rxActive = 0;
+    c->syncFlag = 0;
+
+    if(2 == autocal || (3 == autocal && !(c->stats.txFrames & 0x03)))
+        {
+            SIM_CC_CALIBRATE(c);
+            c->marc = SIM_MARC_MANCAL;
+            SIM_CC_GOTO(c, SIM_MARC_IDLE, SIM_CC_CAL_PS, now);
+        }
+    else
+        {
+            SIM_CC_ENTER(c, SIM_MARC_IDLE, now);
+        }
+}
+
+/**
+ * Start the synthesizer from IDLE towards RX, TX or FSTXON.
+ */
+static void SIM_CC_START_ACTIVE( SIM_cc2500_t* c, uint8_t target, uint64_t now )
+{
+    if(1 == ((c->reg[R_MCSM0] >> 4) & 0x03))
+        {
+            SIM_CC_CALIBRATE(c);
+            c->marc = SIM_MARC_STARTCAL;
+            SIM_CC_GOTO(c, target, SIM_CC_CAL_PS + SIM_CC_SETTLE_PS, now);
+        }
+    else
+        {
+            c->marc = SIM_MARC_FS_LOCK;
+            SIM_CC_GOTO(c, target, SIM_CC_SETTLE_PS, now);
+        }
+}
+
+/**
+ * Execute a command strobe.
+ */
+static void SIM_CC_STROBE( SIM_cc2500_t* c, uint8_t cmd, uint64_t now )
+{
+    c->stats.strobes++;
+    c->stats.strobeHist[cmd - 0x30]++;
+
+    switch(cmd)
+        {
+        case 0x30: // SRES
+            memcpy(c->reg, SIM_CC_RESET_REGS, SIM_CC_REG_COUNT);
+            memset(c->patable, 0, sizeof(c->patable));
+            c->patable[0] = 0xC6;
+            c->txCount = c->txHead = 0;
+            c->rxCount = c->rxHead = 0;
+            c->rxActive = 0;
+            c->syncFlag = c->crcOkFlag = c->eopFlag = 0;
+            c->evtAt = 0;
+            c->wor = 0;
+            c->marc = SIM_MARC_IDLE;
+            c->ready = 0;
+            c->readyAt = now + SIM_CC_RESET_PS;
+            break;
+
+        case 0x31: // SFSTXON
+            if(SIM_MARC_IDLE == c->marc)
+                {
+                    SIM_CC_START_ACTIVE(c, SIM_MARC_FSTXON, now);
+                }
+            else if(SIM_MARC_RX == c->marc || SIM_MARC_TX == c->marc)
+                {
+                    SIM_CC_ENTER(c, SIM_MARC_FSTXON, now);
+                }
+            break;
+
+        case 0x32: // SXOFF
+            if(SIM_MARC_IDLE == c->marc)
+                {
+                    c->pendingOff = SIM_MARC_XOFF;
+                    c->wor = 0;
+                }
+            break;
+
+        case 0x33: // SCAL
+            if(SIM_MARC_IDLE == c->marc)
+                {
+                    SIM_CC_CALIBRATE(c);
+                    c->marc = SIM_MARC_MANCAL;
+                    SIM_CC_GOTO(c, SIM_MARC_IDLE, SIM_CC_CAL_PS, now);
+                }
+            break;
+
+        case 0x34: // SRX
+            if(SIM_MARC_IDLE == c->marc)
+                {
+                    SIM_CC_START_ACTIVE(c, SIM_MARC_RX, now);
+                }
+            else if(SIM_MARC_FSTXON == c->marc)
+                {
+                    SIM_CC_GOTO(c, SIM_MARC_RX, SIM_CC_FSTXON_PS, now);
+                }
+            else if(SIM_MARC_TX == c->marc)
+                {
+                    c->marc = SIM_MARC_TXRX_SWITCH;
+                    c->syncFlag = 0;
+                    SIM_CC_GOTO(c, SIM_MARC_RX, SIM_CC_TXRX_PS, now);
+                }
+            break;
+
+        case 0x35: // STX
+            if(SIM_MARC_IDLE == c->marc)
+                {
+                    SIM_CC_START_ACTIVE(c, SIM_MARC_TX, now);
+                }
+            else if(SIM_MARC_FSTXON == c->marc)
+                {
+                    SIM_CC_GOTO(c, SIM_MARC_TX, SIM_CC_FSTXON_PS, now);
+                }
+            else if(SIM_MARC_RX == c->marc)
+                {
+                    // With CCA enabled the radio stays in RX on a busy channel
+                    if(!((c->reg[R_MCSM1] >> 4) & 0x03) || SIM_CC_CLEAR(c, now))
+                        {
+                            c->marc = SIM_MARC_RXTX_SWITCH;
+                            c->rxActive = 0;
+                            c->syncFlag = 0;
+                            SIM_CC_GOTO(c, SIM_MARC_TX, SIM_CC_RXTX_PS, now);
+                        }
+                }
+            break;
+
+        case 0x36: // SIDLE
+            if(SIM_MARC_SLEEP != c->marc && SIM_MARC_XOFF != c->marc)
+                {
+                    c->evtAt = 0;
+                    c->wor = 0;
+                    SIM_CC_ENTER(c, SIM_MARC_IDLE, now);
+                }
+            break;
+
+        case 0x38: // SWOR, needs the RC oscillator (WORCTRL.RC_PD = 0)
+            if(SIM_MARC_IDLE == c->marc && !(c->reg[R_WORCTRL] & 0x80))
+                {
+                    c->pendingOff = SIM_MARC_SLEEP;
+                    c->wor = 1;
+                    c->worWake = 0;
+                    SIM_CC_WOR_SCHEDULE(c, now);
+                }
+            break;
+
+        case 0x39: // SPWD
+            if(SIM_MARC_IDLE == c->marc)
+                {
+                    c->pendingOff = SIM_MARC_SLEEP;
+                    c->wor = 0;
+                }
+            break;
+
+        case 0x3A: // SFRX
+            if(SIM_MARC_IDLE == c->marc || SIM_MARC_RXFIFO_OVF == c->marc)
+                {
+                    c->rxCount = c->rxHead = 0;
+                    c->rxPktBytes = 0;
+                    c->crcOkFlag = c->eopFlag = 0;
+                    c->marc = SIM_MARC_IDLE;
+                }
+            break;
+
+        case 0x3B: // SFTX
+            if(SIM_MARC_IDLE == c->marc || SIM_MARC_TXFIFO_UNF == c->marc)
+                {
+                    c->txCount = c->txHead = 0;
+                    c->marc = SIM_MARC_IDLE;
+                }
+            break;
+
+        case 0x3C: // SWORRST
+            if(c->wor)
+                {
+                    SIM_CC_WOR_SCHEDULE(c, now);
+                }
+            break;
+
+        default: // SAFC, SNOP
+            break;
+        }
+}
+
+/**
+ * Ideal calibration results for a channel and temperature. FSCAL1 (VCO
+ * capacitor array) moves with both; a value off by more than one step leaves
+ * the synthesizer unable to lock on the wanted frequency.
+ */
+static uint8_t SIM_CC_FSCAL1_FOR( uint8_t chan, int8_t temp )
+{
+    return (uint8_t)((0x10 + chan / 16 + (temp + 40) / 8) & 0x3F);
+}
+
+static uint8_t SIM_CC_FSCAL3_FOR( uint8_t chan )
+{
+    return (uint8_t)(0x08 + chan / 64);
+}
+
+/**
+ * Run a synthesizer calibration: write the results into FSCAL3..1.
+ */
+static void SIM_CC_CALIBRATE( SIM_cc2500_t* c )
+{
+    uint8_t chan = c->reg[R_CHANNR];
+
+    c->reg[R_FSCAL3] = (c->reg[R_FSCAL3] & 0xF0) | SIM_CC_FSCAL3_FOR(chan);
+    c->reg[R_FSCAL2] = 0x0A;
+    c->reg[R_FSCAL1] = SIM_CC_FSCAL1_FOR(chan, SIM_CC_tempC);
+    c->calChan = chan;
+    c->calTemp = SIM_CC_tempC;
+    c->stats.calibrations++;
+}
+
+/**
+ * Check whether the FSCAL registers hold usable values for the current
+ * channel and temperature.
+ */
+static uint8_t SIM_CC_CAL_OK( const SIM_cc2500_t* c )
+{
+    uint8_t chan = c->reg[R_CHANNR];
+    int16_t d = (int16_t)c->reg[R_FSCAL1] - SIM_CC_FSCAL1_FOR(chan, SIM_CC_tempC);
+
+    return (0x0A == c->reg[R_FSCAL2])
+           && ((c->reg[R_FSCAL3] & 0x0F) == SIM_CC_FSCAL3_FOR(chan))
+           && d >= -1 && d <= 1;
+}
+
+/**
+ * Clear channel assessment as selected by MCSM1.CCA_MODE.
+ */
+static uint8_t SIM_CC_CLEAR( SIM_cc2500_t* c, uint64_t now )
+{
+    uint8_t mode = (c->reg[R_MCSM1] >> 4) & 0x03;
+    uint8_t quiet = !SIM_CC_air.rssi || SIM_CC_air.rssi(c, now) < SIM_CC_CS_DBM;
+
+    switch(mode)
+        {
+        case 1:
+            return quiet;
+        case 2:
+            return !c->rxActive;
+        case 3:
+            return quiet && !c->rxActive;
+        default:
+            return 1;
+        }
+}
+
+/**
+ * Integrate state time and energy up to now.
+ */
+static void SIM_CC_ACCOUNT( SIM_cc2500_t* c, uint64_t now )
+{
+    uint64_t dt;
+    uint8_t grp;
+
+    if(now <= c->lastAcct)
+        {
+            return;
+        }
+
+    dt = now - c->lastAcct;
+    c->lastAcct = now;
+
+    switch(c->marc)
+        {
+        case SIM_MARC_SLEEP:
+            grp = c->readyAt ? SIM_CC_PWR_XOFF : SIM_CC_PWR_SLEEP;
+            break;
+        case SIM_MARC_XOFF:
+            grp = SIM_CC_PWR_XOFF;
+            break;
+        case SIM_MARC_IDLE:
+        case SIM_MARC_RXFIFO_OVF:
+        case SIM_MARC_TXFIFO_UNF:
+            grp = SIM_CC_PWR_IDLE;
+            break;
+        case SIM_MARC_RX:
+            grp = SIM_CC_PWR_RX;
+            break;
+        case SIM_MARC_TX:
+            grp = SIM_CC_PWR_TX;
+            break;
+        default:
+            grp = SIM_CC_PWR_FS;
+            break;
+        }
+
+    c->stats.statePs[grp] += dt;
+    c->stats.energyNj += (double)dt * SIM_CC_CURRENT_MA(c) * SIM_CC_SUPPLY_V * 1e-6;
+}
+
+/**
+ * Drop the frame being received and go back to searching for sync.
+ */
+static void SIM_CC_RX_ABORT( SIM_cc2500_t* c )
+{
+    // Remove the partial packet from the tail of the RX FIFO
+    c->rxCount -= c->rxPktBytes;
+    c->rxPktBytes = 0;
+    c->rxActive = 0;
+    c->rxNextAt = 0;
+    c->syncFlag = 0;
+    c->stats.rxDiscarded++;
+}
+
+static void SIM_CC_RX_PUSH( SIM_cc2500_t* c, uint8_t b )
+{
+    c->rxFifo[(c->rxHead + c->rxCount) % SIM_CC_FIFO_LEN] = b;
+    c->rxCount++;
+    c->rxPktBytes++;
+}
+
+/**
+ * Duration of preamble and sync word.
+ */
+static uint64_t SIM_CC_SYNC_PS( const SIM_cc2500_t* c )
+{
+    static const uint8_t preamble[8] = {2, 3, 4, 6, 8, 12, 16, 24};
+    uint8_t syncMode = c->reg[R_MDMCFG2] & 0x07;
+    uint8_t n = preamble[(c->reg[R_MDMCFG1] >> 4) & 0x07];
+    uint64_t bytePs = 8000000000000ULL / SIM_CC_BAUD(c);
+
+    if(syncMode & 0x03)
+        {
+            n += ((syncMode & 0x03) == 3) ? 4 : 2;
+        }
+
+    if(c->reg[R_MDMCFG2] & 0x08)
+        {
+            bytePs *= 2; // Manchester
+        }
+
+    return n * bytePs;
+}
+
+/**
+ * Duration of one data byte, after FEC and Manchester encoding.
+ */
+static uint64_t SIM_CC_DATA_BYTE_PS( const SIM_cc2500_t* c )
+{
+    uint64_t bytePs = 8000000000000ULL / SIM_CC_BAUD(c);
+
+    if(c->reg[R_MDMCFG2] & 0x08)
+        {
+            bytePs *= 2;
+        }
+
+    if(c->reg[R_MDMCFG1] & 0x80)
+        {
+            bytePs *= 2;
+        }
+
+    return bytePs;
+}
+
+/**
+ * Power down to SLEEP or XOFF. PATABLE and test registers are not retained
+ * in SLEEP.
+ */
+static void SIM_CC_POWER_DOWN( SIM_cc2500_t* c, uint8_t marc )
+{
+    c->marc = marc;
+    c->ready = 0;
+    c->readyAt = 0;
+    c->rxActive = 0;
+    c->syncFlag = 0;
+    c->rxTimeoutAt = 0;
+
+    if(SIM_MARC_SLEEP == marc)
+        {
+            memset(c->patable, 0, sizeof(c->patable));
+            memcpy(&c->reg[0x29], &SIM_CC_RESET_REGS[0x29], 6);
+        }
+}
+
+/**
+ * Event 0 period: EVENT0 * 750 / fXOSC * 2^(5 * WOR_RES).
+ */
+static uint64_t SIM_CC_EVENT0_PS( const SIM_cc2500_t* c )
+{
+    uint16_t evt0 = ((uint16_t)c->reg[R_WOREVT1] << 8) | c->reg[R_WOREVT0];
+
+    return (uint64_t)evt0 * ((750000000ULL << (5 * (c->reg[R_WORCTRL] & 0x03))) / 26);
+}
+
+/**
+ * Schedule the next Event 0 one period after from, and the Event 1 that
+ * precedes it by WORCTRL.EVENT1 RC oscillator periods.
+ */
+static void SIM_CC_WOR_SCHEDULE( SIM_cc2500_t* c, uint64_t from )
+{
+    static const uint8_t evt1[8] = {4, 6, 8, 12, 16, 24, 32, 48};
+    uint64_t lead = evt1[(c->reg[R_WORCTRL] >> 4) & 0x07] * SIM_CC_RC_PS;
+    uint64_t period = SIM_CC_EVENT0_PS(c);
+
+    c->worEvt0At = from + (period ? period : SIM_CC_RC_PS);
+    c->worEvt1At = (c->worEvt0At - from > lead) ? c->worEvt0At - lead : from + 1;
+}
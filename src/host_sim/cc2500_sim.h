@@ -0,0 +1,242 @@
+/**
+ * @brief Timing model of the CC2500 transceiver for host-side benchmarking
+ *
+ * Models the SPI command interface, configuration/status registers, PATABLE,
+ * 64-byte TX and RX FIFOs, chip status byte, MARCSTATE machine, GDO outputs
+ * and the packet handler, with every state transition and FIFO byte placed
+ * on the simulator time line (picoseconds). Radio energy is integrated from
+ * typical datasheet currents for each state.
+ *
+ * @file cc2500_sim.h
+ * @author Aaron Parks, UW Sensor Systems Laboratory
+ * @version 1.0
+ */
+
+/*---------------------Include Guard-----------------------------------------*/
+#ifndef CC2500_SIM_H
+#define CC2500_SIM_H
+/*---------------------------------------------------------------------------*/
+
+///////////////////////////////////////////////////////////////////////////////
+/// Includes
+///////////////////////////////////////////////////////////////////////////////
+#include <stdint.h>
+
+///////////////////////////////////////////////////////////////////////////////
+/// Model constants
+///////////////////////////////////////////////////////////////////////////////
+
+#define SIM_CC_FIFO_LEN			64		// Bytes in each of the TX/RX FIFOs
+#define SIM_CC_REG_COUNT		0x2F	// Configuration registers 0x00 to 0x2E
+#define SIM_CC_AIR_QUEUE		32		// Frames that may be pending on the air
+#define SIM_CC_FRAME_MAX		256		// Largest frame: length byte + 255
+
+// MARCSTATE values (CC2500 datasheet, MARCSTATE register)
+#define SIM_MARC_SLEEP			0x00
+#define SIM_MARC_IDLE			0x01
+#define SIM_MARC_XOFF			0x02
+#define SIM_MARC_MANCAL			0x05
+#define SIM_MARC_STARTCAL		0x08
+#define SIM_MARC_FS_LOCK		0x0A
+#define SIM_MARC_RX				0x0D
+#define SIM_MARC_TXRX_SWITCH	0x10
+#define SIM_MARC_RXFIFO_OVF		0x11
+#define SIM_MARC_FSTXON			0x12
+#define SIM_MARC_TX				0x13
+#define SIM_MARC_RXTX_SWITCH	0x15
+#define SIM_MARC_TXFIFO_UNF		0x16
+
+#define SIM_CC_OFF_NONE			0xFF	// No power-down pending
+
+// Power groups used for time and energy accounting
+enum SIM_cc_pwr_e
+{
+    SIM_CC_PWR_SLEEP,
+    SIM_CC_PWR_XOFF,
+    SIM_CC_PWR_IDLE,
+    SIM_CC_PWR_FS,		// Calibration, settling, FSTXON and RX/TX turnaround
+    SIM_CC_PWR_RX,
+    SIM_CC_PWR_TX,
+    SIM_CC_PWR_COUNT
+};
+
+///////////////////////////////////////////////////////////////////////////////
+/// Types
+///////////////////////////////////////////////////////////////////////////////
+
+/**
+ * A frame on the air. Produced by a transmitting chip at the end of TX and
+ * handed to receiving chips by the channel model.
+ */
+typedef struct SIM_frame_s
+{
+    uint64_t start;		// Time the first preamble bit went on air (ps)
+    uint64_t syncEnd;	// Time the last sync bit went on air (ps)
+    uint64_t end;		// Time the last CRC bit went on air (ps)
+    uint32_t baud;		// Data rate of the transmitter
+    uint16_t sync;		// SYNC1:SYNC0 of the transmitter
+    uint8_t  chan;		// CHANNR of the transmitter
+    uint8_t  fec;		// Transmitted with FEC/interleaving
+    uint8_t  crcOk;		// Cleared by the channel when the frame is corrupted
+    uint8_t  calOk;		// Transmitter synthesizer was calibrated for chan
+    int8_t   dbm;		// Transmit power; the channel replaces it with RSSI
+    uint8_t  lqi;		// Link quality estimate at the receiver
+    uint16_t len;		// Data bytes (length/address/payload, no CRC)
+    uint8_t  data[SIM_CC_FRAME_MAX];
+    void*    src;		// Transmitting chip (or channel node) for bookkeeping
+} SIM_frame_t;
+
+/**
+ * Per-chip counters. Everything is cumulative; benchmarks take differences.
+ */
+typedef struct SIM_cc_stats_s
+{
+    uint32_t spiTxns;		// ~CS low periods
+    uint32_t spiBytes;		// Bytes clocked while ~CS was low
+    uint32_t strobes;		// Command strobes executed
+    uint32_t strobeHist[16];// Per-strobe counts, indexed by (cmd - 0x30)
+    uint32_t regWrites;		// Configuration register/PATABLE bytes written
+    uint32_t regReads;		// Configuration/status register bytes read
+    uint32_t txFifoBytes;	// Bytes written to the TX FIFO
+    uint32_t rxFifoBytes;	// Bytes read from the RX FIFO
+    uint32_t notReady;		// Bytes clocked before CHIP_RDYn went low
+    uint32_t txFrames;		// Frames completely transmitted
+    uint32_t txUnderflows;	// TX FIFO underflows
+    uint32_t rxFrames;		// Frames completely received into the RX FIFO
+    uint32_t rxDiscarded;	// Frames dropped by address/length/CRC filtering
+    uint32_t rxOverflows;	// RX FIFO overflows
+    uint32_t rxMissed;		// Frames on air the chip could not lock onto
+    uint32_t calibrations;	// Synthesizer calibrations (manual or automatic)
+    uint32_t uncalibrated;	// RX/TX entries with stale FSCAL values
+    uint32_t worWakeups;	// RX periods started by WOR Event 0
+    uint32_t worTimeouts;	// WOR RX periods ended by RX_TIME without sync
+    uint64_t csLowPs;		// Total time with ~CS low
+    uint64_t statePs[SIM_CC_PWR_COUNT];	// Time spent in each power group
+    double   energyNj;		// Integrated radio energy
+} SIM_cc_stats_t;
+
+typedef struct SIM_cc2500_s
+{
+    // Register file and memories
+    uint8_t  reg[SIM_CC_REG_COUNT];
+    uint8_t  patable[8];
+    uint8_t  paIndex;
+    uint8_t  txFifo[SIM_CC_FIFO_LEN];
+    uint8_t  txHead, txCount;
+    uint8_t  rxFifo[SIM_CC_FIFO_LEN];
+    uint8_t  rxHead, rxCount;
+
+    // Main radio control state machine
+    uint8_t  marc;			// Current MARCSTATE
+    uint8_t  marcNext;		// State entered when evtAt expires
+    uint64_t evtAt;			// End of the current transitional state (0 = none)
+    uint64_t readyAt;		// Time CHIP_RDYn goes low after a wake-up
+    uint8_t  ready;			// Crystal running and chip ready
+    uint8_t  pendingOff;	// SPWD/SXOFF/SWOR state waiting for ~CS high
+    uint8_t  csLow;
+
+    // SPI command decoder
+    uint8_t  hdrPending;	// Next byte on the bus is a header byte
+    uint8_t  addr;
+    uint8_t  burst;
+    uint8_t  read;
+    uint64_t csLowAt;
+
+    // Synthesizer calibration
+    uint8_t  calChan;
+    int8_t   calTemp;
+    uint8_t  offFreq;		// Current RX/TX session is using stale FSCAL values
+
+    // Wake-on-Radio
+    uint8_t  wor;			// Automatic RX polling started by SWOR
+    uint8_t  worWake;		// Crystal started by Event 1 for the coming Event 0
+    uint8_t  worRx;			// Next RX entry is a WOR RX period
+    uint64_t worEvt0At;		// Next Event 0 (start RX)
+    uint64_t worEvt1At;		// Next Event 1 (start crystal), 0 once passed
+    uint64_t rxTimeoutAt;	// End of the RX_TIME sync search (0 = none)
+    uint64_t rxSince;		// Time RX was last entered
+
+    // Transmitter
+    uint64_t txSyncAt;		// End of preamble/sync of the frame being sent
+    uint64_t txNextAt;		// Time the next data byte leaves the TX FIFO
+    uint64_t txEndAt;		// End of CRC for the frame being sent (0 = open)
+    uint16_t txLen;			// Data bytes in frame (0 = not yet known)
+    SIM_frame_t txFrame;
+
+    // Receiver
+    SIM_frame_t air[SIM_CC_AIR_QUEUE];	// Frames announced by the channel
+    uint8_t  airCount;
+    uint8_t  rxActive;		// Locked onto a frame
+    SIM_frame_t rxFrame;
+    uint16_t rxPos;			// Data bytes of rxFrame already in the FIFO
+    uint16_t rxLen;			// Data bytes expected for rxFrame
+    uint8_t  rxPktBytes;	// FIFO bytes belonging to the frame in progress
+    uint64_t rxNextAt;		// Arrival time of the next data byte
+    uint64_t rxEndAt;		// End of CRC / status append for rxFrame
+    uint8_t  rssi;			// RSSI register (offset two's complement)
+    uint8_t  lqi;			// LQI register
+
+    // GDO related flags
+    uint8_t  syncFlag;		// Sync word sent/received, cleared at end of packet
+    uint8_t  crcOkFlag;		// Packet received with CRC OK, cleared on FIFO read
+    uint8_t  eopFlag;		// End of packet reached, cleared when RX FIFO empty
+    uint8_t  txUnfFlag;
+    uint8_t  rxOvfFlag;
+
+    // Accounting
+    uint64_t lastAcct;
+    SIM_cc_stats_t stats;
+    void*    user;			// Owner (channel node, harness, ...)
+} SIM_cc2500_t;
+
+/**
+ * Channel interface. A chip that finishes a transmission hands the frame to
+ * SIM_CC_air.tx; clear channel assessment asks SIM_CC_air.rssi for the
+ * strongest signal on the chip's channel at the given time.
+ */
+typedef struct SIM_cc_air_s
+{
+    void   (*tx)( SIM_cc2500_t* chip, const SIM_frame_t* frame );
+    int8_t (*rssi)( SIM_cc2500_t* chip, uint64_t t );
+} SIM_cc_air_t;
+
+extern SIM_cc_air_t SIM_CC_air;
+
+// Temperature seen by the synthesizer (degC). Drives calibration validity.
+extern int8_t SIM_CC_tempC;
+
+///////////////////////////////////////////////////////////////////////////////
+/// Prototypes
+///////////////////////////////////////////////////////////////////////////////
+
+// Power-on reset of the chip model at time now
+void SIM_CC_INIT( SIM_cc2500_t* chip, uint64_t now );
+// ~CS line edge
+void SIM_CC_CS( SIM_cc2500_t* chip, uint8_t low, uint64_t now );
+// Exchange one byte on the SPI bus (~CS must be low)
+uint8_t SIM_CC_SPI( SIM_cc2500_t* chip, uint8_t mosi, uint64_t now );
+// Level of the SO pin (CHIP_RDYn while ~CS low, GDO1 otherwise)
+uint8_t SIM_CC_SO( SIM_cc2500_t* chip );
+// Level of GDO0 or GDO2
+uint8_t SIM_CC_GDO( SIM_cc2500_t* chip, uint8_t n );
+// Time of the next internal event, or UINT64_MAX
+uint64_t SIM_CC_NEXT( SIM_cc2500_t* chip );
+// Process every internal event up to and including now
+void SIM_CC_UPDATE( SIM_cc2500_t* chip, uint64_t now );
+// Announce a frame arriving over the air
+void SIM_CC_RX_FRAME( SIM_cc2500_t* chip, const SIM_frame_t* frame );
+// Announce a reply to a frame, e.g. an ACK, starting delay ps after its end
+void SIM_CC_REPLY( SIM_cc2500_t* chip, const SIM_frame_t* to, const uint8_t* data,
+                   uint16_t len, uint64_t delay, int8_t dbm );
+
+// Derived radio parameters, decoded from the register file
+uint32_t SIM_CC_BAUD( const SIM_cc2500_t* chip );
+int8_t   SIM_CC_SENS_DBM( uint32_t baud );
+uint64_t SIM_CC_AIRTIME( const SIM_cc2500_t* chip, uint16_t dataLen );
+int8_t   SIM_CC_TX_DBM( const SIM_cc2500_t* chip );
+double   SIM_CC_CURRENT_MA( const SIM_cc2500_t* chip );
+uint8_t  SIM_CC_STATUS( const SIM_cc2500_t* chip, uint8_t read );
+
+///////////////////////////////////////////////////////////////////////////////
+#endif /* CC2500_SIM_H */
+///////////////////////////////////////////////////////////////////////////////
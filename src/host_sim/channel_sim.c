@@ -0,0 +1,431 @@
+/**
+ * @brief Shared-medium channel model for multi-node benchmarks
+ *
+ * Frames are generated ahead of the receiver's clock, far enough that every
+ * frame able to overlap the next one to be delivered is already known. The
+ * fate of a frame (collision, bit errors) is decided when it is queued on
+ * the receiving chip, which locks onto it at the end of its sync word.
+ *
+ * @file channel_sim.c
+ * @author Aaron Parks, UW Sensor Systems Laboratory
+ * @version 1.0
+ */
+
+///////////////////////////////////////////////////////////////////////////////
+/// Includes
+///////////////////////////////////////////////////////////////////////////////
+#include "channel_sim.h"
+#include "sim.h"
+#include <math.h>
+#include <string.h>
+
+///////////////////////////////////////////////////////////////////////////////
+/// Local types
+///////////////////////////////////////////////////////////////////////////////
+
+typedef struct SIM_chan_node_s
+{
+    uint64_t	period;		// Frame period including this node's clock error
+    uint64_t	next;		// Start of the next frame
+    int8_t		dbm;		// Level at the receiver
+    uint16_t	seq;		// Sequence number of the next frame
+    uint16_t	counted[SIM_CHAN_HISTORY];	// Delivered sequence numbers + 1
+} SIM_chan_node_t;
+
+typedef struct SIM_chan_air_s
+{
+    SIM_frame_t	f;
+    uint16_t	node;
+    uint8_t		injected;
+} SIM_chan_air_t;
+
+///////////////////////////////////////////////////////////////////////////////
+/// Local state
+///////////////////////////////////////////////////////////////////////////////
+SIM_chan_stats_t SIM_CHAN_stats;
+
+static SIM_chan_cfg_t	SIM_CHAN_cfg;
+static SIM_chan_node_t	SIM_CHAN_node[SIM_CHAN_NODES_MAX];
+static SIM_chan_air_t	SIM_CHAN_air[SIM_CHAN_AIR_MAX];
+static uint16_t			SIM_CHAN_airCount;
+static uint64_t			SIM_CHAN_airtime;
+static uint32_t			SIM_CHAN_prng;
+
+///////////////////////////////////////////////////////////////////////////////
+/// Local prototypes
+///////////////////////////////////////////////////////////////////////////////
+static void SIM_CHAN_TAG( uint8_t* data, uint16_t node, uint16_t seq );
+static SIM_chan_air_t* SIM_CHAN_PENDING( void );
+static uint64_t SIM_CHAN_NEXT_START( void );
+static void SIM_CHAN_GENERATE( uint64_t horizon );
+static void SIM_CHAN_FATE( const SIM_chan_air_t* a, SIM_frame_t* f );
+static int8_t SIM_CHAN_RSSI( SIM_cc2500_t* chip, uint64_t t );
+static void SIM_CHAN_TX( SIM_cc2500_t* chip, const SIM_frame_t* frame );
+
+///////////////////////////////////////////////////////////////////////////////
+
+/**
+ * Set up the node population. Every node starts at a random phase within one
+ * period so that the population is not synchronized.
+ */
+void SIM_CHAN_INIT( const SIM_chan_cfg_t* cfg )
+{
+    uint16_t i;
+    SIM_chan_node_t* n;
+
+    SIM_CHAN_cfg = *cfg;
+    SIM_CHAN_prng = cfg->seed ? cfg->seed : 1;
+    SIM_CHAN_airCount = 0;
+    SIM_CHAN_airtime = cfg->tmpl.end - cfg->tmpl.start;
+    memset(&SIM_CHAN_stats, 0, sizeof(SIM_CHAN_stats));
+
+    if(SIM_CHAN_cfg.nodes > SIM_CHAN_NODES_MAX)
+        {
+            SIM_CHAN_cfg.nodes = SIM_CHAN_NODES_MAX;
+        }
+
+    for(i = 0; i < SIM_CHAN_cfg.nodes; i++)
+        {
+            n = &SIM_CHAN_node[i];
+            n->period = (uint64_t)(cfg->period * (1.0 + cfg->periodTol * (2 * SIM_CHAN_RAND() - 1)));
+            n->next = SIM_now + (uint64_t)(n->period * SIM_CHAN_RAND());
+            n->dbm = (int8_t)(cfg->dbmMin + (int)((cfg->dbmMax - cfg->dbmMin + 1) * SIM_CHAN_RAND()));
+            n->seq = 0;
+            memset(n->counted, 0, sizeof(n->counted));
+        }
+
+    SIM_CC_air.tx = SIM_CHAN_TX;
+    SIM_CC_air.rssi = SIM_CHAN_RSSI;
+}
+
+/**
+ * Advance the receiver to time t. Frames are handed to the receiving chip
+ * ahead of time, as far as its air queue allows, so that transmissions keep
+ * arriving while the receiver firmware is busy in an ISR.
+ */
+void SIM_CHAN_RUN_UNTIL( uint64_t t )
+{
+    uint16_t i;
+    uint16_t j;
+    SIM_chan_air_t* a;
+    SIM_frame_t f;
+    uint64_t first;
+
+    while(SIM_now < t)
+        {
+            while(SIM_radio.airCount < SIM_CC_AIR_QUEUE)
+                {
+                    // Everything that could overlap the next frame to be delivered
+                    a = SIM_CHAN_PENDING();
+                    first = a ? a->f.start : SIM_CHAN_NEXT_START();
+                    if(first >= t)
+                        {
+                            break;
+                        }
+                    SIM_CHAN_GENERATE(first + SIM_CHAN_airtime);
+
+                    a = SIM_CHAN_PENDING();
+                    a->injected = 1;
+
+                    // The air queue ran full while the firmware was busy, and
+                    //	the chip can't lock onto a sync word already past
+                    if(a->f.syncEnd <= SIM_now)
+                        {
+                            SIM_radio.stats.rxMissed++;
+                            continue;
+                        }
+
+                    f = a->f;
+                    SIM_CHAN_FATE(a, &f);
+                    SIM_CC_RX_FRAME(&SIM_radio, &f);
+                }
+
+            if(SIM_radio.airCount == SIM_CC_AIR_QUEUE && SIM_radio.air[0].syncEnd < t)
+                {
+                    SIM_IDLE_UNTIL(SIM_radio.air[0].syncEnd);
+                }
+            else
+                {
+                    SIM_IDLE_UNTIL(t);
+                }
+
+            // Forget frames that can no longer overlap anything pending
+            for(i = j = 0; i < SIM_CHAN_airCount; i++)
+                {
+                    if(!SIM_CHAN_air[i].injected
+                            || SIM_CHAN_air[i].f.end + SIM_CHAN_airtime > SIM_now)
+                        {
+                            SIM_CHAN_air[j++] = SIM_CHAN_air[i];
+                        }
+                }
+            SIM_CHAN_airCount = j;
+        }
+}
+
+/**
+ * Compare a frame received by the application with the frame its node sent.
+ *
+ * @param data	Frame data bytes as received (header and payload)
+ * @param len	Number of data bytes
+ * @return 1 if the frame is intact and delivered for the first time
+ */
+uint8_t SIM_CHAN_DELIVER( const uint8_t* data, uint16_t len )
+{
+    uint16_t p = SIM_CHAN_cfg.idPos;
+    uint16_t id;
+    uint16_t seq;
+    uint8_t expect[SIM_CC_FRAME_MAX];
+    SIM_chan_node_t* n;
+
+    if(len < p + 4 || len != SIM_CHAN_cfg.tmpl.len)
+        {
+            SIM_CHAN_stats.corrupt++;
+            return 0;
+        }
+
+    id = ((uint16_t)data[p] << 8) | data[p + 1];
+    seq = ((uint16_t)data[p + 2] << 8) | data[p + 3];
+    if(id >= SIM_CHAN_cfg.nodes || (uint16_t)(SIM_CHAN_node[id].seq - seq - 1) >= SIM_CHAN_HISTORY)
+        {
+            SIM_CHAN_stats.corrupt++;
+            return 0;
+        }
+
+    n = &SIM_CHAN_node[id];
+    SIM_CHAN_TAG(expect, id, seq);
+    if(memcmp(data, expect, len))
+        {
+            SIM_CHAN_stats.corrupt++;
+            return 0;
+        }
+
+    if(n->counted[seq % SIM_CHAN_HISTORY] == (uint16_t)(seq + 1))
+        {
+            SIM_CHAN_stats.duplicates++;
+            return 0;
+        }
+
+    n->counted[seq % SIM_CHAN_HISTORY] = seq + 1;
+    SIM_CHAN_stats.delivered++;
+    return 1;
+}
+
+/**
+ * xorshift32; reproducible across hosts for a given seed.
+ */
+double SIM_CHAN_RAND( void )
+{
+    SIM_CHAN_prng ^= SIM_CHAN_prng << 13;
+    SIM_CHAN_prng ^= SIM_CHAN_prng >> 17;
+    SIM_CHAN_prng ^= SIM_CHAN_prng << 5;
+
+    return SIM_CHAN_prng / 4294967296.0;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// Local functions
+///////////////////////////////////////////////////////////////////////////////
+
+/**
+ * Frame data sent by a node: the template with node and sequence number.
+ */
+static void SIM_CHAN_TAG( uint8_t* data, uint16_t node, uint16_t seq )
+{
+    uint16_t p = SIM_CHAN_cfg.idPos;
+
+    memcpy(data, SIM_CHAN_cfg.tmpl.data, SIM_CHAN_cfg.tmpl.len);
+    data[p] = (uint8_t)(node >> 8);
+    data[p + 1] = (uint8_t)node;
+    data[p + 2] = (uint8_t)(seq >> 8);
+    data[p + 3] = (uint8_t)seq;
+}
+
+/**
+ * Earliest frame on the air not yet handed to the receiver.
+ */
+static SIM_chan_air_t* SIM_CHAN_PENDING( void )
+{
+    SIM_chan_air_t* a = NULL;
+    uint16_t i;
+
+    for(i = 0; i < SIM_CHAN_airCount; i++)
+        {
+            if(!SIM_CHAN_air[i].injected && (!a || SIM_CHAN_air[i].f.start < a->f.start))
+                {
+                    a = &SIM_CHAN_air[i];
+                }
+        }
+
+    return a;
+}
+
+/**
+ * Start of the next frame not yet generated.
+ */
+static uint64_t SIM_CHAN_NEXT_START( void )
+{
+    uint64_t t = UINT64_MAX;
+    uint16_t i;
+
+    for(i = 0; i < SIM_CHAN_cfg.nodes; i++)
+        {
+            if(SIM_CHAN_node[i].next < t)
+                {
+                    t = SIM_CHAN_node[i].next;
+                }
+        }
+
+    return t;
+}
+
+/**
+ * Put every frame starting before horizon on the air.
+ */
+static void SIM_CHAN_GENERATE( uint64_t horizon )
+{
+    SIM_chan_node_t* n;
+    SIM_chan_air_t* a;
+    uint16_t i;
+    uint16_t best;
+
+    while(SIM_CHAN_cfg.nodes && SIM_CHAN_airCount < SIM_CHAN_AIR_MAX)
+        {
+            best = 0;
+            for(i = 1; i < SIM_CHAN_cfg.nodes; i++)
+                {
+                    if(SIM_CHAN_node[i].next < SIM_CHAN_node[best].next)
+                        {
+                            best = i;
+                        }
+                }
+
+            n = &SIM_CHAN_node[best];
+            if(n->next >= horizon)
+                {
+                    return;
+                }
+
+            a = &SIM_CHAN_air[SIM_CHAN_airCount++];
+            a->f = SIM_CHAN_cfg.tmpl;
+            a->f.start = n->next;
+            a->f.syncEnd = n->next + (SIM_CHAN_cfg.tmpl.syncEnd - SIM_CHAN_cfg.tmpl.start);
+            a->f.end = n->next + SIM_CHAN_airtime;
+            a->f.dbm = n->dbm;
+            a->f.lqi = 5;
+            a->f.crcOk = 1;
+            a->f.src = n;
+            SIM_CHAN_TAG(a->f.data, best, n->seq);
+            a->node = best;
+            a->injected = 0;
+
+            n->seq++;
+            n->next += n->period;
+
+            SIM_CHAN_stats.sent++;
+        }
+}
+
+/**
+ * Decide whether a frame survives overlap and bit errors, and build the
+ * copy the receiver gets, with its data corrupted if not. A frame whose sync
+ * word is hit by a stronger interferer is not detected at all.
+ */
+static void SIM_CHAN_FATE( const SIM_chan_air_t* a, SIM_frame_t* f )
+{
+    double interferenceMw = 0;
+    uint64_t hitFrom = UINT64_MAX;
+    uint64_t hitTo = 0;
+    uint64_t bytePs;
+    uint16_t i;
+    uint16_t first;
+    uint16_t last;
+    uint8_t damaged = 0;
+
+    for(i = 0; i < SIM_CHAN_airCount; i++)
+        {
+            const SIM_frame_t* o = &SIM_CHAN_air[i].f;
+
+            if(o == &a->f || o->chan != f->chan || o->start >= f->end || o->end <= f->start)
+                {
+                    continue;
+                }
+            interferenceMw += pow(10.0, o->dbm / 10.0);
+            if((o->start > f->start ? o->start : f->start) < hitFrom)
+                {
+                    hitFrom = (o->start > f->start) ? o->start : f->start;
+                }
+            if(o->end > hitTo)
+                {
+                    hitTo = o->end;
+                }
+        }
+
+    if(interferenceMw > 0 && f->dbm - 10.0 * log10(interferenceMw) < SIM_CHAN_CAPTURE_DB)
+        {
+            SIM_CHAN_stats.collided++;
+            f->crcOk = 0;
+
+            if(hitFrom < f->syncEnd)
+                {
+                    f->dbm = SIM_CHAN_NOISE_DBM;
+                    return;
+                }
+
+            // Scramble the data bytes under the interferer
+            bytePs = (f->end - f->syncEnd) / (f->len ? f->len : 1);
+            first = (uint16_t)((hitFrom - f->syncEnd) / bytePs);
+            last = (uint16_t)((hitTo - f->syncEnd) / bytePs);
+            for(i = first; i < f->len && i <= last; i++)
+                {
+                    f->data[i] ^= (uint8_t)(1 + 255 * SIM_CHAN_RAND());
+                }
+            return;
+        }
+
+    if(SIM_CHAN_cfg.ber > 0)
+        {
+            for(i = 0; i < 8 * f->len; i++)
+                {
+                    if(SIM_CHAN_RAND() < SIM_CHAN_cfg.ber)
+                        {
+                            f->data[i / 8] ^= (uint8_t)(1 << (i % 8));
+                            damaged = 1;
+                        }
+                }
+        }
+
+    if(damaged)
+        {
+            f->crcOk = 0;
+            SIM_CHAN_stats.bitErrors++;
+        }
+}
+
+/**
+ * Strongest signal on the chip's channel at time t.
+ */
+static int8_t SIM_CHAN_RSSI( SIM_cc2500_t* chip, uint64_t t )
+{
+    int8_t dbm = SIM_CHAN_NOISE_DBM;
+    uint16_t i;
+
+    for(i = 0; i < SIM_CHAN_airCount; i++)
+        {
+            SIM_frame_t* o = &SIM_CHAN_air[i].f;
+
+            if(o->start <= t && o->end > t && o->dbm > dbm
+                    && o->chan == chip->reg[0x0A])
+                {
+                    dbm = o->dbm;
+                }
+        }
+
+    return dbm;
+}
+
+/**
+ * Frames sent by the simulated MCU's own radio are not looped back.
+ */
+static void SIM_CHAN_TX( SIM_cc2500_t* chip, const SIM_frame_t* frame )
+{
+}
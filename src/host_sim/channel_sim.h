@@ -0,0 +1,88 @@
+/**
+ * @brief Shared-medium channel model for multi-node benchmarks
+ *
+ * A population of transmitting nodes sends periodic frames into the air seen
+ * by the simulated receiver (SIM_radio). Each node has its own clock error,
+ * random start phase and received signal level. Frames that overlap in time
+ * on the same channel collide: a frame survives only if it is stronger than
+ * the sum of its interferers by the capture margin. Surviving frames are then
+ * subjected to a post-FEC bit error rate. Damaged frames are delivered with
+ * their bytes corrupted and crcOk cleared, so the receiving firmware sees
+ * exactly what a real radio would hand it.
+ *
+ * @file channel_sim.h
+ * @author Aaron Parks, UW Sensor Systems Laboratory
+ * @version 1.0
+ */
+
+/*---------------------Include Guard-----------------------------------------*/
+#ifndef CHANNEL_SIM_H
+#define CHANNEL_SIM_H
+/*---------------------------------------------------------------------------*/
+
+///////////////////////////////////////////////////////////////////////////////
+/// Includes
+///////////////////////////////////////////////////////////////////////////////
+#include <stdint.h>
+#include "cc2500_sim.h"
+
+///////////////////////////////////////////////////////////////////////////////
+/// Definitions
+///////////////////////////////////////////////////////////////////////////////
+
+#define SIM_CHAN_NODES_MAX		256		// Transmitting nodes
+#define SIM_CHAN_AIR_MAX		512		// Frames tracked on the air at once
+#define SIM_CHAN_HISTORY		64		// Frames per node checked for duplicates
+#define SIM_CHAN_CAPTURE_DB		10		// Margin over interference to survive
+#define SIM_CHAN_NOISE_DBM		(-110)	// Reported RSSI on a quiet channel
+
+/**
+ * Channel and node population parameters.
+ */
+typedef struct SIM_chan_cfg_s
+{
+    uint16_t	nodes;		// Number of transmitting nodes
+    uint64_t	period;		// Nominal frame period of every node (ps)
+    double		periodTol;	// Relative clock error, uniform in +/- periodTol
+    double		ber;		// Bit error rate after FEC decoding
+    int8_t		dbmMin;		// Received level, uniform per node in
+    int8_t		dbmMax;		//	[dbmMin, dbmMax]
+    uint32_t	seed;		// PRNG seed
+    SIM_frame_t	tmpl;		// Frame template (timing, data rate, header)
+    uint16_t	idPos;		// Data byte offset of the node/sequence tag
+} SIM_chan_cfg_t;
+
+/**
+ * Channel counters.
+ */
+typedef struct SIM_chan_stats_s
+{
+    uint32_t sent;			// Frames put on the air
+    uint32_t collided;		// Frames damaged by overlap
+    uint32_t bitErrors;		// Frames damaged only by the bit error rate
+    uint32_t delivered;		// Intact frames handed to the application
+    uint32_t duplicates;	// Intact frames delivered more than once
+    uint32_t corrupt;		// Damaged or unknown frames handed to the application
+} SIM_chan_stats_t;
+
+///////////////////////////////////////////////////////////////////////////////
+/// Globals
+///////////////////////////////////////////////////////////////////////////////
+extern SIM_chan_stats_t SIM_CHAN_stats;
+
+///////////////////////////////////////////////////////////////////////////////
+/// Prototypes
+///////////////////////////////////////////////////////////////////////////////
+
+// Set up the node population and attach the channel to SIM_CC_air
+void SIM_CHAN_INIT( const SIM_chan_cfg_t* cfg );
+// Run the receiver and all transmissions up to time t
+void SIM_CHAN_RUN_UNTIL( uint64_t t );
+// Check received frame data against what was sent; updates the counters
+uint8_t SIM_CHAN_DELIVER( const uint8_t* data, uint16_t len );
+// Uniform pseudo-random number in [0, 1)
+double SIM_CHAN_RAND( void );
+
+///////////////////////////////////////////////////////////////////////////////
+#endif /* CHANNEL_SIM_H */
+///////////////////////////////////////////////////////////////////////////////
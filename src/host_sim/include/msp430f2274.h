@@ -0,0 +1,386 @@
+/**
+ * @brief Host stand-in for the TI msp430f2274.h device header
+ *
+ * Maps every peripheral register used by the stack onto an accessor in the
+ * host simulator (sim.c), so that the unmodified HAL and radio sources can be
+ * compiled and run on a workstation. Each register access is routed through
+ * SIM_REG8()/SIM_REG16(), which lets the simulator advance its clock, commit
+ * the side effects of the previous access and refresh read-only values
+ * (GDO/SOMI pin levels, USCI status, timer count, ...).
+ *
+ * Bit definitions match the values in the TI device header.
+ *
+ * @file msp430f2274.h
+ * @author Aaron Parks, UW Sensor Systems Laboratory
+ * @version 1.0
+ */
+
+/*---------------------Include Guard-----------------------------------------*/
+#ifndef SIM_MSP430F2274_H
+#define SIM_MSP430F2274_H
+/*---------------------------------------------------------------------------*/
+
+#include <stdint.h>
+
+///////////////////////////////////////////////////////////////////////////////
+/// Simulated register identifiers
+///////////////////////////////////////////////////////////////////////////////
+enum SIM_reg8_e
+{
+    SIM_R_IE1, SIM_R_IFG1, SIM_R_IE2, SIM_R_IFG2,
+    SIM_R_P1IN, SIM_R_P1OUT, SIM_R_P1DIR, SIM_R_P1IFG, SIM_R_P1IES, SIM_R_P1IE,
+    SIM_R_P1SEL,
+    SIM_R_P2IN, SIM_R_P2OUT, SIM_R_P2DIR, SIM_R_P2IFG, SIM_R_P2IES, SIM_R_P2IE,
+    SIM_R_P2SEL,
+    SIM_R_P3IN, SIM_R_P3OUT, SIM_R_P3DIR, SIM_R_P3SEL,
+    SIM_R_P4IN, SIM_R_P4OUT, SIM_R_P4DIR, SIM_R_P4SEL,
+    SIM_R_DCOCTL, SIM_R_BCSCTL1, SIM_R_BCSCTL2, SIM_R_BCSCTL3,
+    SIM_R_UCA0CTL0, SIM_R_UCA0CTL1, SIM_R_UCA0BR0, SIM_R_UCA0BR1,
+    SIM_R_UCA0MCTL, SIM_R_UCA0STAT, SIM_R_UCA0RXBUF, SIM_R_UCA0TXBUF,
+    SIM_R_UCB0CTL0, SIM_R_UCB0CTL1, SIM_R_UCB0BR0, SIM_R_UCB0BR1,
+    SIM_R_UCB0STAT, SIM_R_UCB0RXBUF, SIM_R_UCB0TXBUF,
+    SIM_R_ADC10AE0,
+    SIM_R8_COUNT
+};
+
+enum SIM_reg16_e
+{
+    SIM_R_WDTCTL,
+    SIM_R_TACTL, SIM_R_TAR, SIM_R_TAIV,
+    SIM_R_TACCTL0, SIM_R_TACCTL1, SIM_R_TACCTL2,
+    SIM_R_TACCR0, SIM_R_TACCR1, SIM_R_TACCR2,
+    SIM_R_ADC10CTL0, SIM_R_ADC10CTL1, SIM_R_ADC10MEM,
+    SIM_R16_COUNT
+};
+
+///////////////////////////////////////////////////////////////////////////////
+/// Simulator entry points used by the register and intrinsic macros
+///////////////////////////////////////////////////////////////////////////////
+volatile uint8_t*  SIM_REG8( int id );
+volatile uint16_t* SIM_REG16( int id );
+void     SIM_BIS_SR( uint16_t bits );
+void     SIM_BIC_SR( uint16_t bits );
+void     SIM_BIS_SR_ON_EXIT( uint16_t bits );
+void     SIM_BIC_SR_ON_EXIT( uint16_t bits );
+uint16_t SIM_GET_SR( void );
+void     SIM_DELAY_CYCLES( uint32_t cycles );
+
+///////////////////////////////////////////////////////////////////////////////
+/// Compiler intrinsics and keywords
+///////////////////////////////////////////////////////////////////////////////
+#define __interrupt
+#define _bis_SR_register(x)				SIM_BIS_SR(x)
+#define _bic_SR_register(x)				SIM_BIC_SR(x)
+#define __bis_SR_register(x)			SIM_BIS_SR(x)
+#define __bic_SR_register(x)			SIM_BIC_SR(x)
+#define __bis_SR_register_on_exit(x)	SIM_BIS_SR_ON_EXIT(x)
+#define __bic_SR_register_on_exit(x)	SIM_BIC_SR_ON_EXIT(x)
+#define _bis_SR_register_on_exit(x)		SIM_BIS_SR_ON_EXIT(x)
+#define _bic_SR_register_on_exit(x)		SIM_BIC_SR_ON_EXIT(x)
+#define _get_SR_register()				SIM_GET_SR()
+#define __get_SR_register()				SIM_GET_SR()
+#define __delay_cycles(x)				SIM_DELAY_CYCLES(x)
+#define __no_operation()				SIM_DELAY_CYCLES(1)
+#define _swap_bytes(x)	((uint16_t)((((uint16_t)(x)) << 8) | (((uint16_t)(x)) >> 8)))
+#define __even_in_range(x, y)			(x)
+
+///////////////////////////////////////////////////////////////////////////////
+/// Status register bits
+///////////////////////////////////////////////////////////////////////////////
+#define GIE					0x0008
+#define CPUOFF				0x0010
+#define OSCOFF				0x0020
+#define SCG0				0x0040
+#define SCG1				0x0080
+
+#define LPM0_bits			(CPUOFF)
+#define LPM1_bits			(SCG0+CPUOFF)
+#define LPM2_bits			(SCG1+CPUOFF)
+#define LPM3_bits			(SCG1+SCG0+CPUOFF)
+#define LPM4_bits			(SCG1+SCG0+OSCOFF+CPUOFF)
+
+///////////////////////////////////////////////////////////////////////////////
+/// Generic bits
+///////////////////////////////////////////////////////////////////////////////
+#define BIT0				0x0001
+#define BIT1				0x0002
+#define BIT2				0x0004
+#define BIT3				0x0008
+#define BIT4				0x0010
+#define BIT5				0x0020
+#define BIT6				0x0040
+#define BIT7				0x0080
+#define BIT8				0x0100
+#define BIT9				0x0200
+#define BITA				0x0400
+#define BITB				0x0800
+#define BITC				0x1000
+#define BITD				0x2000
+#define BITE				0x4000
+#define BITF				0x8000
+
+///////////////////////////////////////////////////////////////////////////////
+/// Special function registers
+///////////////////////////////////////////////////////////////////////////////
+#define IE1					(*SIM_REG8(SIM_R_IE1))
+#define IFG1				(*SIM_REG8(SIM_R_IFG1))
+#define IE2					(*SIM_REG8(SIM_R_IE2))
+#define IFG2				(*SIM_REG8(SIM_R_IFG2))
+
+#define WDTIE				0x01
+#define WDTIFG				0x01
+#define UCA0RXIE			0x01
+#define UCA0TXIE			0x02
+#define UCB0RXIE			0x04
+#define UCB0TXIE			0x08
+#define UCA0RXIFG			0x01
+#define UCA0TXIFG			0x02
+#define UCB0RXIFG			0x04
+#define UCB0TXIFG			0x08
+
+///////////////////////////////////////////////////////////////////////////////
+/// Digital I/O
+///////////////////////////////////////////////////////////////////////////////
+#define P1IN				(*SIM_REG8(SIM_R_P1IN))
+#define P1OUT				(*SIM_REG8(SIM_R_P1OUT))
+#define P1DIR				(*SIM_REG8(SIM_R_P1DIR))
+#define P1IFG				(*SIM_REG8(SIM_R_P1IFG))
+#define P1IES				(*SIM_REG8(SIM_R_P1IES))
+#define P1IE				(*SIM_REG8(SIM_R_P1IE))
+#define P1SEL				(*SIM_REG8(SIM_R_P1SEL))
+#define P2IN				(*SIM_REG8(SIM_R_P2IN))
+#define P2OUT				(*SIM_REG8(SIM_R_P2OUT))
+#define P2DIR				(*SIM_REG8(SIM_R_P2DIR))
+#define P2IFG				(*SIM_REG8(SIM_R_P2IFG))
+#define P2IES				(*SIM_REG8(SIM_R_P2IES))
+#define P2IE				(*SIM_REG8(SIM_R_P2IE))
+#define P2SEL				(*SIM_REG8(SIM_R_P2SEL))
+#define P3IN				(*SIM_REG8(SIM_R_P3IN))
+#define P3OUT				(*SIM_REG8(SIM_R_P3OUT))
+#define P3DIR				(*SIM_REG8(SIM_R_P3DIR))
+#define P3SEL				(*SIM_REG8(SIM_R_P3SEL))
+#define P4IN				(*SIM_REG8(SIM_R_P4IN))
+#define P4OUT				(*SIM_REG8(SIM_R_P4OUT))
+#define P4DIR				(*SIM_REG8(SIM_R_P4DIR))
+#define P4SEL				(*SIM_REG8(SIM_R_P4SEL))
+
+///////////////////////////////////////////////////////////////////////////////
+/// Basic clock module
+///////////////////////////////////////////////////////////////////////////////
+#define DCOCTL				(*SIM_REG8(SIM_R_DCOCTL))
+#define BCSCTL1				(*SIM_REG8(SIM_R_BCSCTL1))
+#define BCSCTL2				(*SIM_REG8(SIM_R_BCSCTL2))
+#define BCSCTL3				(*SIM_REG8(SIM_R_BCSCTL3))
+
+#define XT2OFF				0x80
+#define XTS					0x40
+#define DIVA_0				0x00
+#define DIVA_1				0x10
+#define DIVA_2				0x20
+#define DIVA_3				0x30
+#define SELM_0				0x00
+#define SELM_2				0x80
+#define SELM_3				0xC0
+#define DIVM_0				0x00
+#define DIVM_1				0x10
+#define DIVM_2				0x20
+#define DIVM_3				0x30
+#define SELS				0x08
+#define DIVS_0				0x00
+#define DIVS_1				0x02
+#define DIVS_2				0x04
+#define DIVS_3				0x06
+#define LFXT1S_0			0x00
+#define LFXT1S_2			0x20
+#define LFXT1S_3			0x30
+#define XCAP_0				0x00
+#define XCAP_3				0x0C
+#define LFXT1OF				0x01
+
+// Factory DCO calibration constants (information memory segment A)
+extern const uint8_t SIM_CALDCO[4];
+extern const uint8_t SIM_CALBC1[4];
+#define CALDCO_16MHZ		(SIM_CALDCO[0])
+#define CALBC1_16MHZ		(SIM_CALBC1[0])
+#define CALDCO_12MHZ		(SIM_CALDCO[1])
+#define CALBC1_12MHZ		(SIM_CALBC1[1])
+#define CALDCO_8MHZ			(SIM_CALDCO[2])
+#define CALBC1_8MHZ			(SIM_CALBC1[2])
+#define CALDCO_1MHZ			(SIM_CALDCO[3])
+#define CALBC1_1MHZ			(SIM_CALBC1[3])
+
+///////////////////////////////////////////////////////////////////////////////
+/// Watchdog timer
+///////////////////////////////////////////////////////////////////////////////
+#define WDTCTL				(*SIM_REG16(SIM_R_WDTCTL))
+
+#define WDTIS0				0x0001
+#define WDTIS1				0x0002
+#define WDTSSEL				0x0004
+#define WDTCNTCL			0x0008
+#define WDTTMSEL			0x0010
+#define WDTNMI				0x0020
+#define WDTNMIES			0x0040
+#define WDTHOLD				0x0080
+#define WDTPW				0x5A00
+
+#define WDT_MDLY_32			(WDTPW+WDTTMSEL+WDTCNTCL)
+#define WDT_MDLY_8			(WDTPW+WDTTMSEL+WDTCNTCL+WDTIS0)
+#define WDT_MDLY_0_5		(WDTPW+WDTTMSEL+WDTCNTCL+WDTIS1)
+#define WDT_MDLY_0_064		(WDTPW+WDTTMSEL+WDTCNTCL+WDTIS1+WDTIS0)
+#define WDT_ADLY_1000		(WDTPW+WDTTMSEL+WDTCNTCL+WDTSSEL)
+#define WDT_ADLY_250		(WDTPW+WDTTMSEL+WDTCNTCL+WDTSSEL+WDTIS0)
+#define WDT_ADLY_16			(WDTPW+WDTTMSEL+WDTCNTCL+WDTSSEL+WDTIS1)
+#define WDT_ADLY_1_9		(WDTPW+WDTTMSEL+WDTCNTCL+WDTSSEL+WDTIS1+WDTIS0)
+
+///////////////////////////////////////////////////////////////////////////////
+/// Timer A3
+///////////////////////////////////////////////////////////////////////////////
+#define TACTL				(*SIM_REG16(SIM_R_TACTL))
+#define TAR					(*SIM_REG16(SIM_R_TAR))
+#define TAIV				(*SIM_REG16(SIM_R_TAIV))
+#define TACCTL0				(*SIM_REG16(SIM_R_TACCTL0))
+#define TACCTL1				(*SIM_REG16(SIM_R_TACCTL1))
+#define TACCTL2				(*SIM_REG16(SIM_R_TACCTL2))
+#define TACCR0				(*SIM_REG16(SIM_R_TACCR0))
+#define TACCR1				(*SIM_REG16(SIM_R_TACCR1))
+#define TACCR2				(*SIM_REG16(SIM_R_TACCR2))
+
+#define TAIFG				0x0001
+#define TAIE				0x0002
+#define TACLR				0x0004
+#define MC_0				0x0000
+#define MC_1				0x0010
+#define MC_2				0x0020
+#define MC_3				0x0030
+#define ID_0				0x0000
+#define ID_1				0x0040
+#define ID_2				0x0080
+#define ID_3				0x00C0
+#define TASSEL_0			0x0000
+#define TASSEL_1			0x0100
+#define TASSEL_2			0x0200
+#define TASSEL_3			0x0300
+
+#define CCIFG				0x0001
+#define COV					0x0002
+#define OUT					0x0004
+#define CCI					0x0008
+#define CCIE				0x0010
+#define SCCI				0x0400
+#define SCS					0x0800
+#define CAP					0x0100
+#define CCIS_0				0x0000
+#define CCIS_1				0x1000
+#define CCIS_2				0x2000
+#define CCIS_3				0x3000
+#define CM_0				0x0000
+#define CM_1				0x4000
+#define CM_2				0x8000
+#define CM_3				0xC000
+
+#define TAIV_TACCR1			0x0002
+#define TAIV_TACCR2			0x0004
+#define TAIV_TAIFG			0x000A
+
+///////////////////////////////////////////////////////////////////////////////
+/// USCI
+///////////////////////////////////////////////////////////////////////////////
+#define UCA0CTL0			(*SIM_REG8(SIM_R_UCA0CTL0))
+#define UCA0CTL1			(*SIM_REG8(SIM_R_UCA0CTL1))
+#define UCA0BR0				(*SIM_REG8(SIM_R_UCA0BR0))
+#define UCA0BR1				(*SIM_REG8(SIM_R_UCA0BR1))
+#define UCA0MCTL			(*SIM_REG8(SIM_R_UCA0MCTL))
+#define UCA0STAT			(*SIM_REG8(SIM_R_UCA0STAT))
+#define UCA0RXBUF			(*SIM_REG8(SIM_R_UCA0RXBUF))
+#define UCA0TXBUF			(*SIM_REG8(SIM_R_UCA0TXBUF))
+#define UCB0CTL0			(*SIM_REG8(SIM_R_UCB0CTL0))
+#define UCB0CTL1			(*SIM_REG8(SIM_R_UCB0CTL1))
+#define UCB0BR0				(*SIM_REG8(SIM_R_UCB0BR0))
+#define UCB0BR1				(*SIM_REG8(SIM_R_UCB0BR1))
+#define UCB0STAT			(*SIM_REG8(SIM_R_UCB0STAT))
+#define UCB0RXBUF			(*SIM_REG8(SIM_R_UCB0RXBUF))
+#define UCB0TXBUF			(*SIM_REG8(SIM_R_UCB0TXBUF))
+
+#define UCCKPH				0x80
+#define UCCKPL				0x40
+#define UCMSB				0x20
+#define UC7BIT				0x10
+#define UCMST				0x08
+#define UCMODE_0			0x00
+#define UCSYNC				0x01
+#define UCSSEL_1			0x40
+#define UCSSEL_2			0x80
+#define UCSWRST				0x01
+#define UCBUSY				0x01
+#define UCOE				0x20
+#define UCBRS0				0x02
+#define UCBRS_0				0x00
+#define UCBRS_1				0x02
+#define UCBRS_2				0x04
+#define UCBRS_6				0x0C
+
+///////////////////////////////////////////////////////////////////////////////
+/// ADC10
+///////////////////////////////////////////////////////////////////////////////
+#define ADC10CTL0			(*SIM_REG16(SIM_R_ADC10CTL0))
+#define ADC10CTL1			(*SIM_REG16(SIM_R_ADC10CTL1))
+#define ADC10MEM			(*SIM_REG16(SIM_R_ADC10MEM))
+#define ADC10AE0			(*SIM_REG8(SIM_R_ADC10AE0))
+
+#define ADC10SC				0x0001
+#define ENC					0x0002
+#define ADC10IFG			0x0004
+#define ADC10IE				0x0008
+#define ADC10ON				0x0010
+#define REFON				0x0020
+#define REF2_5V				0x0040
+#define MSC					0x0080
+#define ADC10SR				0x0400
+#define ADC10SHT_0			0x0000
+#define ADC10SHT_1			0x0800
+#define ADC10SHT_2			0x1000
+#define ADC10SHT_3			0x1800
+#define SREF_0				0x0000
+#define SREF_1				0x2000
+
+#define ADC10BUSY			0x0001
+#define ADC10DIV_0			0x0000
+#define ADC10DIV_3			0x0060
+#define ADC10DIV_7			0x00E0
+#define INCH_0				0x0000
+#define INCH_1				0x1000
+#define INCH_2				0x2000
+#define INCH_3				0x3000
+#define INCH_4				0x4000
+#define INCH_5				0x5000
+#define INCH_6				0x6000
+#define INCH_7				0x7000
+#define INCH_8				0x8000
+#define INCH_9				0x9000
+#define INCH_10				0xA000
+#define INCH_11				0xB000
+#define INCH_12				0xC000
+#define INCH_13				0xD000
+#define INCH_14				0xE000
+#define INCH_15				0xF000
+
+///////////////////////////////////////////////////////////////////////////////
+/// Interrupt vectors (byte offset from 0xFFE0)
+///////////////////////////////////////////////////////////////////////////////
+#define PORT1_VECTOR		(2 * 2u)
+#define PORT2_VECTOR		(3 * 2u)
+#define ADC10_VECTOR		(5 * 2u)
+#define USCIAB0TX_VECTOR	(6 * 2u)
+#define USCIAB0RX_VECTOR	(7 * 2u)
+#define TIMERA1_VECTOR		(8 * 2u)
+#define TIMERA0_VECTOR		(9 * 2u)
+#define WDT_VECTOR			(10 * 2u)
+#define TIMERB1_VECTOR		(12 * 2u)
+#define TIMERB0_VECTOR		(13 * 2u)
+#define NMI_VECTOR			(14 * 2u)
+#define RESET_VECTOR		(15 * 2u)
+
+///////////////////////////////////////////////////////////////////////////////
+#endif /* SIM_MSP430F2274_H */
+///////////////////////////////////////////////////////////////////////////////
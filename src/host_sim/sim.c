@@ -0,0 +1,1034 @@
+/**
+ * @brief Host-side MSP430F2274 simulator for off-target benchmarking
+ *
+ * Register accesses are resolved lazily. Each call to SIM_REG8()/SIM_REG16()
+ * first commits the side effects of the previous access (a TXBUF write, a
+ * ~CS edge on P3OUT, a timer restart, ...), then charges SIM_ACCESS_CYCLES
+ * of MCLK, runs every peripheral and radio event that falls due in that
+ * time, services pending interrupts and finally refreshes the value the
+ * firmware is about to read.
+ *
+ * Only the behaviour the stack depends on is modelled. CPU time spent in
+ * plain C code between register accesses is not counted, so MCU active time
+ * is a lower bound; SPI, radio and timer timing is exact to the modelled
+ * clock rates.
+ *
+ * @file sim.c
+ * @author Aaron Parks, UW Sensor Systems Laboratory
+ * @version 1.0
+ */
+
+///////////////////////////////////////////////////////////////////////////////
+/// Includes
+///////////////////////////////////////////////////////////////////////////////
+#include "sim.h"
+#include "../TX_RX_Demo/hal/hal.h"	// Vector assignments and pin wiring
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+///////////////////////////////////////////////////////////////////////////////
+/// Local definitions
+///////////////////////////////////////////////////////////////////////////////
+
+// Port carrying the radio GDO lines
+#if (BSP_GDO_VECTOR == PORT1_VECTOR)
+#define SIM_R_GDO_IN	SIM_R_P1IN
+#define SIM_R_GDO_IFG	SIM_R_P1IFG
+#define SIM_R_GDO_IES	SIM_R_P1IES
+#else
+#define SIM_R_GDO_IN	SIM_R_P2IN
+#define SIM_R_GDO_IFG	SIM_R_P2IFG
+#define SIM_R_GDO_IES	SIM_R_P2IES
+#endif
+
+#define SIM_ADC10OSC_HZ		5000000UL	// Typical ADC10OSC frequency
+#define SIM_IRQ_CYCLES		6			// Interrupt acceptance latency
+#define SIM_RETI_CYCLES		5
+
+#define SIM_SUPPLY_V		3.0
+
+///////////////////////////////////////////////////////////////////////////////
+/// Firmware interrupt service routines (bound by name, see SIM_HANDLER)
+///////////////////////////////////////////////////////////////////////////////
+extern void RADIO_GDO_ISR( void ) __attribute__((weak));
+extern void HAL_TMR_ISR( void ) __attribute__((weak));
+extern void HAL_TMR1_ISR( void ) __attribute__((weak));
+extern void ADC10_ISR( void ) __attribute__((weak));
+extern void WDT_ISR( void ) __attribute__((weak));
+extern void HAL_SPI_RX_ISR( void ) __attribute__((weak));
+
+///////////////////////////////////////////////////////////////////////////////
+/// Simulator state
+///////////////////////////////////////////////////////////////////////////////
+uint64_t		SIM_now;
+SIM_mcu_stats_t	SIM_stats;
+SIM_cc2500_t	SIM_radio;
+uint32_t		SIM_vloHz = 12000;
+void (*SIM_uartOut)( uint8_t byte );
+uint16_t (*SIM_adcIn)( uint8_t channel );
+
+// Factory calibration constants: 16, 12, 8 and 1 MHz
+const uint8_t SIM_CALDCO[4] = {0x95, 0x9E, 0x92, 0xB5};
+const uint8_t SIM_CALBC1[4] = {0x8F, 0x8E, 0x8D, 0x86};
+static const uint32_t SIM_CAL_HZ[4] = {16000000, 12000000, 8000000, 1000000};
+
+static volatile uint8_t  SIM_r8[SIM_R8_COUNT];
+static volatile uint16_t SIM_r16[SIM_R16_COUNT];
+
+static int SIM_last8 = -1;			// Register touched by the last access
+static uint8_t  SIM_csShadow;		// Effective ~CS level seen by the radio
+static uint8_t  SIM_ucb0ctl1Shadow;
+static uint8_t  SIM_uca0ctl1Shadow;
+static uint16_t SIM_tactlShadow;
+static uint16_t SIM_tarShadow;
+static uint16_t SIM_taccr0Shadow;
+static uint16_t SIM_wdtShadow;
+static uint16_t SIM_adcShadow;
+static uint8_t  SIM_gdoShadow;
+
+static uint16_t SIM_sr;				// Status register
+static uint16_t SIM_srStack[16];	// SR saved by interrupt entry
+static uint8_t  SIM_depth;
+
+static struct
+{
+    uint8_t  busy;
+    uint8_t  pending;	// TXBUF loaded while the shifter was busy
+    uint8_t  shift;
+    uint64_t endAt;
+} SIM_ucb, SIM_uca;
+
+static struct
+{
+    uint8_t  running;
+    uint64_t base;		// Time TAR took the value baseCount
+    uint16_t baseCount;
+    uint64_t tickPs;
+    uint64_t capAt;		// Last ACLK edge captured by TACCR0
+} SIM_ta;
+
+static uint64_t SIM_wdtNextAt;
+static uint64_t SIM_wdtPeriodPs;
+static uint64_t SIM_adcEndAt;
+
+///////////////////////////////////////////////////////////////////////////////
+/// Local prototypes
+///////////////////////////////////////////////////////////////////////////////
+static void SIM_COMMIT( void );
+static void SIM_RUN_TO( uint64_t target );
+static void SIM_STEP_TO( uint64_t t );
+static uint64_t SIM_NEXT_EVENT( void );
+static void SIM_SERVICE_IRQS( void );
+static void SIM_SAMPLE_PINS( void );
+static void SIM_ADVANCE_CYCLES( uint32_t cycles );
+static uint32_t SIM_SMCLK_HZ( void );
+static uint32_t SIM_ACLK_HZ( void );
+static void SIM_TA_REBASE( void );
+static uint64_t SIM_TA_NEXT( void );
+static void SIM_TA_STEP( uint64_t t );
+static uint64_t SIM_TA_CAPTURE_NEXT( void );
+static void SIM_WDT_CONFIG( void );
+static void SIM_FAULT( const char* msg );
+
+///////////////////////////////////////////////////////////////////////////////
+
+/**
+ * Power-on reset of the MCU peripherals and the attached radio.
+ */
+void SIM_INIT( void )
+{
+    memset((void*)SIM_r8, 0, sizeof(SIM_r8));
+    memset((void*)SIM_r16, 0, sizeof(SIM_r16));
+    memset(&SIM_stats, 0, sizeof(SIM_stats));
+    memset(&SIM_ucb, 0, sizeof(SIM_ucb));
+    memset(&SIM_uca, 0, sizeof(SIM_uca));
+    memset(&SIM_ta, 0, sizeof(SIM_ta));
+
+    SIM_now = 0;
+    SIM_sr = 0;
+    SIM_depth = 0;
+    SIM_last8 = -1;
+
+    // PUC values
+    SIM_r8[SIM_R_DCOCTL] = 0x60;
+    SIM_r8[SIM_R_BCSCTL1] = 0x87;
+    SIM_r8[SIM_R_UCB0CTL1] = UCSWRST;
+    SIM_r8[SIM_R_UCA0CTL1] = UCSWRST;
+    SIM_r8[SIM_R_IFG2] = UCA0TXIFG | UCB0TXIFG;
+    SIM_r16[SIM_R_WDTCTL] = 0x6900;
+
+    SIM_ucb0ctl1Shadow = UCSWRST;
+    SIM_uca0ctl1Shadow = UCSWRST;
+    SIM_tactlShadow = 0;
+    SIM_tarShadow = 0;
+    SIM_taccr0Shadow = 0;
+    SIM_wdtShadow = 0x6900;
+    SIM_adcShadow = 0;
+    SIM_gdoShadow = 0;
+    SIM_csShadow = 1;
+    SIM_adcEndAt = 0;
+    SIM_WDT_CONFIG();
+
+    SIM_CC_INIT(&SIM_radio, 0);
+    SIM_SAMPLE_PINS();
+}
+
+/**
+ * Let time pass with the CPU in LPM3 and interrupts enabled. Interrupts are
+ * serviced as they occur; wakeups requested by ISRs are ignored until t.
+ */
+void SIM_IDLE_UNTIL( uint64_t t )
+{
+    uint16_t sr;
+
+    SIM_COMMIT();
+    sr = SIM_sr;
+
+    while(SIM_now < t)
+        {
+            SIM_sr = LPM3_bits | GIE;
+            SIM_RUN_TO(t);
+        }
+
+    SIM_sr = sr;
+}
+
+/**
+ * MCLK frequency derived from the DCO and BCSCTL2 settings.
+ */
+uint32_t SIM_MCLK_HZ( void )
+{
+    uint8_t bc1 = SIM_r8[SIM_R_BCSCTL1];
+    uint8_t dco = SIM_r8[SIM_R_DCOCTL];
+    uint32_t hz = 1100000;	// DCO after PUC
+    uint8_t i;
+
+    for(i = 0; i < 4; i++)
+        {
+            if((bc1 & 0x0F) == (SIM_CALBC1[i] & 0x0F) && dco == SIM_CALDCO[i])
+                {
+                    hz = SIM_CAL_HZ[i];
+                }
+        }
+
+    return hz >> ((SIM_r8[SIM_R_BCSCTL2] >> 4) & 0x03);
+}
+
+/**
+ * Register accessors used by the host msp430f2274.h.
+ */
+volatile uint8_t* SIM_REG8( int id )
+{
+    SIM_COMMIT();
+    SIM_ADVANCE_CYCLES(SIM_ACCESS_CYCLES);
+
+    switch(id)
+        {
+        case SIM_R_UCB0STAT:
+            SIM_r8[id] = (SIM_r8[id] & ~UCBUSY) | ((SIM_ucb.busy || SIM_ucb.pending) ? UCBUSY : 0);
+            break;
+        case SIM_R_UCA0STAT:
+            SIM_r8[id] = (SIM_r8[id] & ~UCBUSY) | ((SIM_uca.busy || SIM_uca.pending) ? UCBUSY : 0);
+            break;
+        case SIM_R_UCB0RXBUF:
+            SIM_r8[SIM_R_IFG2] &= ~UCB0RXIFG;
+            SIM_r8[SIM_R_UCB0STAT] &= ~UCOE;
+            break;
+        case SIM_R_UCA0RXBUF:
+            SIM_r8[SIM_R_IFG2] &= ~UCA0RXIFG;
+            break;
+        default:
+            break;
+        }
+
+    SIM_last8 = id;
+    return &SIM_r8[id];
+}
+
+volatile uint16_t* SIM_REG16( int id )
+{
+    uint16_t v;
+
+    SIM_COMMIT();
+    SIM_ADVANCE_CYCLES(SIM_ACCESS_CYCLES);
+
+    switch(id)
+        {
+        case SIM_R_TAR:
+            if(SIM_ta.running)
+                {
+                    SIM_TA_REBASE();
+                }
+            SIM_r16[id] = SIM_ta.baseCount;
+            SIM_tarShadow = SIM_ta.baseCount;
+            break;
+
+        case SIM_R_TAIV:
+            // Reading TAIV returns and clears the highest pending source
+            v = 0;
+            if((SIM_r16[SIM_R_TACCTL1] & (CCIFG | CCIE)) == (CCIFG | CCIE))
+                {
+                    v = TAIV_TACCR1;
+                    SIM_r16[SIM_R_TACCTL1] &= ~CCIFG;
+                }
+            else if((SIM_r16[SIM_R_TACCTL2] & (CCIFG | CCIE)) == (CCIFG | CCIE))
+                {
+                    v = TAIV_TACCR2;
+                    SIM_r16[SIM_R_TACCTL2] &= ~CCIFG;
+                }
+            else if((SIM_r16[SIM_R_TACTL] & (TAIFG | TAIE)) == (TAIFG | TAIE))
+                {
+                    v = TAIV_TAIFG;
+                    SIM_r16[SIM_R_TACTL] &= ~TAIFG;
+                    SIM_tactlShadow = SIM_r16[SIM_R_TACTL];
+                }
+            SIM_r16[id] = v;
+            break;
+
+        default:
+            break;
+        }
+
+    SIM_last8 = -1;
+    return &SIM_r16[id];
+}
+
+/**
+ * Status register intrinsics.
+ */
+void SIM_BIS_SR( uint16_t bits )
+{
+    uint64_t t;
+
+    SIM_COMMIT();
+    SIM_sr |= bits;
+    SIM_SERVICE_IRQS();
+
+    // Sleep until an interrupt clears CPUOFF in the saved SR
+    while(SIM_sr & CPUOFF)
+        {
+            t = SIM_NEXT_EVENT();
+            if(UINT64_MAX == t || !(SIM_sr & GIE))
+                {
+                    SIM_FAULT("CPU entered LPM with no wakeup source");
+                }
+            SIM_RUN_TO(t);
+        }
+}
+
+void SIM_BIC_SR( uint16_t bits )
+{
+    SIM_COMMIT();
+    SIM_sr &= ~bits;
+}
+
+void SIM_BIS_SR_ON_EXIT( uint16_t bits )
+{
+    if(SIM_depth)
+        {
+            SIM_srStack[SIM_depth - 1] |= bits;
+        }
+}
+
+void SIM_BIC_SR_ON_EXIT( uint16_t bits )
+{
+    if(SIM_depth)
+        {
+            SIM_srStack[SIM_depth - 1] &= ~bits;
+        }
+}
+
+uint16_t SIM_GET_SR( void )
+{
+    return SIM_sr;
+}
+
+void SIM_DELAY_CYCLES( uint32_t cycles )
+{
+    SIM_COMMIT();
+    SIM_ADVANCE_CYCLES(cycles);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// Local functions
+///////////////////////////////////////////////////////////////////////////////
+
+/**
+ * Apply the side effects of register writes made since the last hook.
+ */
+static void SIM_COMMIT( void )
+{
+    uint8_t cs;
+    uint16_t br;
+
+    // USCI_B0 (SPI) transmit buffer
+    if(SIM_R_UCB0TXBUF == SIM_last8 && !(SIM_r8[SIM_R_UCB0CTL1] & UCSWRST))
+        {
+            if(!SIM_ucb.busy)
+                {
+                    br = SIM_r8[SIM_R_UCB0BR0] | ((uint16_t)SIM_r8[SIM_R_UCB0BR1] << 8);
+                    SIM_ucb.busy = 1;
+                    SIM_ucb.shift = SIM_r8[SIM_R_UCB0TXBUF];
+                    SIM_ucb.endAt = SIM_now + 8ULL * (br ? br : 1) * SIM_PS_PER_S / SIM_SMCLK_HZ();
+                    SIM_r8[SIM_R_IFG2] |= UCB0TXIFG;
+                }
+            else
+                {
+                    SIM_ucb.pending = 1;
+                    SIM_r8[SIM_R_IFG2] &= ~UCB0TXIFG;
+                }
+        }
+
+    // USCI_A0 (UART) transmit buffer
+    if(SIM_R_UCA0TXBUF == SIM_last8 && !(SIM_r8[SIM_R_UCA0CTL1] & UCSWRST))
+        {
+            if(!SIM_uca.busy)
+                {
+                    br = SIM_r8[SIM_R_UCA0BR0] | ((uint16_t)SIM_r8[SIM_R_UCA0BR1] << 8);
+                    SIM_uca.busy = 1;
+                    SIM_uca.shift = SIM_r8[SIM_R_UCA0TXBUF];
+                    SIM_uca.endAt = SIM_now + 10ULL * (br ? br : 1) * SIM_PS_PER_S / SIM_SMCLK_HZ();
+                    SIM_r8[SIM_R_IFG2] |= UCA0TXIFG;
+                }
+            else
+                {
+                    SIM_uca.pending = 1;
+                    SIM_r8[SIM_R_IFG2] &= ~UCA0TXIFG;
+                }
+        }
+    SIM_last8 = -1;
+
+    // USCI software reset
+    if(SIM_r8[SIM_R_UCB0CTL1] != SIM_ucb0ctl1Shadow)
+        {
+            if(SIM_r8[SIM_R_UCB0CTL1] & UCSWRST)
+                {
+                    SIM_ucb.busy = SIM_ucb.pending = 0;
+                    SIM_ucb.endAt = 0;
+                    SIM_r8[SIM_R_IFG2] = (SIM_r8[SIM_R_IFG2] & ~UCB0RXIFG) | UCB0TXIFG;
+                }
+            SIM_ucb0ctl1Shadow = SIM_r8[SIM_R_UCB0CTL1];
+        }
+    if(SIM_r8[SIM_R_UCA0CTL1] != SIM_uca0ctl1Shadow)
+        {
+            if(SIM_r8[SIM_R_UCA0CTL1] & UCSWRST)
+                {
+                    SIM_uca.busy = SIM_uca.pending = 0;
+                    SIM_uca.endAt = 0;
+                    SIM_r8[SIM_R_IFG2] = (SIM_r8[SIM_R_IFG2] & ~UCA0RXIFG) | UCA0TXIFG;
+                }
+            SIM_uca0ctl1Shadow = SIM_r8[SIM_R_UCA0CTL1];
+        }
+
+    // Radio ~CS (floats high while the pin is not driven)
+    cs = !(SIM_r8[SIM_R_P3DIR] & BSP_SPI_CS_BIT) || (SIM_r8[SIM_R_P3OUT] & BSP_SPI_CS_BIT);
+    if(cs != SIM_csShadow)
+        {
+            SIM_csShadow = cs;
+            SIM_CC_CS(&SIM_radio, !cs, SIM_now);
+            SIM_SAMPLE_PINS();
+        }
+
+    // Timer_A control, counter and period
+    if(SIM_r16[SIM_R_TACTL] != SIM_tactlShadow || SIM_r16[SIM_R_TAR] != SIM_tarShadow
+            || SIM_r16[SIM_R_TACCR0] != SIM_taccr0Shadow)
+        {
+            if(SIM_ta.running)
+                {
+                    SIM_TA_REBASE();
+                }
+            if(SIM_r16[SIM_R_TAR] != SIM_tarShadow)
+                {
+                    SIM_ta.baseCount = SIM_r16[SIM_R_TAR];
+                }
+            if(SIM_r16[SIM_R_TACTL] & TACLR)
+                {
+                    SIM_ta.baseCount = 0;
+                    SIM_r16[SIM_R_TACTL] &= ~TACLR;
+                }
+
+            // Up mode with TACCR0 = 0 holds the timer
+            SIM_ta.running = (SIM_r16[SIM_R_TACTL] & MC_3)
+                             && !((SIM_r16[SIM_R_TACTL] & MC_3) == MC_1 && !SIM_r16[SIM_R_TACCR0]);
+            SIM_ta.base = SIM_now;
+            SIM_ta.tickPs = 0;
+
+            if(SIM_ta.running)
+                {
+                    uint32_t hz = ((SIM_r16[SIM_R_TACTL] & TASSEL_3) == TASSEL_2) ?
+                                  SIM_SMCLK_HZ() : SIM_ACLK_HZ();
+                    SIM_ta.tickPs = (SIM_PS_PER_S << ((SIM_r16[SIM_R_TACTL] >> 6) & 0x03)) / hz;
+                }
+
+            SIM_r16[SIM_R_TAR] = SIM_ta.baseCount;
+            SIM_tarShadow = SIM_ta.baseCount;
+            SIM_tactlShadow = SIM_r16[SIM_R_TACTL];
+            SIM_taccr0Shadow = SIM_r16[SIM_R_TACCR0];
+        }
+
+    // Watchdog
+    if(SIM_r16[SIM_R_WDTCTL] != SIM_wdtShadow)
+        {
+            if((SIM_r16[SIM_R_WDTCTL] & 0xFF00) != WDTPW)
+                {
+                    SIM_FAULT("WDTCTL written without password (PUC)");
+                }
+            SIM_r16[SIM_R_WDTCTL] = 0x6900 | (SIM_r16[SIM_R_WDTCTL] & 0x00FF & ~WDTCNTCL);
+            SIM_wdtShadow = SIM_r16[SIM_R_WDTCTL];
+            SIM_WDT_CONFIG();
+        }
+
+    // ADC10 start of conversion
+    if(SIM_r16[SIM_R_ADC10CTL0] != SIM_adcShadow)
+        {
+            uint16_t c0 = SIM_r16[SIM_R_ADC10CTL0];
+            uint16_t c1 = SIM_r16[SIM_R_ADC10CTL1];
+
+            if((c0 & (ENC | ADC10SC | ADC10ON)) == (ENC | ADC10SC | ADC10ON) && !SIM_adcEndAt)
+                {
+                    static const uint8_t sht[4] = {4, 8, 16, 64};
+                    uint32_t clocks = sht[(c0 >> 11) & 0x03] + 13;
+                    uint32_t div = ((c1 >> 5) & 0x07) + 1;
+
+                    SIM_adcEndAt = SIM_now + (uint64_t)clocks * div * SIM_PS_PER_S / SIM_ADC10OSC_HZ;
+                    SIM_r16[SIM_R_ADC10CTL1] |= ADC10BUSY;
+                }
+            SIM_adcShadow = SIM_r16[SIM_R_ADC10CTL0];
+        }
+}
+
+/**
+ * Advance the clock by the given number of MCLK cycles.
+ */
+static void SIM_ADVANCE_CYCLES( uint32_t cycles )
+{
+    SIM_RUN_TO(SIM_now + (uint64_t)cycles * SIM_PS_PER_S / SIM_MCLK_HZ());
+}
+
+/**
+ * Run events and interrupts until the clock reaches target.
+ */
+static void SIM_RUN_TO( uint64_t target )
+{
+    uint64_t t;
+
+    while((t = SIM_NEXT_EVENT()) <= target)
+        {
+            SIM_STEP_TO(t);
+            SIM_SERVICE_IRQS();
+        }
+
+    SIM_STEP_TO(target);
+    SIM_SERVICE_IRQS();
+}
+
+/**
+ * Move the clock to t (if in the future) and process every event due.
+ */
+static void SIM_STEP_TO( uint64_t t )
+{
+    uint8_t mode;
+    double ma;
+    double mhz;
+    uint64_t dt;
+
+    if(t > SIM_now)
+        {
+            dt = t - SIM_now;
+            mhz = SIM_MCLK_HZ() / 1e6;
+
+            if(!(SIM_sr & CPUOFF))
+                {
+                    mode = SIM_MODE_ACTIVE;
+                    ma = 0.39 * mhz;
+                }
+            else if(SIM_sr & OSCOFF)
+                {
+                    mode = SIM_MODE_LPM4;
+                    ma = 0.0001;
+                }
+            else if((SIM_sr & (SCG0 | SCG1)) == (SCG0 | SCG1))
+                {
+                    mode = SIM_MODE_LPM3;
+                    ma = 0.0009;
+                }
+            else if(SIM_sr & SCG1)
+                {
+                    mode = SIM_MODE_LPM2;
+                    ma = 0.025;
+                }
+            else
+                {
+                    mode = (SIM_sr & SCG0) ? SIM_MODE_LPM1 : SIM_MODE_LPM0;
+                    ma = 0.056 + 0.03 * mhz;
+                }
+
+            SIM_stats.modePs[mode] += dt;
+            SIM_stats.energyNj += (double)dt * ma * SIM_SUPPLY_V * 1e-6;
+            SIM_now = t;
+        }
+
+    // Radio
+    SIM_CC_UPDATE(&SIM_radio, SIM_now);
+
+    // USCI_B0 shift register
+    if(SIM_ucb.busy && SIM_ucb.endAt <= SIM_now)
+        {
+            uint8_t miso = SIM_csShadow ? 0xFF : SIM_CC_SPI(&SIM_radio, SIM_ucb.shift, SIM_now);
+            uint16_t br = SIM_r8[SIM_R_UCB0BR0] | ((uint16_t)SIM_r8[SIM_R_UCB0BR1] << 8);
+
+            if(SIM_r8[SIM_R_IFG2] & UCB0RXIFG)
+                {
+                    SIM_stats.spiOverruns++;
+                    SIM_r8[SIM_R_UCB0STAT] |= UCOE;
+                }
+            SIM_r8[SIM_R_UCB0RXBUF] = miso;
+            SIM_r8[SIM_R_IFG2] |= UCB0RXIFG;
+            SIM_stats.spiBytes++;
+            SIM_ucb.busy = 0;
+
+            if(SIM_ucb.pending)
+                {
+                    SIM_ucb.pending = 0;
+                    SIM_ucb.busy = 1;
+                    SIM_ucb.shift = SIM_r8[SIM_R_UCB0TXBUF];
+                    SIM_ucb.endAt = SIM_now + 8ULL * (br ? br : 1) * SIM_PS_PER_S / SIM_SMCLK_HZ();
+                    SIM_r8[SIM_R_IFG2] |= UCB0TXIFG;
+                }
+        }
+
+    // USCI_A0 shift register
+    if(SIM_uca.busy && SIM_uca.endAt <= SIM_now)
+        {
+            uint16_t br = SIM_r8[SIM_R_UCA0BR0] | ((uint16_t)SIM_r8[SIM_R_UCA0BR1] << 8);
+
+            if(SIM_uartOut)
+                {
+                    SIM_uartOut(SIM_uca.shift);
+                }
+            SIM_stats.uartBytes++;
+            SIM_uca.busy = 0;
+
+            if(SIM_uca.pending)
+                {
+                    SIM_uca.pending = 0;
+                    SIM_uca.busy = 1;
+                    SIM_uca.shift = SIM_r8[SIM_R_UCA0TXBUF];
+                    SIM_uca.endAt = SIM_now + 10ULL * (br ? br : 1) * SIM_PS_PER_S / SIM_SMCLK_HZ();
+                    SIM_r8[SIM_R_IFG2] |= UCA0TXIFG;
+                }
+        }
+
+    // Timer_A
+    SIM_TA_STEP(SIM_now);
+
+    // Timer_A capture of an ACLK rising edge (CCI0B) into TACCR0
+    if(SIM_TA_CAPTURE_NEXT() <= SIM_now)
+        {
+            SIM_TA_REBASE();
+            SIM_ta.capAt = SIM_now;
+            SIM_r16[SIM_R_TACCR0] = SIM_ta.baseCount;
+            SIM_r16[SIM_R_TAR] = SIM_ta.baseCount;
+            SIM_tarShadow = SIM_ta.baseCount;
+            SIM_taccr0Shadow = SIM_ta.baseCount;
+            if(SIM_r16[SIM_R_TACCTL0] & CCIFG)
+                {
+                    SIM_r16[SIM_R_TACCTL0] |= COV;
+                }
+            SIM_r16[SIM_R_TACCTL0] |= CCIFG;
+        }
+
+    // Watchdog interval
+    if(SIM_wdtNextAt && SIM_wdtNextAt <= SIM_now)
+        {
+            if(!(SIM_r16[SIM_R_WDTCTL] & WDTTMSEL))
+                {
+                    SIM_FAULT("watchdog expired (PUC)");
+                }
+            SIM_r8[SIM_R_IFG1] |= WDTIFG;
+            SIM_wdtNextAt += SIM_wdtPeriodPs;
+        }
+
+    // ADC10 end of conversion
+    if(SIM_adcEndAt && SIM_adcEndAt <= SIM_now)
+        {
+            uint8_t ch = SIM_r16[SIM_R_ADC10CTL1] >> 12;
+            uint16_t v;
+
+            if(SIM_adcIn)
+                {
+                    v = SIM_adcIn(ch);
+                }
+            else if(10 == ch)
+                {
+                    // Internal sensor against the 1.5 V reference
+                    v = (uint16_t)((0.00355 * SIM_CC_tempC + 0.986) / 1.5 * 1023);
+                }
+            else
+                {
+                    v = 512;
+                }
+
+            SIM_r16[SIM_R_ADC10MEM] = v & 0x03FF;
+            SIM_r16[SIM_R_ADC10CTL0] = (SIM_r16[SIM_R_ADC10CTL0] & ~ADC10SC) | ADC10IFG;
+            SIM_r16[SIM_R_ADC10CTL1] &= ~ADC10BUSY;
+            SIM_adcShadow = SIM_r16[SIM_R_ADC10CTL0];
+            SIM_adcEndAt = 0;
+        }
+
+    SIM_SAMPLE_PINS();
+}
+
+/**
+ * Time of the earliest pending peripheral or radio event.
+ */
+static uint64_t SIM_NEXT_EVENT( void )
+{
+    uint64_t t = SIM_CC_NEXT(&SIM_radio);
+    uint64_t ta;
+
+    if(SIM_ucb.busy && SIM_ucb.endAt < t)
+        {
+            t = SIM_ucb.endAt;
+        }
+    if(SIM_uca.busy && SIM_uca.endAt < t)
+        {
+            t = SIM_uca.endAt;
+        }
+    if(SIM_wdtNextAt && SIM_wdtNextAt < t)
+        {
+            t = SIM_wdtNextAt;
+        }
+    if(SIM_adcEndAt && SIM_adcEndAt < t)
+        {
+            t = SIM_adcEndAt;
+        }
+
+    ta = SIM_TA_NEXT();
+    if(ta < t)
+        {
+            t = ta;
+        }
+    ta = SIM_TA_CAPTURE_NEXT();
+    if(ta < t)
+        {
+            t = ta;
+        }
+
+    if(t < SIM_now)
+        {
+            t = SIM_now;
+        }
+
+    return t;
+}
+
+/**
+ * Interrupt service routine bound to a vector.
+ */
+static void (*SIM_HANDLER( unsigned vec ))( void )
+{
+    switch(vec)
+        {
+        case BSP_GDO_VECTOR:
+            return RADIO_GDO_ISR;
+        case HAL_TMR_VECTOR:
+            return HAL_TMR_ISR;
+        case HAL_TMR1_VECTOR:
+            return HAL_TMR1_ISR;
+        case ADC10_VECTOR:
+            return ADC10_ISR;
+        case WDT_VECTOR:
+            return WDT_ISR;
+        case HAL_SPI_RX_VECTOR:
+            return HAL_SPI_RX_ISR;
+        default:
+            return NULL;
+        }
+}
+
+/**
+ * Highest priority pending and enabled interrupt, or 0 if none. Single
+ * source flags are cleared on acceptance as on the target.
+ */
+static unsigned SIM_PENDING( void )
+{
+    if((SIM_r8[SIM_R_IFG1] & WDTIFG) && (SIM_r8[SIM_R_IE1] & WDTIE)
+            && (SIM_r16[SIM_R_WDTCTL] & WDTTMSEL))
+        {
+            SIM_r8[SIM_R_IFG1] &= ~WDTIFG;
+            return WDT_VECTOR;
+        }
+    if((SIM_r16[SIM_R_TACCTL0] & (CCIFG | CCIE)) == (CCIFG | CCIE))
+        {
+            SIM_r16[SIM_R_TACCTL0] &= ~CCIFG;
+            return TIMERA0_VECTOR;
+        }
+    if(((SIM_r16[SIM_R_TACCTL1] & (CCIFG | CCIE)) == (CCIFG | CCIE))
+            || ((SIM_r16[SIM_R_TACCTL2] & (CCIFG | CCIE)) == (CCIFG | CCIE))
+            || ((SIM_r16[SIM_R_TACTL] & (TAIFG | TAIE)) == (TAIFG | TAIE)))
+        {
+            return TIMERA1_VECTOR;
+        }
+    if(SIM_r8[SIM_R_IFG2] & SIM_r8[SIM_R_IE2] & (UCA0RXIFG | UCB0RXIFG))
+        {
+            return USCIAB0RX_VECTOR;
+        }
+    if(SIM_r8[SIM_R_IFG2] & SIM_r8[SIM_R_IE2] & (UCA0TXIFG | UCB0TXIFG))
+        {
+            return USCIAB0TX_VECTOR;
+        }
+    if((SIM_r16[SIM_R_ADC10CTL0] & (ADC10IFG | ADC10IE)) == (ADC10IFG | ADC10IE))
+        {
+            SIM_r16[SIM_R_ADC10CTL0] &= ~ADC10IFG;
+            SIM_adcShadow = SIM_r16[SIM_R_ADC10CTL0];
+            return ADC10_VECTOR;
+        }
+    if(SIM_r8[SIM_R_P2IFG] & SIM_r8[SIM_R_P2IE])
+        {
+            return PORT2_VECTOR;
+        }
+    if(SIM_r8[SIM_R_P1IFG] & SIM_r8[SIM_R_P1IE])
+        {
+            return PORT1_VECTOR;
+        }
+
+    return 0;
+}
+
+/**
+ * Accept pending interrupts while GIE is set.
+ */
+static void SIM_SERVICE_IRQS( void )
+{
+    unsigned vec;
+    void (*isr)( void );
+
+    while((SIM_sr & GIE) && (vec = SIM_PENDING()))
+        {
+            isr = SIM_HANDLER(vec);
+            if(!isr)
+                {
+                    fprintf(stderr, "sim: no handler for vector 0x%02X\n", vec);
+                    SIM_FAULT("unhandled interrupt");
+                }
+
+            if(SIM_depth == sizeof(SIM_srStack) / sizeof(SIM_srStack[0]))
+                {
+                    SIM_FAULT("interrupt nesting too deep");
+                }
+
+            SIM_srStack[SIM_depth++] = SIM_sr;
+            SIM_sr = 0;
+            SIM_stats.irqs++;
+            SIM_ADVANCE_CYCLES(SIM_IRQ_CYCLES);
+
+            isr();
+
+            SIM_COMMIT();
+            SIM_ADVANCE_CYCLES(SIM_RETI_CYCLES);
+            SIM_sr = SIM_srStack[--SIM_depth];
+        }
+}
+
+/**
+ * Drive the input pins from the radio and latch port interrupt flags.
+ */
+static void SIM_SAMPLE_PINS( void )
+{
+    uint8_t gdo = 0;
+    uint8_t edges;
+
+    if(SIM_CC_GDO(&SIM_radio, 0))
+        {
+            gdo |= BSP_GDO0_BIT;
+        }
+    if(SIM_CC_GDO(&SIM_radio, 2))
+        {
+            gdo |= BSP_GDO2_BIT;
+        }
+
+    edges = gdo ^ SIM_gdoShadow;
+    if(edges)
+        {
+            // PxIES selects the falling edge when set
+            SIM_r8[SIM_R_GDO_IFG] |= edges & ((gdo & ~SIM_r8[SIM_R_GDO_IES])
+                                              | (~gdo & SIM_r8[SIM_R_GDO_IES]));
+            SIM_gdoShadow = gdo;
+        }
+
+    SIM_r8[SIM_R_GDO_IN] = (SIM_r8[SIM_R_GDO_IN] & ~(BSP_GDO0_BIT | BSP_GDO2_BIT)) | gdo;
+
+    if(SIM_CC_SO(&SIM_radio))
+        {
+            SIM_r8[SIM_R_P3IN] |= BSP_SPI_SOMI_BIT;
+        }
+    else
+        {
+            SIM_r8[SIM_R_P3IN] &= ~BSP_SPI_SOMI_BIT;
+        }
+}
+
+/**
+ * SMCLK and ACLK frequencies.
+ */
+static uint32_t SIM_SMCLK_HZ( void )
+{
+    uint32_t dco = SIM_MCLK_HZ() << ((SIM_r8[SIM_R_BCSCTL2] >> 4) & 0x03);
+
+    return dco >> ((SIM_r8[SIM_R_BCSCTL2] >> 1) & 0x03);
+}
+
+static uint32_t SIM_ACLK_HZ( void )
+{
+    uint32_t hz = ((SIM_r8[SIM_R_BCSCTL3] & LFXT1S_3) == LFXT1S_2) ? SIM_vloHz : 32768;
+
+    return hz >> ((SIM_r8[SIM_R_BCSCTL1] >> 4) & 0x03);
+}
+
+/**
+ * Bring the Timer_A count up to date at the last whole tick before now.
+ */
+static void SIM_TA_REBASE( void )
+{
+    uint64_t ticks;
+    uint32_t period;
+
+    if(!SIM_ta.tickPs || SIM_now <= SIM_ta.base)
+        {
+            return;
+        }
+
+    ticks = (SIM_now - SIM_ta.base) / SIM_ta.tickPs;
+    period = ((SIM_r16[SIM_R_TACTL] & MC_3) == MC_1) ? (uint32_t)SIM_r16[SIM_R_TACCR0] + 1 : 0x10000;
+
+    SIM_ta.base += ticks * SIM_ta.tickPs;
+    SIM_ta.baseCount = (uint16_t)((SIM_ta.baseCount + ticks) % period);
+}
+
+/**
+ * Time at which Timer_A next reaches a compare value or wraps.
+ */
+static uint64_t SIM_TA_NEXT( void )
+{
+    uint32_t period;
+    uint32_t best;
+    uint32_t d;
+    uint8_t i;
+
+    if(!SIM_ta.running)
+        {
+            return UINT64_MAX;
+        }
+
+    period = ((SIM_r16[SIM_R_TACTL] & MC_3) == MC_1) ? (uint32_t)SIM_r16[SIM_R_TACCR0] + 1 : 0x10000;
+
+    // Wrap to zero
+    best = period - SIM_ta.baseCount;
+
+    for(i = 0; i < 3; i++)
+        {
+            uint16_t ccr = SIM_r16[SIM_R_TACCR0 + i];
+
+            if(SIM_r16[SIM_R_TACCTL0 + i] & CAP || ccr >= period)
+                {
+                    continue;
+                }
+            d = (ccr + period - SIM_ta.baseCount) % period;
+            if(d && d < best)
+                {
+                    best = d;
+                }
+        }
+
+    return SIM_ta.base + best * SIM_ta.tickPs;
+}
+
+/**
+ * Time of the next ACLK rising edge to be captured by TACCR0 (CCI0B is ACLK
+ * on the F2274), or UINT64_MAX if it isn't capturing them. Edges fall on
+ * whole ACLK periods.
+ */
+static uint64_t SIM_TA_CAPTURE_NEXT( void )
+{
+    uint16_t ctl = SIM_r16[SIM_R_TACCTL0];
+    uint64_t period;
+    uint64_t from;
+
+    if(!SIM_ta.running || !(ctl & CAP) || (ctl & CCIS_3) != CCIS_1 || !(ctl & CM_1))
+        {
+            return UINT64_MAX;
+        }
+
+    period = SIM_PS_PER_S / SIM_ACLK_HZ();
+    from = (SIM_ta.capAt >= SIM_now) ? SIM_ta.capAt + 1 : SIM_now;
+
+    return (from + period - 1) / period * period;
+}
+
+/**
+ * Process Timer_A compare matches and wraps that fall due at t.
+ */
+static void SIM_TA_STEP( uint64_t t )
+{
+    uint64_t next;
+    uint8_t i;
+
+    if(!SIM_ta.running)
+        {
+            return;
+        }
+
+    while((next = SIM_TA_NEXT()) <= t)
+        {
+            uint32_t period = ((SIM_r16[SIM_R_TACTL] & MC_3) == MC_1) ?
+                              (uint32_t)SIM_r16[SIM_R_TACCR0] + 1 : 0x10000;
+
+            SIM_ta.baseCount = (uint16_t)((SIM_ta.baseCount + (next - SIM_ta.base) / SIM_ta.tickPs) % period);
+            SIM_ta.base = next;
+
+            if(!SIM_ta.baseCount)
+                {
+                    SIM_r16[SIM_R_TACTL] |= TAIFG;
+                    SIM_tactlShadow = SIM_r16[SIM_R_TACTL];
+                }
+
+            for(i = 0; i < 3; i++)
+                {
+                    if(!(SIM_r16[SIM_R_TACCTL0 + i] & CAP)
+                            && SIM_r16[SIM_R_TACCR0 + i] == SIM_ta.baseCount)
+                        {
+                            SIM_r16[SIM_R_TACCTL0 + i] |= CCIFG;
+                        }
+                }
+        }
+
+    SIM_r16[SIM_R_TAR] = SIM_ta.baseCount;
+    SIM_tarShadow = SIM_ta.baseCount;
+}
+
+/**
+ * Restart the watchdog interval after a WDTCTL write.
+ */
+static void SIM_WDT_CONFIG( void )
+{
+    static const uint32_t div[4] = {32768, 8192, 512, 64};
+    uint16_t ctl = SIM_r16[SIM_R_WDTCTL];
+    uint32_t hz = (ctl & WDTSSEL) ? SIM_ACLK_HZ() : SIM_SMCLK_HZ();
+
+    if(ctl & WDTHOLD)
+        {
+            SIM_wdtNextAt = 0;
+            return;
+        }
+
+    SIM_wdtPeriodPs = (uint64_t)div[ctl & 0x03] * SIM_PS_PER_S / hz;
+    SIM_wdtNextAt = SIM_now + SIM_wdtPeriodPs;
+}
+
+static void SIM_FAULT( const char* msg )
+{
+    fprintf(stderr, "sim: %s at t=%.3f ms\n", msg, SIM_now / (double)SIM_PS_PER_MS);
+    exit(3);
+}
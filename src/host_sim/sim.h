@@ -0,0 +1,95 @@
+/**
+ * @brief Host-side MSP430F2274 simulator for off-target benchmarking
+ *
+ * Runs the unmodified HAL and radio sources on a workstation. Every register
+ * access made by the firmware goes through the accessors declared in the
+ * host msp430f2274.h, which advance a picosecond time line and drive models
+ * of the clock system, USCI_B0 (SPI), USCI_A0 (UART), Timer_A, ADC10, WDT+
+ * and the GDO/SPI port pins wired to a CC2500 model (cc2500_sim.h).
+ *
+ * Interrupt service routines defined with "#pragma vector" in the firmware
+ * are dispatched from the vector table in sim.c when their flags are set and
+ * GIE is on, with the MSP430 SR save/restore semantics, so LPM sleeps and
+ * __bic_SR_register_on_exit() wakeups behave as on the target.
+ *
+ * @file sim.h
+ * @author Aaron Parks, UW Sensor Systems Laboratory
+ * @version 1.0
+ */
+
+/*---------------------Include Guard-----------------------------------------*/
+#ifndef SIM_H
+#define SIM_H
+/*---------------------------------------------------------------------------*/
+
+///////////////////////////////////////////////////////////////////////////////
+/// Includes
+///////////////////////////////////////////////////////////////////////////////
+#include <msp430f2274.h>
+#include <stdint.h>
+#include "cc2500_sim.h"
+
+///////////////////////////////////////////////////////////////////////////////
+/// Definitions
+///////////////////////////////////////////////////////////////////////////////
+
+#define SIM_PS_PER_US		1000000ULL
+#define SIM_PS_PER_MS		1000000000ULL
+#define SIM_PS_PER_S		1000000000000ULL
+
+// MCU cycles charged for every peripheral register access
+#define SIM_ACCESS_CYCLES	2
+
+// MCU power modes used for accounting
+enum SIM_mcu_mode_e
+{
+    SIM_MODE_ACTIVE,
+    SIM_MODE_LPM0,
+    SIM_MODE_LPM1,
+    SIM_MODE_LPM2,
+    SIM_MODE_LPM3,
+    SIM_MODE_LPM4,
+    SIM_MODE_COUNT
+};
+
+/**
+ * MCU-side counters. Cumulative; benchmarks take differences.
+ */
+typedef struct SIM_mcu_stats_s
+{
+    uint64_t modePs[SIM_MODE_COUNT];	// Time in each power mode
+    double   energyNj;					// Integrated MCU energy
+    uint32_t irqs;						// Interrupts serviced
+    uint32_t spiBytes;					// Bytes shifted by USCI_B0
+    uint32_t spiOverruns;				// UCB0RXBUF overwritten before read
+    uint32_t uartBytes;					// Bytes sent by USCI_A0
+} SIM_mcu_stats_t;
+
+///////////////////////////////////////////////////////////////////////////////
+/// Simulator state visible to harnesses
+///////////////////////////////////////////////////////////////////////////////
+
+extern uint64_t			SIM_now;		// Current time (ps)
+extern SIM_mcu_stats_t	SIM_stats;		// MCU counters
+extern SIM_cc2500_t		SIM_radio;		// Radio wired to the MCU's SPI/GDO pins
+extern uint32_t			SIM_vloHz;		// Actual VLO frequency (default 12 kHz)
+
+// Called for each byte the firmware sends on the UART (may be NULL)
+extern void (*SIM_uartOut)( uint8_t byte );
+// Returns the raw ADC10 result for a channel (may be NULL)
+extern uint16_t (*SIM_adcIn)( uint8_t channel );
+
+///////////////////////////////////////////////////////////////////////////////
+/// Prototypes
+///////////////////////////////////////////////////////////////////////////////
+
+// Power-on reset of MCU and radio models
+void SIM_INIT( void );
+// Let time pass with the CPU in LPM3, servicing interrupts, until t
+void SIM_IDLE_UNTIL( uint64_t t );
+// Frequency of MCLK/SMCLK as currently configured (Hz)
+uint32_t SIM_MCLK_HZ( void );
+
+///////////////////////////////////////////////////////////////////////////////
+#endif /* SIM_H */
+///////////////////////////////////////////////////////////////////////////////